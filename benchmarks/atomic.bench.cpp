@@ -0,0 +1,81 @@
+// Contention on one shared optional: each thread runs a 90% load / 10% store
+// mix on AtomicOptional<T> and on a std::mutex guarding an Optional<T>, for an
+// 8-byte word (uint32_t) and a 16-byte word (double).
+
+#include "tim/optional/AtomicOptional.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using tim::Optional;
+using tim::AtomicOptional;
+
+template <class T>
+struct LockedOptional {
+	using value_type = T;
+
+	Optional<T> load() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return value;
+	}
+
+	void store(const Optional<T>& v) {
+		std::lock_guard<std::mutex> lock(mutex);
+		value = v;
+	}
+
+	std::mutex mutex;
+	Optional<T> value;
+};
+
+// Returns millions of operations per second over all threads.
+template <class Slot>
+static double run(Slot& slot, unsigned threads, std::size_t ops) {
+	std::vector<std::thread> pool;
+	std::vector<std::size_t> sinks(threads * 8u);
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned t = 0; t < threads; ++t) {
+		pool.emplace_back([&, t]() {
+			std::size_t sink = 0;
+			using value_type = typename Slot::value_type;
+			for(std::size_t i = 0; i < ops; ++i) {
+				if(i % 10 == 0) {
+					slot.store(i % 20 == 0 ? Optional<value_type>() : Optional<value_type>(static_cast<value_type>(i)));
+				} else {
+					sink += slot.load().has_value();
+				}
+			}
+			sinks[t * 8u] = sink;
+		});
+	}
+	for(auto& th: pool) {
+		th.join();
+	}
+	auto stop = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(stop - start).count();
+	return static_cast<double>(ops * threads) / seconds / 1e6;
+}
+
+template <class T>
+static void bench(const char* name) {
+	const std::size_t ops = std::size_t(1) << 21;
+	std::printf("%s (lock-free: %s)\n", name, AtomicOptional<T>::is_always_lock_free ? "yes" : "no");
+	for(unsigned threads : {1u, 2u, 4u, 8u}) {
+		AtomicOptional<T> atomic;
+		LockedOptional<T> locked;
+		double a = run(atomic, threads, ops);
+		double m = run(locked, threads, ops);
+		std::printf("  %u threads: atomic %8.2f Mops/s, mutex %8.2f Mops/s (%5.2fx)\n", threads, a, m, a / m);
+	}
+}
+
+int main() {
+	std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+	bench<std::uint32_t>("AtomicOptional<uint32_t>");
+	bench<double>("AtomicOptional<double>");
+	return 0;
+}
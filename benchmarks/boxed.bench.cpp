@@ -0,0 +1,115 @@
+// A vector of 400-byte records that are mostly absent, held as inline
+// Optional<T> versus BoxedOptional<T> (pool-allocated), at several fill
+// ratios: the memory each layout takes, a sequential scan that sums a field
+// of every present record, and random lookups of single elements.
+
+#include "tim/optional/BoxedOptional.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using tim::BoxedOptional;
+using tim::Optional;
+
+struct LargeRecord {
+	explicit LargeRecord(std::uint64_t k):
+		key(k)
+	{
+
+	}
+
+	std::uint64_t key;
+	unsigned char payload[392] = {};
+};
+
+static bool present(std::size_t i, unsigned percent) {
+	std::uint32_t state = static_cast<std::uint32_t>(i) * 2654435761u + 12345u;
+	state ^= state >> 15;
+	state *= 2246822519u;
+	state ^= state >> 13;
+	return state % 100u < percent;
+}
+
+template <class Opt>
+static std::vector<Opt> make_input(std::size_t count, unsigned percent) {
+	std::vector<Opt> in(count);
+	for(std::size_t i = 0; i < count; ++i) {
+		if(present(i, percent)) {
+			in[i].emplace(i);
+		}
+	}
+	return in;
+}
+
+template <class F>
+static double time_per_op(std::size_t ops, std::size_t reps, F f) {
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t r = 0; r < reps; ++r) {
+		f();
+	}
+	auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(ops * reps);
+}
+
+struct Timings {
+	double scan;
+	double lookup;
+};
+
+template <class Opt>
+static Timings measure(const std::vector<Opt>& in, const std::vector<std::uint32_t>& probes, std::size_t reps, std::uint64_t& sink) {
+	Timings t;
+	t.scan = time_per_op(in.size(), reps, [&]() {
+		std::uint64_t sum = 0;
+		for(const auto& o: in) {
+			if(o) {
+				sum += o->key;
+			}
+		}
+		sink += sum;
+	});
+	t.lookup = time_per_op(probes.size(), reps, [&]() {
+		std::uint64_t sum = 0;
+		for(std::uint32_t i: probes) {
+			const auto& o = in[i];
+			sum += o ? o->key : 1u;
+		}
+		sink += sum;
+	});
+	return t;
+}
+
+int main() {
+	const std::size_t count = 100000;
+	const std::size_t reps = 20;
+	std::vector<std::uint32_t> probes(1u << 16);
+	std::uint32_t state = 777u;
+	for(auto& p: probes) {
+		state = state * 1664525u + 1013904223u;
+		p = static_cast<std::uint32_t>((static_cast<std::uint64_t>(state) * count) >> 32);
+	}
+	std::uint64_t sink = 0;
+	std::printf("%zu elements of %zu bytes; sizeof(Optional) = %zu, sizeof(BoxedOptional) = %zu, pool block = %zu\n",
+		count, sizeof(LargeRecord), sizeof(Optional<LargeRecord>), sizeof(BoxedOptional<LargeRecord>),
+		tim::PoolAllocator<LargeRecord>::block_size);
+	std::printf("%6s  %22s  %24s  %24s\n", "fill", "bytes/element (in/box)", "scan ns/element (in/box)", "lookup ns (in/box)");
+	for(unsigned percent : {1u, 5u, 25u, 50u, 100u}) {
+		auto inline_in = make_input<Optional<LargeRecord>>(count, percent);
+		auto boxed_in = make_input<BoxedOptional<LargeRecord>>(count, percent);
+		std::size_t filled = 0;
+		for(const auto& o: boxed_in) {
+			filled += o.has_value();
+		}
+		double inline_bytes = static_cast<double>(sizeof(Optional<LargeRecord>));
+		double boxed_bytes = static_cast<double>(count * sizeof(BoxedOptional<LargeRecord>) + filled * tim::PoolAllocator<LargeRecord>::block_size)
+			/ static_cast<double>(count);
+		Timings in = measure(inline_in, probes, reps, sink);
+		Timings box = measure(boxed_in, probes, reps, sink);
+		std::printf("%5u%%  %10.1f / %9.1f  %11.3f / %10.3f  %11.2f / %10.2f\n",
+			percent, inline_bytes, boxed_bytes, in.scan, box.scan, in.lookup, box.lookup);
+	}
+	std::printf("(sink %llu)\n", static_cast<unsigned long long>(sink));
+	return 0;
+}
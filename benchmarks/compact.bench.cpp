@@ -0,0 +1,74 @@
+// Compaction of std::vector<Optional<T>> into a dense std::vector<T>:
+// the naive 'if(o) out.push_back(*o)' loop versus tim::compact(), at several
+// fill rates, plus the matching tim::expand() scatter.
+
+#include "tim/optional/OptionalAlgorithms.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using tim::Optional;
+
+template <class T>
+static std::vector<Optional<T>> make_input(std::size_t count, unsigned percent) {
+	std::vector<Optional<T>> in(count);
+	std::uint32_t state = 12345u;
+	for(std::size_t i = 0; i < count; ++i) {
+		state = state * 1664525u + 1013904223u;
+		if((state >> 8) % 100u < percent) {
+			in[i] = static_cast<T>(i);
+		}
+	}
+	return in;
+}
+
+template <class F>
+static double time_per_element(std::size_t count, std::size_t reps, F f) {
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t r = 0; r < reps; ++r) {
+		f();
+	}
+	auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(count * reps);
+}
+
+template <class T>
+static void run(const char* name, std::size_t count, std::size_t reps) {
+	for(unsigned percent : {10u, 50u, 90u}) {
+		std::vector<Optional<T>> in = make_input<T>(count, percent);
+		std::vector<T> out;
+		out.reserve(count);
+		std::vector<std::uint64_t> mask(tim::detail::bitmap_word_count(count));
+		std::size_t sink = 0;
+		double naive = time_per_element(count, reps, [&]() {
+			out.clear();
+			for(const auto& o: in) {
+				if(o) {
+					out.push_back(*o);
+				}
+			}
+			sink += out.size();
+		});
+		out.resize(count);
+		double compacted = time_per_element(count, reps, [&]() {
+			sink += static_cast<std::size_t>(tim::compact(in.data(), in.data() + count, out.data(), mask.data()) - out.data());
+		});
+		double expanded = time_per_element(count, reps, [&]() {
+			sink += static_cast<std::size_t>(tim::expand(out.data(), mask.data(), in.data(), in.data() + count) - out.data());
+		});
+		std::printf(
+			"%-8s %3u%% engaged: push_back loop %5.2f ns/elem, compact %5.2f ns/elem (%.2fx), expand %5.2f ns/elem [%zu]\n",
+			name, percent, naive, compacted, naive / compacted, expanded, sink
+		);
+	}
+}
+
+int main() {
+	const char* isa_names[] = {"scalar", "avx2", "avx512"};
+	std::printf("kernels: %s\n", isa_names[static_cast<int>(tim::detail::simd_isa())]);
+	run<int>("int", std::size_t(1) << 16, 2000);
+	run<double>("double", std::size_t(1) << 16, 2000);
+	return 0;
+}
@@ -0,0 +1,66 @@
+// 64 reader threads hammer one lazily initialized cache: OnceOptional's
+// get_or_init() against the std::call_once + Optional it replaces.  The first
+// call on each side runs the initializer; the rest measure the read path.
+
+#include "tim/optional/OnceOptional.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using tim::Optional;
+using tim::OnceOptional;
+
+struct CallOnceCache {
+	template <class F>
+	const std::vector<int>& get_or_init(F&& f) {
+		std::call_once(flag, [&]() { value.emplace(f()); });
+		return *value;
+	}
+
+	std::once_flag flag;
+	Optional<std::vector<int>> value;
+};
+
+static std::vector<int> make_table() {
+	std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	return std::vector<int>(1024, 1);
+}
+
+// Returns nanoseconds per get_or_init() call, averaged over all readers.
+template <class Cache>
+static double run(unsigned readers, std::size_t calls) {
+	Cache cache;
+	std::vector<std::thread> threads;
+	std::vector<std::size_t> sinks(readers * 8u);
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned r = 0; r < readers; ++r) {
+		threads.emplace_back([&, r]() {
+			std::size_t sink = 0;
+			for(std::size_t i = 0; i < calls; ++i) {
+				sink += cache.get_or_init(make_table)[i % 1024];
+			}
+			sinks[r * 8u] = sink;
+		});
+	}
+	for(auto& t: threads) {
+		t.join();
+	}
+	auto stop = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+	return ns / static_cast<double>(readers * calls);
+}
+
+int main() {
+	const unsigned readers = 64;
+	const std::size_t calls = std::size_t(1) << 20;
+	std::printf("hardware threads: %u, readers: %u\n", std::thread::hardware_concurrency(), readers);
+	for(int rep = 0; rep < 3; ++rep) {
+		double once = run<OnceOptional<std::vector<int>>>(readers, calls);
+		double call_once = run<CallOnceCache>(readers, calls);
+		std::printf("OnceOptional %6.3f ns/call, call_once + Optional %6.3f ns/call (%5.2fx)\n", once, call_once, call_once / once);
+	}
+	return 0;
+}
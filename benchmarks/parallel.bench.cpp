@@ -0,0 +1,59 @@
+// Scaling of count_present() and transform_present() over 16M
+// Optional<double> with execution::par on pools of 1 to 64 threads.
+// On machines with fewer cores the larger pools are oversubscribed.
+
+#include "tim/optional/OptionalAlgorithms.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using tim::Optional;
+
+template <class F>
+static double time_ms(std::size_t reps, F f) {
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t r = 0; r < reps; ++r) {
+		f();
+	}
+	auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count() / static_cast<double>(reps);
+}
+
+int main() {
+	const std::size_t count = std::size_t(1) << 24;
+	const std::size_t reps = 5;
+	std::vector<Optional<double>> in(count);
+	for(std::size_t i = 0; i < count; ++i) {
+		if(i % 4 != 0) {
+			in[i] = static_cast<double>(i);
+		}
+	}
+	std::vector<Optional<double>> out(count);
+	std::size_t sink = 0;
+	double count_base = 0.0;
+	double transform_base = 0.0;
+	std::printf("hardware threads: %u\n", tim::WorkStealingPool::default_thread_count());
+	for(unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+		tim::WorkStealingPool pool(threads);
+		auto par = tim::execution::par.on(pool);
+		double counted = time_ms(reps, [&]() {
+			sink += tim::count_present(par, in);
+		});
+		double transformed = time_ms(reps, [&]() {
+			tim::transform_present(par, in, out, [](double v) { return std::sqrt(v) * 0.5 + 1.0; });
+			sink += out[count / 2].has_value();
+		});
+		if(threads == 1) {
+			count_base = counted;
+			transform_base = transformed;
+		}
+		std::printf(
+			"%2u threads: count_present %7.2f ms (%5.2fx), transform_present %7.2f ms (%5.2fx) [%zu]\n",
+			threads, counted, count_base / counted, transformed, transform_base / transformed, sink
+		);
+	}
+	return 0;
+}
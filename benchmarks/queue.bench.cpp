@@ -0,0 +1,132 @@
+// Throughput of a 1024-slot bounded queue of short std::strings in SPSC,
+// MPSC and MPMC shapes: MPMCQueue, whose try_pop() moves each value once into
+// an Optional, against a mutex-guarded ring with the usual
+// 'bool try_pop(T&)', which default-constructs the destination and then
+// move-assigns into it.
+
+#include "tim/optional/MPMCQueue.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using tim::Optional;
+using tim::MPMCQueue;
+
+template <class T>
+struct LockedQueue {
+	explicit LockedQueue(std::size_t capacity):
+		slots(capacity)
+	{
+
+	}
+
+	bool try_push(T&& value) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if(size == slots.size()) {
+			return false;
+		}
+		slots[(head + size) % slots.size()] = std::move(value);
+		++size;
+		return true;
+	}
+
+	bool try_pop(T& out) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if(size == 0) {
+			return false;
+		}
+		out = std::move(slots[head]);
+		head = (head + 1) % slots.size();
+		--size;
+		return true;
+	}
+
+	std::mutex mutex;
+	std::vector<T> slots;
+	std::size_t head = 0;
+	std::size_t size = 0;
+};
+
+static bool pop(MPMCQueue<std::string>& q, std::size_t& sink) {
+	Optional<std::string> v = q.try_pop();
+	if(!v) {
+		return false;
+	}
+	sink += v->size();
+	return true;
+}
+
+static bool pop(LockedQueue<std::string>& q, std::size_t& sink) {
+	std::string v;
+	if(!q.try_pop(v)) {
+		return false;
+	}
+	sink += v.size();
+	return true;
+}
+
+// Millions of values through the queue per second.
+template <class Queue>
+static double run(unsigned producers, unsigned consumers, std::size_t per_producer) {
+	Queue queue(1024);
+	const std::size_t total = producers * per_producer;
+	std::vector<std::size_t> counts(consumers * 8u);
+	std::vector<std::size_t> sinks(consumers * 8u);
+	std::vector<std::thread> threads;
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned p = 0; p < producers; ++p) {
+		threads.emplace_back([&]() {
+			for(std::size_t i = 0; i < per_producer; ++i) {
+				std::string v("payload");
+				while(!queue.try_push(std::move(v))) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	// Consumers share the work out by count, so no one needs to know when the
+	// producers are done.
+	for(unsigned c = 0; c < consumers; ++c) {
+		std::size_t quota = total / consumers + (c < total % consumers ? 1u : 0u);
+		threads.emplace_back([&, c, quota]() {
+			std::size_t sink = 0;
+			for(std::size_t n = 0; n < quota;) {
+				if(pop(queue, sink)) {
+					++n;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+			sinks[c * 8u] = sink;
+		});
+	}
+	for(auto& t: threads) {
+		t.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return static_cast<double>(total) / seconds / 1e6;
+}
+
+int main() {
+	std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+	const std::size_t items = 1u << 21;
+	struct Shape {
+		const char* name;
+		unsigned producers;
+		unsigned consumers;
+	};
+	for(Shape shape : {Shape{"SPSC", 1, 1}, Shape{"MPSC", 4, 1}, Shape{"MPMC", 4, 4}}) {
+		std::size_t per_producer = items / shape.producers;
+		double lock_free = run<MPMCQueue<std::string>>(shape.producers, shape.consumers, per_producer);
+		double locked = run<LockedQueue<std::string>>(shape.producers, shape.consumers, per_producer);
+		std::printf(
+			"%s (%u:%u): MPMCQueue %7.2f Mops/s, mutex ring %7.2f Mops/s (%5.2fx)\n",
+			shape.name, shape.producers, shape.consumers, lock_free, locked, lock_free / locked
+		);
+	}
+	return 0;
+}
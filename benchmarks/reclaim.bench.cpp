@@ -0,0 +1,68 @@
+// Latency of emptying an Optional<std::vector<std::string>> of 256 heap-
+// allocated strings on a request thread: inline 'reset()' against
+// 'reset(defer_to(reclaimer))', which hands the vector to a background thread.
+// Only the reset itself is timed; the p50/p99/p999 of each are reported.
+
+#include "tim/optional/Reclaimer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+using tim::Optional;
+using tim::Reclaimer;
+
+using Payload = std::vector<std::string>;
+
+static Payload make_payload() {
+	return Payload(256, std::string(64, 'x'));
+}
+
+struct Percentiles {
+	double p50;
+	double p99;
+	double p999;
+	double max;
+};
+
+static Percentiles percentiles(std::vector<double>& samples) {
+	std::sort(samples.begin(), samples.end());
+	auto at = [&](double q) { return samples[static_cast<std::size_t>(q * static_cast<double>(samples.size() - 1))]; };
+	return Percentiles{at(0.5), at(0.99), at(0.999), samples.back()};
+}
+
+// Returns the nanoseconds taken by each call to 'reset(opt)'.
+template <class Reset>
+static std::vector<double> run(std::size_t requests, Reset reset) {
+	std::vector<double> samples;
+	samples.reserve(requests);
+	for(std::size_t i = 0; i < requests; ++i) {
+		Optional<Payload> opt(make_payload());
+		auto start = std::chrono::steady_clock::now();
+		reset(opt);
+		auto stop = std::chrono::steady_clock::now();
+		samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+	}
+	return samples;
+}
+
+static void print(const char* name, Percentiles p) {
+	std::printf("%-22s p50 %9.0f ns  p99 %9.0f ns  p999 %9.0f ns  max %9.0f ns\n", name, p.p50, p.p99, p.p999, p.max);
+}
+
+int main() {
+	std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+	const std::size_t requests = 20000;
+	std::vector<double> inline_samples = run(requests, [](Optional<Payload>& opt) { opt.reset(); });
+	std::vector<double> deferred_samples;
+	{
+		Reclaimer reclaimer;
+		deferred_samples = run(requests, [&](Optional<Payload>& opt) { opt.reset(tim::defer_to(reclaimer)); });
+	}
+	print("inline reset()", percentiles(inline_samples));
+	print("reset(defer_to(r))", percentiles(deferred_samples));
+	return 0;
+}
@@ -0,0 +1,70 @@
+// Growth of a buffer of Optional<std::unique_ptr<int>>: element-wise
+// move-construct + destroy versus tim::uninitialized_relocate().
+
+#include "tim/optional/Optional.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+using tim::Optional;
+
+using Element = Optional<std::unique_ptr<int>>;
+
+static Element* allocate(std::size_t n) {
+	return static_cast<Element*>(::operator new(n * sizeof(Element)));
+}
+
+static Element* grow_by_move(Element* data, std::size_t size, std::size_t new_capacity) {
+	Element* next = allocate(new_capacity);
+	for(std::size_t i = 0; i < size; ++i) {
+		::new (static_cast<void*>(next + i)) Element(std::move(data[i]));
+		std::destroy_at(data + i);
+	}
+	::operator delete(data);
+	return next;
+}
+
+static Element* grow_by_relocate(Element* data, std::size_t size, std::size_t new_capacity) {
+	Element* next = allocate(new_capacity);
+	tim::uninitialized_relocate(data, data + size, next);
+	::operator delete(data);
+	return next;
+}
+
+template <class Grow>
+static double run(std::size_t count, Grow grow) {
+	std::size_t capacity = 1;
+	std::size_t size = 0;
+	Element* data = allocate(capacity);
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t i = 0; i < count; ++i) {
+		if(size == capacity) {
+			data = grow(data, size, capacity * 2);
+			capacity *= 2;
+		}
+		if(i % 4 == 0) {
+			::new (static_cast<void*>(data + size)) Element();
+		} else {
+			::new (static_cast<void*>(data + size)) Element(nullptr);
+		}
+		++size;
+	}
+	auto stop = std::chrono::steady_clock::now();
+	std::destroy(data, data + size);
+	::operator delete(data);
+	return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(count);
+}
+
+int main() {
+	for(std::size_t count : {std::size_t(1) << 10, std::size_t(1) << 16, std::size_t(1) << 22}) {
+		double moved = run(count, grow_by_move);
+		double relocated = run(count, grow_by_relocate);
+		std::printf(
+			"%9zu elements: move+destroy %6.2f ns/elem, relocate %6.2f ns/elem (%.2fx)\n",
+			count, moved, relocated, moved / relocated
+		);
+	}
+	return 0;
+}
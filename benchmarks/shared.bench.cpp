@@ -0,0 +1,111 @@
+// Reader throughput on one read-mostly 64- or 256-byte value: N reader
+// threads load snapshots while one writer replaces the value every 100us.
+// SharedOptional against std::shared_mutex and std::mutex guarding an
+// Optional<T>.
+
+#include "tim/optional/SharedOptional.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+using tim::Optional;
+using tim::SharedOptional;
+
+template <std::size_t Bytes>
+struct Payload {
+	std::uint64_t words[Bytes / 8];
+};
+
+template <class T, class Mutex>
+struct Locked {
+	Optional<T> load() const {
+		if constexpr(std::is_same_v<Mutex, std::shared_mutex>) {
+			std::shared_lock<Mutex> lock(mutex);
+			return value;
+		} else {
+			std::lock_guard<Mutex> lock(mutex);
+			return value;
+		}
+	}
+
+	void store(const Optional<T>& v) {
+		std::lock_guard<Mutex> lock(mutex);
+		value = v;
+	}
+
+	mutable Mutex mutex;
+	Optional<T> value;
+};
+
+// Millions of loads per second over all readers.  Everyone stops at a fixed
+// deadline, so a writer starved by a reader-preferring lock cannot stall it.
+template <class T, class Slot>
+static double run(unsigned readers) {
+	using clock = std::chrono::steady_clock;
+	const auto duration = std::chrono::milliseconds(300);
+	Slot slot;
+	slot.store(T{});
+	std::vector<std::uint64_t> counts(readers * 8u);
+	std::vector<std::uint64_t> sinks(readers * 8u);
+	std::vector<std::thread> threads;
+	const auto deadline = clock::now() + duration;
+	for(unsigned r = 0; r < readers; ++r) {
+		threads.emplace_back([&, r]() {
+			std::uint64_t n = 0;
+			std::uint64_t sink = 0;
+			do {
+				for(int i = 0; i < 256; ++i) {
+					Optional<T> v = slot.load();
+					sink += v->words[0];
+				}
+				n += 256;
+			} while(clock::now() < deadline);
+			counts[r * 8u] = n;
+			sinks[r * 8u] = sink;
+		});
+	}
+	std::thread writer([&]() {
+		T value{};
+		while(clock::now() < deadline) {
+			++value.words[0];
+			slot.store(value);
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	});
+	writer.join();
+	for(auto& t: threads) {
+		t.join();
+	}
+	std::uint64_t total = 0;
+	for(unsigned r = 0; r < readers; ++r) {
+		total += counts[r * 8u];
+	}
+	return static_cast<double>(total) / std::chrono::duration<double>(duration).count() / 1e6;
+}
+
+template <std::size_t Bytes>
+static void bench() {
+	using T = Payload<Bytes>;
+	std::printf("%zu-byte payload (Mloads/s)\n", Bytes);
+	for(unsigned readers : {1u, 2u, 4u, 8u, 16u, 64u}) {
+		double seq = run<T, SharedOptional<T>>(readers);
+		double shared = run<T, Locked<T, std::shared_mutex>>(readers);
+		double plain = run<T, Locked<T, std::mutex>>(readers);
+		std::printf(
+			"  %2u readers: seqlock %8.2f, shared_mutex %8.2f (%5.2fx), mutex %8.2f (%5.2fx)\n",
+			readers, seq, shared, seq / shared, plain, seq / plain
+		);
+	}
+}
+
+int main() {
+	std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+	bench<64>();
+	bench<256>();
+	return 0;
+}
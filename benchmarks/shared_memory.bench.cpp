@@ -0,0 +1,84 @@
+// Publish-to-observe latency between two processes through
+// SharedMemoryOptional in a shared mapping.  The parent publishes a 64-byte
+// record on one slot; the forked child polls for it and echoes it back on a
+// second slot.  Half the mean round trip is reported as the one-way latency.
+
+#include "tim/optional/SharedMemoryOptional.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using tim::Optional;
+using tim::SharedMemoryOptional;
+
+struct Record {
+	std::uint64_t words[8];
+};
+
+struct Channel {
+	SharedMemoryOptional<Record> ping;
+	SharedMemoryOptional<Record> pong;
+};
+
+// Polls 'slot' until it reaches 'generation', yielding now and then so that
+// the other process can run on a machine with few cores.
+static Record await(const SharedMemoryOptional<Record>& slot, std::uint64_t generation) {
+	for(unsigned polls = 0;; ++polls) {
+		std::uint64_t seen;
+		Optional<Record> r = slot.try_read(seen);
+		if(seen >= generation && r) {
+			return *r;
+		}
+		if(polls % 64u == 63u) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+int main() {
+	std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+	const std::uint64_t rounds = 100000;
+	void* region = ::mmap(nullptr, sizeof(Channel), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(region == MAP_FAILED) {
+		std::perror("mmap");
+		return 1;
+	}
+	auto* channel = ::new (region) Channel();
+	pid_t child = ::fork();
+	if(child < 0) {
+		std::perror("fork");
+		return 1;
+	}
+	if(child == 0) {
+		for(std::uint64_t i = 1; i <= rounds; ++i) {
+			channel->pong.publish(await(channel->ping, i));
+		}
+		::_exit(0);
+	}
+	Record record{};
+	std::uint64_t sink = 0;
+	auto start = std::chrono::steady_clock::now();
+	for(std::uint64_t i = 1; i <= rounds; ++i) {
+		record.words[0] = i;
+		channel->ping.publish(record);
+		sink += await(channel->pong, i).words[0];
+	}
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	int status = 0;
+	::waitpid(child, &status, 0);
+	if(sink != rounds * (rounds + 1) / 2) {
+		std::printf("lost an echo\n");
+		return 1;
+	}
+	double round_trip = ns / static_cast<double>(rounds);
+	std::printf("round trip %8.1f ns, publish-to-observe %8.1f ns\n", round_trip, round_trip / 2.0);
+	::munmap(region, sizeof(Channel));
+	return 0;
+}
@@ -0,0 +1,82 @@
+// Request/response handoff latency between two threads.  The requester posts
+// a request through an atomic mailbox and blocks for the reply; the reply
+// travels through a fresh std::promise/std::future pair per round, or through
+// one WaitableOptional that the requester resets and reuses.
+
+#include "tim/optional/WaitableOptional.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <future>
+#include <thread>
+
+using tim::WaitableOptional;
+
+struct PromiseReply {
+	std::promise<long> promise;
+	std::future<long> future = promise.get_future();
+
+	void set(long v) { promise.set_value(v); }
+	long wait() { return future.get(); }
+};
+
+struct WaitableReply {
+	WaitableOptional<long> value;
+
+	void set(long v) { value.set(v); }
+	long wait() { return value.wait(); }
+};
+
+template <class Reply>
+struct Request {
+	long argument;
+	Reply* reply;
+};
+
+// Returns nanoseconds per round trip.
+template <class Reply, bool Reuse>
+static double run(std::size_t rounds) {
+	std::atomic<Request<Reply>*> mailbox{nullptr};
+	std::thread server([&]() {
+		for(std::size_t i = 0; i < rounds; ++i) {
+			Request<Reply>* request;
+			while(!(request = mailbox.exchange(nullptr, std::memory_order_acquire))) {
+				std::this_thread::yield();
+			}
+			request->reply->set(request->argument + 1);
+		}
+	});
+	long sink = 0;
+	WaitableReply pooled;
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t i = 0; i < rounds; ++i) {
+		if constexpr(Reuse) {
+			pooled.value.reset();
+			Request<Reply> request{static_cast<long>(i), &pooled};
+			mailbox.store(&request, std::memory_order_release);
+			sink += pooled.wait();
+		} else {
+			Reply reply;
+			Request<Reply> request{static_cast<long>(i), &reply};
+			mailbox.store(&request, std::memory_order_release);
+			sink += reply.wait();
+		}
+	}
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	server.join();
+	if(sink == 42) {
+		std::printf("\n");
+	}
+	return ns / static_cast<double>(rounds);
+}
+
+int main() {
+	std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+	const std::size_t rounds = 200000;
+	double promise = run<PromiseReply, false>(rounds);
+	double waitable = run<WaitableReply, true>(rounds);
+	std::printf("promise/future   : %8.1f ns per round trip\n", promise);
+	std::printf("WaitableOptional : %8.1f ns per round trip (%.2fx)\n", waitable, promise / waitable);
+	return 0;
+}
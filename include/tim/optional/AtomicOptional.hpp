@@ -0,0 +1,201 @@
+#ifndef TIM_OPTIONAL_ATOMICOPTIONAL_HPP
+#define TIM_OPTIONAL_ATOMICOPTIONAL_HPP
+
+#include "tim/optional/Optional.hpp"
+#include "tim/optional/detail/AtomicWord.hpp"
+#include <type_traits>
+#include <atomic>
+#include <new>
+#include <cstring>
+#include <cstddef>
+
+namespace tim {
+
+inline namespace optional {
+
+namespace detail {
+
+// Zeroes the padding bits of a trivially copyable object, so that equal values
+// have equal object representations.
+template <class T>
+void clear_padding(T& value) noexcept {
+#if defined(__has_builtin)
+# if __has_builtin(__builtin_clear_padding)
+	__builtin_clear_padding(std::addressof(value));
+# endif
+#endif
+	static_cast<void>(value);
+}
+
+} /* namespace detail */
+
+/*
+ * An atomic Optional<T> for trivially copyable 'T' of at most 15 bytes.  The
+ * value and a presence byte are packed into one 8- or 16-byte word, and every
+ * operation is a single atomic operation on that word.
+ *
+ * As with std::atomic, 'compare_exchange_*' compares object representations:
+ * two empty optionals are always equal, and engaged ones are equal when their
+ * values are bitwise equal (padding bits are cleared on the way in, where the
+ * compiler allows it).
+ */
+template <class T>
+class AtomicOptional {
+	static_assert(std::is_same_v<std::remove_cv_t<T>, T> && std::is_object_v<T>,
+		"AtomicOptional<T> requires a cv-unqualified object type.");
+	static_assert(std::is_trivially_copyable_v<T>,
+		"AtomicOptional<T> requires a trivially copyable T.");
+	static_assert(sizeof(T) < 16,
+		"AtomicOptional<T> requires that T and a presence byte fit in 16 bytes.");
+
+	static constexpr std::size_t word_size = sizeof(T) < 8 ? 8 : 16;
+	using atomic_word = detail::AtomicWord<word_size>;
+	using word_type = typename atomic_word::word_type;
+
+public:
+	using value_type = T;
+
+	static constexpr bool is_always_lock_free = atomic_word::is_always_lock_free;
+
+	constexpr AtomicOptional() noexcept = default;
+
+	constexpr AtomicOptional(nullopt_t) noexcept:
+		AtomicOptional()
+	{
+
+	}
+
+	AtomicOptional(const Optional<T>& value) noexcept:
+		word_(encode(value))
+	{
+
+	}
+
+	AtomicOptional(const AtomicOptional&) = delete;
+	AtomicOptional& operator=(const AtomicOptional&) = delete;
+
+	Optional<T> operator=(const Optional<T>& value) noexcept {
+		store(value);
+		return value;
+	}
+
+	Optional<T> operator=(nullopt_t) noexcept {
+		store(nullopt);
+		return nullopt;
+	}
+
+	bool is_lock_free() const noexcept {
+		return word_.is_lock_free();
+	}
+
+	Optional<T> load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+		return decode(word_.load(order));
+	}
+
+	operator Optional<T>() const noexcept {
+		return load();
+	}
+
+	void store(const Optional<T>& value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		word_.store(encode(value), order);
+	}
+
+	Optional<T> exchange(const Optional<T>& value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return decode(word_.exchange(encode(value), order));
+	}
+
+	bool compare_exchange_weak(
+		Optional<T>& expected,
+		const Optional<T>& desired,
+		std::memory_order success,
+		std::memory_order failure
+	) noexcept {
+		word_type want = encode(expected);
+		if(word_.compare_exchange_weak(want, encode(desired), success, failure)) {
+			return true;
+		}
+		expected = decode(want);
+		return false;
+	}
+
+	bool compare_exchange_weak(
+		Optional<T>& expected,
+		const Optional<T>& desired,
+		std::memory_order order = std::memory_order_seq_cst
+	) noexcept {
+		return compare_exchange_weak(expected, desired, order, detail::failure_order(order));
+	}
+
+	bool compare_exchange_strong(
+		Optional<T>& expected,
+		const Optional<T>& desired,
+		std::memory_order success,
+		std::memory_order failure
+	) noexcept {
+		word_type want = encode(expected);
+		if(word_.compare_exchange_strong(want, encode(desired), success, failure)) {
+			return true;
+		}
+		expected = decode(want);
+		return false;
+	}
+
+	bool compare_exchange_strong(
+		Optional<T>& expected,
+		const Optional<T>& desired,
+		std::memory_order order = std::memory_order_seq_cst
+	) noexcept {
+		return compare_exchange_strong(expected, desired, order, detail::failure_order(order));
+	}
+
+	// Empties this and returns what it held.
+	Optional<T> take(std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return exchange(nullopt, order);
+	}
+
+	// Stores 'value' if this is empty.  Returns false, leaving this unchanged,
+	// if it already held a value.
+	bool emplace_if_empty(const T& value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		word_type expected = empty_word();
+		return word_.compare_exchange_strong(expected, encode(Optional<T>(value)), order, detail::failure_order(order));
+	}
+
+private:
+	// The value's bytes, then the presence byte, then zeros.  An empty optional
+	// is all zeros.
+	static constexpr word_type empty_word() noexcept {
+		return word_type{};
+	}
+
+	static word_type encode(const Optional<T>& value) noexcept {
+		unsigned char bytes[word_size] = {};
+		if(value.has_value()) {
+			T copy = *value;
+			detail::clear_padding(copy);
+			std::memcpy(bytes, std::addressof(copy), sizeof(T));
+			bytes[sizeof(T)] = 1u;
+		}
+		word_type word;
+		std::memcpy(std::addressof(word), bytes, sizeof(word));
+		return word;
+	}
+
+	static Optional<T> decode(const word_type& word) noexcept {
+		unsigned char bytes[word_size];
+		std::memcpy(bytes, std::addressof(word), sizeof(word));
+		if(!bytes[sizeof(T)]) {
+			return nullopt;
+		}
+		alignas(T) unsigned char storage[sizeof(T)];
+		std::memcpy(storage, bytes, sizeof(T));
+		return Optional<T>(*std::launder(reinterpret_cast<const T*>(storage)));
+	}
+
+	atomic_word word_;
+};
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_ATOMICOPTIONAL_HPP */
@@ -0,0 +1,812 @@
+#ifndef TIM_OPTIONAL_BOXEDOPTIONAL_HPP
+#define TIM_OPTIONAL_BOXEDOPTIONAL_HPP
+
+#include "tim/optional/Optional.hpp"
+#include "tim/optional/PoolAllocator.hpp"
+#include <type_traits>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include <cassert>
+#include <cstddef>
+
+namespace tim {
+
+inline namespace optional {
+
+template <class T, class Allocator>
+class BoxedOptional;
+
+namespace detail {
+
+template <class T>
+struct is_boxed_optional: std::false_type {};
+
+template <class T, class Allocator>
+struct is_boxed_optional<BoxedOptional<T, Allocator>>: std::true_type {};
+
+template <class T>
+inline constexpr bool is_boxed_optional_v = is_boxed_optional<remove_cvref_t<T>>::value;
+
+// The payload pointer, with the allocator folded into it when it is empty.
+template <class T, class Allocator>
+struct BoxedOptionalStorage: Allocator {
+	BoxedOptionalStorage(const Allocator& alloc) noexcept:
+		Allocator(alloc)
+	{
+
+	}
+
+	BoxedOptionalStorage(Allocator&& alloc) noexcept:
+		Allocator(std::move(alloc))
+	{
+
+	}
+
+	T* ptr = nullptr;
+};
+
+} /* namespace detail */
+
+/*
+ * An Optional<T> that keeps its payload out of line: one pointer (null when
+ * empty) plus the allocator, which takes no space when it is stateless.  For
+ * large payloads that are usually absent, where Optional<T>'s inline storage
+ * is mostly wasted.
+ *
+ * The payload is allocated through 'Allocator' when this is engaged and
+ * freed when it is emptied; by default that is PoolAllocator<T>, which
+ * serves it from a size-class pool.  Re-engaging an engaged box ('emplace()'
+ * or assignment) reuses its block.  Moves transfer the block and never touch
+ * the payload.
+ *
+ * The interface follows Optional<T>'s, including the comparison operators
+ * and std::hash, which agree with Optional<T>'s for equal values.  'get()'
+ * views the payload as an Optional<T&>, and 'unbox()' copies or moves it
+ * into an inline Optional<T>.  The allocator is fixed at construction:
+ * assignment never propagates it, and swapping requires equal allocators.
+ */
+template <class T, class Allocator = PoolAllocator<T>>
+class BoxedOptional {
+	static_assert(std::is_object_v<T> && !std::is_array_v<T>,
+		"BoxedOptional<T> requires a non-array object type.");
+	static_assert(!std::is_same_v<std::remove_cv_t<T>, nullopt_t> && !std::is_same_v<std::remove_cv_t<T>, in_place_t>,
+		"BoxedOptional<T> requires a 'T' other than nullopt_t and in_place_t.");
+	static_assert(std::is_nothrow_destructible_v<T>,
+		"BoxedOptional<T> requires a nothrow destructible T.");
+
+	using alloc_traits = std::allocator_traits<Allocator>;
+
+	static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+		"BoxedOptional<T, Allocator> requires an allocator of 'T'.");
+	static_assert(std::is_same_v<typename alloc_traits::pointer, T*>,
+		"BoxedOptional<T, Allocator> requires an allocator that returns 'T*'.");
+
+	template <class U>
+	static constexpr bool converts_from_v = !std::is_same_v<detail::remove_cvref_t<U>, BoxedOptional>
+		&& !std::is_same_v<detail::remove_cvref_t<U>, nullopt_t>
+		&& !std::is_same_v<detail::remove_cvref_t<U>, in_place_t>
+		&& !detail::is_optional_v<U>
+		&& std::is_constructible_v<T, U&&>;
+
+public:
+	using value_type = T;
+	using allocator_type = Allocator;
+
+	BoxedOptional() noexcept(std::is_nothrow_default_constructible_v<Allocator>):
+		box_(Allocator())
+	{
+
+	}
+
+	explicit BoxedOptional(const Allocator& alloc) noexcept:
+		box_(alloc)
+	{
+
+	}
+
+	BoxedOptional(nullopt_t) noexcept(std::is_nothrow_default_constructible_v<Allocator>):
+		BoxedOptional()
+	{
+
+	}
+
+	template <
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, Args&&...>,
+			bool
+		> = false
+	>
+	explicit BoxedOptional(in_place_t, Args&& ... args):
+		BoxedOptional()
+	{
+		box_.ptr = make(std::forward<Args>(args)...);
+	}
+
+	template <
+		class U,
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, std::initializer_list<U>&, Args&&...>,
+			bool
+		> = false
+	>
+	explicit BoxedOptional(in_place_t, std::initializer_list<U> ilist, Args&& ... args):
+		BoxedOptional()
+	{
+		box_.ptr = make(ilist, std::forward<Args>(args)...);
+	}
+
+	template <
+		class U = T,
+		std::enable_if_t<
+			converts_from_v<U> && !std::is_convertible_v<U&&, T>,
+			bool
+		> = false
+	>
+	explicit BoxedOptional(U&& v):
+		BoxedOptional()
+	{
+		box_.ptr = make(std::forward<U>(v));
+	}
+
+	template <
+		class U = T,
+		std::enable_if_t<
+			converts_from_v<U> && std::is_convertible_v<U&&, T>,
+			bool
+		> = false
+	>
+	BoxedOptional(U&& v):
+		BoxedOptional()
+	{
+		box_.ptr = make(std::forward<U>(v));
+	}
+
+	// Boxes a copy of (or moves from) the payload of 'other'.
+	BoxedOptional(const Optional<T>& other):
+		BoxedOptional()
+	{
+		if(other) {
+			box_.ptr = make(*other);
+		}
+	}
+
+	BoxedOptional(Optional<T>&& other):
+		BoxedOptional()
+	{
+		if(other) {
+			box_.ptr = make(std::move(*other));
+		}
+	}
+
+	BoxedOptional(const BoxedOptional& other):
+		box_(alloc_traits::select_on_container_copy_construction(other.box_))
+	{
+		if(other) {
+			box_.ptr = make(*other);
+		}
+	}
+
+	BoxedOptional(BoxedOptional&& other) noexcept:
+		box_(std::move(static_cast<Allocator&>(other.box_)))
+	{
+		box_.ptr = std::exchange(other.box_.ptr, nullptr);
+	}
+
+	~BoxedOptional() {
+		reset();
+	}
+
+	BoxedOptional& operator=(const BoxedOptional& other) {
+		if(!other) {
+			reset();
+		} else if(this != std::addressof(other)) {
+			assign_value(*other);
+		}
+		return *this;
+	}
+
+	// Takes over the block of 'other' when the allocators are equal.
+	BoxedOptional& operator=(BoxedOptional&& other) noexcept(alloc_traits::is_always_equal::value) {
+		if(this == std::addressof(other)) {
+			return *this;
+		}
+		if(same_allocator(other)) {
+			reset();
+			box_.ptr = std::exchange(other.box_.ptr, nullptr);
+		} else if(other) {
+			assign_value(std::move(*other));
+		} else {
+			reset();
+		}
+		return *this;
+	}
+
+	BoxedOptional& operator=(nullopt_t) noexcept {
+		reset();
+		return *this;
+	}
+
+	template <
+		class U = T,
+		std::enable_if_t<
+			converts_from_v<U> && std::is_assignable_v<T&, U&&>
+			&& !(std::is_scalar_v<T> && std::is_same_v<std::decay_t<U>, T>),
+			bool
+		> = false
+	>
+	BoxedOptional& operator=(U&& v) {
+		assign_value(std::forward<U>(v));
+		return *this;
+	}
+
+	BoxedOptional& operator=(const Optional<T>& other) {
+		if(other) {
+			assign_value(*other);
+		} else {
+			reset();
+		}
+		return *this;
+	}
+
+	BoxedOptional& operator=(Optional<T>&& other) {
+		if(other) {
+			assign_value(std::move(*other));
+		} else {
+			reset();
+		}
+		return *this;
+	}
+
+	// Constructs the payload from 'args...', in the current block if this is
+	// engaged.  If the constructor throws, this is left empty.
+	template <
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, Args&&...>,
+			bool
+		> = false
+	>
+	T& emplace(Args&& ... args) {
+		return emplace_impl(std::forward<Args>(args)...);
+	}
+
+	template <
+		class U,
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, std::initializer_list<U>&, Args&&...>,
+			bool
+		> = false
+	>
+	T& emplace(std::initializer_list<U> ilist, Args&& ... args) {
+		return emplace_impl(ilist, std::forward<Args>(args)...);
+	}
+
+	// Exchanges the boxes.  The allocators must compare equal.
+	void swap(BoxedOptional& other) noexcept {
+		assert(same_allocator(other));
+		std::swap(box_.ptr, other.box_.ptr);
+	}
+
+	void reset() noexcept {
+		if(T* p = std::exchange(box_.ptr, nullptr)) {
+			alloc_traits::destroy(box_, p);
+			alloc_traits::deallocate(box_, p, 1u);
+		}
+	}
+
+	allocator_type get_allocator() const noexcept {
+		return box_;
+	}
+
+	bool has_value() const noexcept {
+		return box_.ptr != nullptr;
+	}
+
+	explicit operator bool() const noexcept {
+		return has_value();
+	}
+
+	const T* operator->() const {
+		assert_has_value();
+		return box_.ptr;
+	}
+
+	T* operator->() {
+		assert_has_value();
+		return box_.ptr;
+	}
+
+	const T&& operator*() const&& {
+		assert_has_value();
+		return std::move(*box_.ptr);
+	}
+
+	const T& operator*() const& {
+		assert_has_value();
+		return *box_.ptr;
+	}
+
+	T&& operator*() && {
+		assert_has_value();
+		return std::move(*box_.ptr);
+	}
+
+	T& operator*() & {
+		assert_has_value();
+		return *box_.ptr;
+	}
+
+	const T& value() const& noexcept(false) {
+		if(!has_value()) {
+			throw BadOptionalAccess();
+		}
+		return *box_.ptr;
+	}
+
+	const T&& value() const&& noexcept(false) {
+		if(!has_value()) {
+			throw BadOptionalAccess();
+		}
+		return std::move(*box_.ptr);
+	}
+
+	T& value() & noexcept(false) {
+		if(!has_value()) {
+			throw BadOptionalAccess();
+		}
+		return *box_.ptr;
+	}
+
+	T&& value() && noexcept(false) {
+		if(!has_value()) {
+			throw BadOptionalAccess();
+		}
+		return std::move(*box_.ptr);
+	}
+
+	template <class U>
+	T value_or(U&& alt) const& {
+		if(has_value()) {
+			return *box_.ptr;
+		}
+		return std::forward<U>(alt);
+	}
+
+	template <class U>
+	T value_or(U&& alt) && {
+		if(has_value()) {
+			return std::move(*box_.ptr);
+		}
+		return std::forward<U>(alt);
+	}
+
+	template <class F>
+	T value_or_else(F&& f) const& {
+		static_assert(std::is_convertible_v<std::invoke_result_t<F>, T>,
+			"BoxedOptional<T>::value_or_else(): 'f()' must be convertible to T.");
+		if(has_value()) {
+			return *box_.ptr;
+		}
+		return detail::invoke(std::forward<F>(f));
+	}
+
+	template <class F>
+	T value_or_else(F&& f) && {
+		static_assert(std::is_convertible_v<std::invoke_result_t<F>, T>,
+			"BoxedOptional<T>::value_or_else(): 'f()' must be convertible to T.");
+		if(has_value()) {
+			return std::move(*box_.ptr);
+		}
+		return detail::invoke(std::forward<F>(f));
+	}
+
+	// The payload as an Optional<T&>.
+	Optional<T&> get() noexcept {
+		if(has_value()) {
+			return Optional<T&>(*box_.ptr);
+		}
+		return nullopt;
+	}
+
+	Optional<const T&> get() const noexcept {
+		if(has_value()) {
+			return Optional<const T&>(*box_.ptr);
+		}
+		return nullopt;
+	}
+
+	// The payload in an inline Optional<T>.
+	Optional<T> unbox() const& {
+		if(has_value()) {
+			return Optional<T>(*box_.ptr);
+		}
+		return nullopt;
+	}
+
+	Optional<T> unbox() && {
+		if(has_value()) {
+			return Optional<T>(std::move(*box_.ptr));
+		}
+		return nullopt;
+	}
+
+	/*
+	 * Monadic operations, as for Optional<T>.  'and_then(f)' and
+	 * 'transform(f)' return inline Optionals; 'or_else(f)' and 'filter(p)'
+	 * return a BoxedOptional.
+	 */
+	template <class F>
+	auto and_then(F&& f) & { return and_then_impl(*this, std::forward<F>(f)); }
+
+	template <class F>
+	auto and_then(F&& f) const& { return and_then_impl(*this, std::forward<F>(f)); }
+
+	template <class F>
+	auto and_then(F&& f) && { return and_then_impl(std::move(*this), std::forward<F>(f)); }
+
+	template <class F>
+	auto transform(F&& f) & { return transform_impl(*this, std::forward<F>(f)); }
+
+	template <class F>
+	auto transform(F&& f) const& { return transform_impl(*this, std::forward<F>(f)); }
+
+	template <class F>
+	auto transform(F&& f) && { return transform_impl(std::move(*this), std::forward<F>(f)); }
+
+	template <class F>
+	BoxedOptional or_else(F&& f) const& {
+		static_assert(std::is_same_v<detail::remove_cvref_t<std::invoke_result_t<F>>, BoxedOptional>,
+			"BoxedOptional<T>::or_else(): 'f' must return BoxedOptional<T>.");
+		if(has_value()) {
+			return *this;
+		}
+		return detail::invoke(std::forward<F>(f));
+	}
+
+	template <class F>
+	BoxedOptional or_else(F&& f) && {
+		static_assert(std::is_same_v<detail::remove_cvref_t<std::invoke_result_t<F>>, BoxedOptional>,
+			"BoxedOptional<T>::or_else(): 'f' must return BoxedOptional<T>.");
+		if(has_value()) {
+			return std::move(*this);
+		}
+		return detail::invoke(std::forward<F>(f));
+	}
+
+	template <class P>
+	BoxedOptional filter(P&& pred) const& {
+		if(has_value() && detail::invoke(std::forward<P>(pred), std::as_const(*box_.ptr))) {
+			return *this;
+		}
+		return BoxedOptional(static_cast<const Allocator&>(box_));
+	}
+
+	template <class P>
+	BoxedOptional filter(P&& pred) && {
+		if(has_value() && detail::invoke(std::forward<P>(pred), std::as_const(*box_.ptr))) {
+			return std::move(*this);
+		}
+		return BoxedOptional(static_cast<const Allocator&>(box_));
+	}
+
+private:
+	template <class Self, class F>
+	static auto and_then_impl(Self&& self, F&& f) {
+		using result_type = detail::and_then_result_t<F, decltype(*std::forward<Self>(self))>;
+		static_assert(detail::is_optional<result_type>::value,
+			"BoxedOptional<T>::and_then(): 'f' must return a specialization of Optional.");
+		if(self.has_value()) {
+			return result_type(detail::invoke(std::forward<F>(f), *std::forward<Self>(self)));
+		}
+		return result_type(nullopt);
+	}
+
+	template <class Self, class F>
+	static auto transform_impl(Self&& self, F&& f) {
+		using result_type = detail::transform_result_t<std::invoke_result_t<F, decltype(*std::forward<Self>(self))>>;
+		if(self.has_value()) {
+			return detail::invoke_into_optional(std::forward<F>(f), *std::forward<Self>(self));
+		}
+		return result_type(nullopt);
+	}
+
+	void assert_has_value() const {
+#if defined(assert) && !defined(TIM_OPTIONAL_OPTIONAL_DISABLE_ASSERTIONS)
+		assert(has_value());
+#endif
+	}
+
+	bool same_allocator(const BoxedOptional& other) const noexcept {
+		if constexpr(alloc_traits::is_always_equal::value) {
+			static_cast<void>(other);
+			return true;
+		} else {
+			return static_cast<const Allocator&>(box_) == static_cast<const Allocator&>(other.box_);
+		}
+	}
+
+	// Allocates a block and constructs a payload in it from 'args...'.
+	template <class ... Args>
+	T* make(Args&& ... args) {
+		T* p = alloc_traits::allocate(box_, 1u);
+		auto guard = detail::make_manual_scope_guard([&]() {
+			alloc_traits::deallocate(box_, p, 1u);
+		});
+		alloc_traits::construct(box_, p, std::forward<Args>(args)...);
+		guard.active = false;
+		return p;
+	}
+
+	template <class ... Args>
+	T& emplace_impl(Args&& ... args) {
+		if(T* p = std::exchange(box_.ptr, nullptr)) {
+			alloc_traits::destroy(box_, p);
+			auto guard = detail::make_manual_scope_guard([&]() {
+				alloc_traits::deallocate(box_, p, 1u);
+			});
+			alloc_traits::construct(box_, p, std::forward<Args>(args)...);
+			guard.active = false;
+			box_.ptr = p;
+		} else {
+			box_.ptr = make(std::forward<Args>(args)...);
+		}
+		return *box_.ptr;
+	}
+
+	// Assigns to the payload if this is engaged, and boxes 'value' otherwise.
+	template <class V>
+	void assign_value(V&& value) {
+		if(box_.ptr) {
+			*box_.ptr = std::forward<V>(value);
+		} else {
+			box_.ptr = make(std::forward<V>(value));
+		}
+	}
+
+	detail::BoxedOptionalStorage<T, Allocator> box_;
+};
+
+/* --- Comparisons, through the payloads as Optional<T&> --- */
+template <class T1, class A1, class T2, class A2>
+auto operator==(const BoxedOptional<T1, A1>& lhs, const BoxedOptional<T2, A2>& rhs) -> decltype(lhs.get() == rhs.get()) {
+	return lhs.get() == rhs.get();
+}
+
+template <class T1, class A1, class T2, class A2>
+auto operator!=(const BoxedOptional<T1, A1>& lhs, const BoxedOptional<T2, A2>& rhs) -> decltype(lhs.get() != rhs.get()) {
+	return lhs.get() != rhs.get();
+}
+
+template <class T1, class A1, class T2, class A2>
+auto operator<(const BoxedOptional<T1, A1>& lhs, const BoxedOptional<T2, A2>& rhs) -> decltype(lhs.get() < rhs.get()) {
+	return lhs.get() < rhs.get();
+}
+
+template <class T1, class A1, class T2, class A2>
+auto operator<=(const BoxedOptional<T1, A1>& lhs, const BoxedOptional<T2, A2>& rhs) -> decltype(lhs.get() <= rhs.get()) {
+	return lhs.get() <= rhs.get();
+}
+
+template <class T1, class A1, class T2, class A2>
+auto operator>(const BoxedOptional<T1, A1>& lhs, const BoxedOptional<T2, A2>& rhs) -> decltype(lhs.get() > rhs.get()) {
+	return lhs.get() > rhs.get();
+}
+
+template <class T1, class A1, class T2, class A2>
+auto operator>=(const BoxedOptional<T1, A1>& lhs, const BoxedOptional<T2, A2>& rhs) -> decltype(lhs.get() >= rhs.get()) {
+	return lhs.get() >= rhs.get();
+}
+
+template <class T, class A>
+bool operator==(const BoxedOptional<T, A>& lhs, nullopt_t) noexcept { return !lhs; }
+
+template <class T, class A>
+bool operator==(nullopt_t, const BoxedOptional<T, A>& rhs) noexcept { return !rhs; }
+
+template <class T, class A>
+bool operator!=(const BoxedOptional<T, A>& lhs, nullopt_t) noexcept { return lhs.has_value(); }
+
+template <class T, class A>
+bool operator!=(nullopt_t, const BoxedOptional<T, A>& rhs) noexcept { return rhs.has_value(); }
+
+template <class T, class A>
+bool operator<(const BoxedOptional<T, A>&, nullopt_t) noexcept { return false; }
+
+template <class T, class A>
+bool operator<(nullopt_t, const BoxedOptional<T, A>& rhs) noexcept { return rhs.has_value(); }
+
+template <class T, class A>
+bool operator<=(const BoxedOptional<T, A>& lhs, nullopt_t) noexcept { return !lhs; }
+
+template <class T, class A>
+bool operator<=(nullopt_t, const BoxedOptional<T, A>&) noexcept { return true; }
+
+template <class T, class A>
+bool operator>(const BoxedOptional<T, A>& lhs, nullopt_t) noexcept { return lhs.has_value(); }
+
+template <class T, class A>
+bool operator>(nullopt_t, const BoxedOptional<T, A>&) noexcept { return false; }
+
+template <class T, class A>
+bool operator>=(const BoxedOptional<T, A>&, nullopt_t) noexcept { return true; }
+
+template <class T, class A>
+bool operator>=(nullopt_t, const BoxedOptional<T, A>& rhs) noexcept { return !rhs; }
+
+// Against values.
+template <class T, class A, class U, std::enable_if_t<!detail::is_boxed_optional_v<U> && !detail::is_optional_v<U> && !std::is_same_v<U, nullopt_t>, bool> = false>
+auto operator==(const BoxedOptional<T, A>& lhs, const U& rhs) -> decltype(lhs.get() == rhs) {
+	return lhs.get() == rhs;
+}
+
+template <class U, class T, class A, std::enable_if_t<!detail::is_boxed_optional_v<U> && !detail::is_optional_v<U> && !std::is_same_v<U, nullopt_t>, bool> = false>
+auto operator==(const U& lhs, const BoxedOptional<T, A>& rhs) -> decltype(lhs == rhs.get()) {
+	return lhs == rhs.get();
+}
+
+template <class T, class A, class U, std::enable_if_t<!detail::is_boxed_optional_v<U> && !detail::is_optional_v<U> && !std::is_same_v<U, nullopt_t>, bool> = false>
+auto operator!=(const BoxedOptional<T, A>& lhs, const U& rhs) -> decltype(lhs.get() != rhs) {
+	return lhs.get() != rhs;
+}
+
+template <class U, class T, class A, std::enable_if_t<!detail::is_boxed_optional_v<U> && !detail::is_optional_v<U> && !std::is_same_v<U, nullopt_t>, bool> = false>
+auto operator!=(const U& lhs, const BoxedOptional<T, A>& rhs) -> decltype(lhs != rhs.get()) {
+	return lhs != rhs.get();
+}
+
+template <class T, class A, class U, std::enable_if_t<!detail::is_boxed_optional_v<U> && !detail::is_optional_v<U> && !std::is_same_v<U, nullopt_t>, bool> = false>
+auto operator<(const BoxedOptional<T, A>& lhs, const U& rhs) -> decltype(lhs.get() < rhs) {
+	return lhs.get() < rhs;
+}
+
+template <class U, class T, class A, std::enable_if_t<!detail::is_boxed_optional_v<U> && !detail::is_optional_v<U> && !std::is_same_v<U, nullopt_t>, bool> = false>
+auto operator<(const U& lhs, const BoxedOptional<T, A>& rhs) -> decltype(lhs < rhs.get()) {
+	return lhs < rhs.get();
+}
+
+template <class T, class A, class U, std::enable_if_t<!detail::is_boxed_optional_v<U> && !detail::is_optional_v<U> && !std::is_same_v<U, nullopt_t>, bool> = false>
+auto operator<=(const BoxedOptional<T, A>& lhs, const U& rhs) -> decltype(lhs.get() <= rhs) {
+	return lhs.get() <= rhs;
+}
+
+template <class U, class T, class A, std::enable_if_t<!detail::is_boxed_optional_v<U> && !detail::is_optional_v<U> && !std::is_same_v<U, nullopt_t>, bool> = false>
+auto operator<=(const U& lhs, const BoxedOptional<T, A>& rhs) -> decltype(lhs <= rhs.get()) {
+	return lhs <= rhs.get();
+}
+
+template <class T, class A, class U, std::enable_if_t<!detail::is_boxed_optional_v<U> && !detail::is_optional_v<U> && !std::is_same_v<U, nullopt_t>, bool> = false>
+auto operator>(const BoxedOptional<T, A>& lhs, const U& rhs) -> decltype(lhs.get() > rhs) {
+	return lhs.get() > rhs;
+}
+
+template <class U, class T, class A, std::enable_if_t<!detail::is_boxed_optional_v<U> && !detail::is_optional_v<U> && !std::is_same_v<U, nullopt_t>, bool> = false>
+auto operator>(const U& lhs, const BoxedOptional<T, A>& rhs) -> decltype(lhs > rhs.get()) {
+	return lhs > rhs.get();
+}
+
+template <class T, class A, class U, std::enable_if_t<!detail::is_boxed_optional_v<U> && !detail::is_optional_v<U> && !std::is_same_v<U, nullopt_t>, bool> = false>
+auto operator>=(const BoxedOptional<T, A>& lhs, const U& rhs) -> decltype(lhs.get() >= rhs) {
+	return lhs.get() >= rhs;
+}
+
+template <class U, class T, class A, std::enable_if_t<!detail::is_boxed_optional_v<U> && !detail::is_optional_v<U> && !std::is_same_v<U, nullopt_t>, bool> = false>
+auto operator>=(const U& lhs, const BoxedOptional<T, A>& rhs) -> decltype(lhs >= rhs.get()) {
+	return lhs >= rhs.get();
+}
+
+// Against inline Optionals.
+template <class T1, class A, class T2>
+auto operator==(const BoxedOptional<T1, A>& lhs, const Optional<T2>& rhs) -> decltype(lhs.get() == rhs) {
+	return lhs.get() == rhs;
+}
+
+template <class T1, class T2, class A>
+auto operator==(const Optional<T1>& lhs, const BoxedOptional<T2, A>& rhs) -> decltype(lhs == rhs.get()) {
+	return lhs == rhs.get();
+}
+
+template <class T1, class A, class T2>
+auto operator!=(const BoxedOptional<T1, A>& lhs, const Optional<T2>& rhs) -> decltype(lhs.get() != rhs) {
+	return lhs.get() != rhs;
+}
+
+template <class T1, class T2, class A>
+auto operator!=(const Optional<T1>& lhs, const BoxedOptional<T2, A>& rhs) -> decltype(lhs != rhs.get()) {
+	return lhs != rhs.get();
+}
+
+template <class T1, class A, class T2>
+auto operator<(const BoxedOptional<T1, A>& lhs, const Optional<T2>& rhs) -> decltype(lhs.get() < rhs) {
+	return lhs.get() < rhs;
+}
+
+template <class T1, class T2, class A>
+auto operator<(const Optional<T1>& lhs, const BoxedOptional<T2, A>& rhs) -> decltype(lhs < rhs.get()) {
+	return lhs < rhs.get();
+}
+
+template <class T1, class A, class T2>
+auto operator<=(const BoxedOptional<T1, A>& lhs, const Optional<T2>& rhs) -> decltype(lhs.get() <= rhs) {
+	return lhs.get() <= rhs;
+}
+
+template <class T1, class T2, class A>
+auto operator<=(const Optional<T1>& lhs, const BoxedOptional<T2, A>& rhs) -> decltype(lhs <= rhs.get()) {
+	return lhs <= rhs.get();
+}
+
+template <class T1, class A, class T2>
+auto operator>(const BoxedOptional<T1, A>& lhs, const Optional<T2>& rhs) -> decltype(lhs.get() > rhs) {
+	return lhs.get() > rhs;
+}
+
+template <class T1, class T2, class A>
+auto operator>(const Optional<T1>& lhs, const BoxedOptional<T2, A>& rhs) -> decltype(lhs > rhs.get()) {
+	return lhs > rhs.get();
+}
+
+template <class T1, class A, class T2>
+auto operator>=(const BoxedOptional<T1, A>& lhs, const Optional<T2>& rhs) -> decltype(lhs.get() >= rhs) {
+	return lhs.get() >= rhs;
+}
+
+template <class T1, class T2, class A>
+auto operator>=(const Optional<T1>& lhs, const BoxedOptional<T2, A>& rhs) -> decltype(lhs >= rhs.get()) {
+	return lhs >= rhs.get();
+}
+
+template <class T, class A>
+void swap(BoxedOptional<T, A>& lhs, BoxedOptional<T, A>& rhs) noexcept {
+	lhs.swap(rhs);
+}
+
+namespace hash_detail {
+
+template <
+	class T,
+	bool = std::is_default_constructible_v<std::hash<std::remove_const_t<T>>>
+>
+struct BoxedOptionalHashBase;
+
+// Hashes like Optional<T>.
+template <class T>
+struct BoxedOptionalHashBase<T, true> {
+	template <class A>
+	std::size_t operator()(const tim::optional::BoxedOptional<T, A>& v) const
+		noexcept(noexcept(std::hash<std::remove_const_t<T>>{}(std::declval<const T&>())))
+	{
+		return v ? std::hash<std::remove_const_t<T>>{}(*v) : 0;
+	}
+};
+
+template <class T>
+struct BoxedOptionalHashBase<T, false> {
+	BoxedOptionalHashBase() = delete;
+	BoxedOptionalHashBase(const BoxedOptionalHashBase&) = delete;
+	BoxedOptionalHashBase& operator=(const BoxedOptionalHashBase&) = delete;
+
+	template <class A>
+	std::size_t operator()(const tim::optional::BoxedOptional<T, A>& v) const = delete;
+};
+
+} /* namespace hash_detail */
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+namespace std {
+
+template <class T, class Allocator>
+struct hash<tim::optional::BoxedOptional<T, Allocator>>: private ::tim::optional::hash_detail::BoxedOptionalHashBase<T> {
+	using ::tim::optional::hash_detail::BoxedOptionalHashBase<T>::operator();
+};
+
+} /* namespace std */
+
+#endif /* TIM_OPTIONAL_BOXEDOPTIONAL_HPP */
@@ -0,0 +1,247 @@
+#ifndef TIM_OPTIONAL_CONCURRENTOPTIONALARRAY_HPP
+#define TIM_OPTIONAL_CONCURRENTOPTIONALARRAY_HPP
+
+#include "tim/optional/Optional.hpp"
+#include "tim/optional/detail/BitOps.hpp"
+#include "tim/optional/detail/Futex.hpp"
+#include <type_traits>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace tim {
+
+inline namespace optional {
+
+namespace detail {
+
+// A slot's 'state' moves from empty to writing (claimed by one emplacer) to
+// full, or back to empty if the emplacing constructor throws.
+template <class T>
+struct ConcurrentOptionalSlot {
+	using wrapper_type = ValueWrapper<T>;
+
+	enum : std::uint8_t {
+		empty = 0,
+		writing = 1,
+		full = 2
+	};
+
+	ConcurrentOptionalSlot() noexcept:
+		storage(empty_tag)
+	{
+
+	}
+
+	T& value() noexcept {
+		return std::launder(std::addressof(storage.storage_.value))->value();
+	}
+
+	const T& value() const noexcept {
+		return std::launder(std::addressof(storage.storage_.value))->value();
+	}
+
+	template <class ... Args>
+	void construct(Args&& ... args) {
+		::new (static_cast<void*>(std::addressof(storage.storage_.value)))
+			wrapper_type(tim::in_place, std::forward<Args>(args)...);
+	}
+
+	void destroy() noexcept {
+		if constexpr(!std::is_trivially_destructible_v<T>) {
+			std::destroy_at(std::addressof(storage.storage_.value));
+		}
+	}
+
+	std::atomic<std::uint8_t> state{empty};
+	OptionalUnion<T> storage;
+};
+
+} /* namespace detail */
+
+/*
+ * A fixed number of optional 'T's that many threads fill concurrently, each
+ * slot at most once, while a consumer watches for completion.
+ *
+ * 'try_emplace(i, args...)' claims slot 'i' with one compare-exchange,
+ * constructs the value in place and then publishes it both in the slot's state
+ * and in a completion bitmap (bit 'i % 64' of word 'i / 64', as in the other
+ * bitmap-backed containers).  'poll_filled()' counts the bitmap with popcount
+ * and 'wait_all()' sleeps until every slot is full.  All storage is allocated
+ * once, up front.
+ */
+template <class T>
+class ConcurrentOptionalArray {
+	static_assert(std::is_object_v<T> && !std::is_array_v<T>,
+		"ConcurrentOptionalArray<T> requires a non-array object type.");
+	static_assert(std::is_nothrow_destructible_v<T>,
+		"ConcurrentOptionalArray<T> requires a nothrow destructible T.");
+
+	using slot_type = detail::ConcurrentOptionalSlot<T>;
+	using word_type = std::atomic<std::uint64_t>;
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+
+	explicit ConcurrentOptionalArray(size_type count):
+		count_(count),
+		slots_(new slot_type[count]),
+		filled_(new word_type[detail::bitmap_word_count(count)]()),
+		remaining_(count),
+		complete_(count == 0 ? 1u : 0u)
+	{
+
+	}
+
+	ConcurrentOptionalArray(const ConcurrentOptionalArray&) = delete;
+	ConcurrentOptionalArray& operator=(const ConcurrentOptionalArray&) = delete;
+
+	~ConcurrentOptionalArray() {
+		if constexpr(!std::is_trivially_destructible_v<T>) {
+			for_each_filled([this](size_type i, T&) { slots_[i].destroy(); });
+		}
+	}
+
+	size_type size() const noexcept {
+		return count_;
+	}
+
+	/*
+	 * Constructs slot 'pos' from 'args...'.  Returns false, constructing
+	 * nothing, if another call has already claimed the slot.  If the
+	 * constructor throws, the slot is released for another attempt.
+	 */
+	template <
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, Args&&...>,
+			bool
+		> = false
+	>
+	bool try_emplace(size_type pos, Args&& ... args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>) {
+		assert(pos < count_);
+		slot_type& slot = slots_[pos];
+		std::uint8_t state = slot_type::empty;
+		if(!slot.state.compare_exchange_strong(state, slot_type::writing, std::memory_order_relaxed)) {
+			return false;
+		}
+		{
+			auto guard = detail::make_manual_scope_guard([&]() {
+				slot.state.store(slot_type::empty, std::memory_order_relaxed);
+			});
+			slot.construct(std::forward<Args>(args)...);
+			guard.active = false;
+		}
+		slot.state.store(slot_type::full, std::memory_order_release);
+		filled_[detail::bitmap_word_index(pos)].fetch_or(detail::bitmap_bit_mask(pos), std::memory_order_release);
+		if(remaining_.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+			complete_.store(1u, std::memory_order_release);
+			detail::futex_wake_all(complete_);
+		}
+		return true;
+	}
+
+	bool has_value(size_type pos) const noexcept {
+		assert(pos < count_);
+		return slots_[pos].state.load(std::memory_order_acquire) == slot_type::full;
+	}
+
+	Optional<T&> operator[](size_type pos) noexcept {
+		if(has_value(pos)) {
+			return Optional<T&>(slots_[pos].value());
+		}
+		return nullopt;
+	}
+
+	Optional<const T&> operator[](size_type pos) const noexcept {
+		if(has_value(pos)) {
+			return Optional<const T&>(slots_[pos].value());
+		}
+		return nullopt;
+	}
+
+	// Word 'w' of the completion bitmap.  A set bit's value is safe to read.
+	std::uint64_t filled_word(size_type w) const noexcept {
+		assert(w < detail::bitmap_word_count(count_));
+		return filled_[w].load(std::memory_order_acquire);
+	}
+
+	// The number of full slots, counted from the completion bitmap.
+	size_type poll_filled() const noexcept {
+		size_type n = 0;
+		const size_type words = detail::bitmap_word_count(count_);
+		for(size_type w = 0; w < words; ++w) {
+			n += static_cast<size_type>(detail::popcount(filled_word(w)));
+		}
+		return n;
+	}
+
+	bool all_filled() const noexcept {
+		return complete_.load(std::memory_order_acquire) != 0u;
+	}
+
+	// Blocks until every slot is full: spins briefly where that can help,
+	// yields a few times, then sleeps until the last slot is filled.
+	void wait_all() const noexcept {
+		const int spins = detail::spinning_helps() ? spin_limit : 0;
+		for(int round = 0; !all_filled(); ++round) {
+			if(round < spins) {
+				detail::cpu_relax();
+			} else if(round < spins + yield_limit) {
+				std::this_thread::yield();
+			} else {
+				detail::futex_wait(complete_, 0u);
+			}
+		}
+	}
+
+	/*
+	 * Calls 'f(i, value)' for each slot that the completion bitmap shows as
+	 * full, in index order.  Slots filled during the scan may or may not be
+	 * visited.
+	 */
+	template <class F>
+	void for_each_filled(F&& f) {
+		for_each_filled_impl(*this, f);
+	}
+
+	template <class F>
+	void for_each_filled(F&& f) const {
+		for_each_filled_impl(*this, f);
+	}
+
+private:
+	static constexpr int spin_limit = 128;
+	static constexpr int yield_limit = 4;
+
+	template <class Self, class F>
+	static void for_each_filled_impl(Self& self, F& f) {
+		using slot_ref = std::conditional_t<std::is_const_v<Self>, const slot_type&, slot_type&>;
+		const size_type words = detail::bitmap_word_count(self.count_);
+		for(size_type w = 0; w < words; ++w) {
+			for(std::uint64_t m = self.filled_word(w); m; m &= m - 1u) {
+				const size_type i = w * detail::bitmap_word_bits + static_cast<size_type>(detail::countr_zero(m));
+				slot_ref slot = self.slots_[i];
+				f(i, slot.value());
+			}
+		}
+	}
+
+	const size_type count_;
+	std::unique_ptr<slot_type[]> slots_;
+	std::unique_ptr<word_type[]> filled_;
+	std::atomic<size_type> remaining_;
+	std::atomic<std::uint32_t> complete_;
+};
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_CONCURRENTOPTIONALARRAY_HPP */
@@ -0,0 +1,223 @@
+#ifndef TIM_OPTIONAL_MPMCQUEUE_HPP
+#define TIM_OPTIONAL_MPMCQUEUE_HPP
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+#include <cstddef>
+
+namespace tim {
+
+inline namespace optional {
+
+namespace detail {
+
+// One ring slot, alone on its cache line(s).  'sequence' says whose turn it
+// is: equal to a position, the slot is free for the producer of that
+// position; one past it, it holds the value for that position's consumer.
+template <class T>
+struct alignas(64) MPMCQueueSlot {
+	using wrapper_type = ValueWrapper<T>;
+
+	MPMCQueueSlot() noexcept:
+		storage(empty_tag)
+	{
+
+	}
+
+	T& value() noexcept {
+		return std::launder(std::addressof(storage.storage_.value))->value();
+	}
+
+	template <class ... Args>
+	void construct(Args&& ... args) noexcept {
+		::new (static_cast<void*>(std::addressof(storage.storage_.value)))
+			wrapper_type(tim::in_place, std::forward<Args>(args)...);
+	}
+
+	void destroy() noexcept {
+		if constexpr(!std::is_trivially_destructible_v<T>) {
+			std::destroy_at(std::addressof(storage.storage_.value));
+		}
+	}
+
+	std::atomic<std::size_t> sequence{0};
+	OptionalUnion<T> storage;
+};
+
+} /* namespace detail */
+
+/*
+ * A bounded lock-free multi-producer, multi-consumer FIFO queue (Dmitry
+ * Vyukov's ring of sequence-numbered slots).  Producers and consumers each
+ * claim a position with one compare-exchange and then touch only that slot.
+ *
+ * 'try_pop()' moves the value out of its slot straight into the returned
+ * Optional<T>; no 'T' is default-constructed or move-assigned on the way.
+ * The move out of the slot and into it must not throw.
+ */
+template <class T>
+class MPMCQueue {
+	static_assert(std::is_same_v<std::remove_cv_t<T>, T> && std::is_object_v<T> && !std::is_array_v<T>,
+		"MPMCQueue<T> requires a cv-unqualified, non-array object type.");
+	static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>,
+		"MPMCQueue<T> requires a nothrow move constructible and destructible T.");
+
+	using slot_type = detail::MPMCQueueSlot<T>;
+
+public:
+	using value_type = T;
+
+	// 'capacity' is rounded up to a power of two, and to at least 2.
+	explicit MPMCQueue(std::size_t capacity):
+		mask_(round_capacity(capacity) - 1u),
+		slots_(new slot_type[mask_ + 1u])
+	{
+		for(std::size_t i = 0; i <= mask_; ++i) {
+			slots_[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	MPMCQueue(const MPMCQueue&) = delete;
+	MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+	~MPMCQueue() {
+		std::size_t last = push_position_.load(std::memory_order_relaxed);
+		for(std::size_t pos = pop_position_.load(std::memory_order_relaxed); pos != last; ++pos) {
+			slots_[pos & mask_].destroy();
+		}
+	}
+
+	std::size_t capacity() const noexcept {
+		return mask_ + 1u;
+	}
+
+	bool try_push(const T& value) noexcept(std::is_nothrow_copy_constructible_v<T>) {
+		return try_emplace(value);
+	}
+
+	bool try_push(T&& value) noexcept {
+		return try_emplace(std::move(value));
+	}
+
+	/*
+	 * Constructs a 'T' from 'args...' at the back of the queue.  Returns false,
+	 * constructing nothing, if the queue is full.  A 'T' whose constructor may
+	 * throw is built before a slot is claimed and then moved in.
+	 */
+	template <
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, Args&&...>,
+			bool
+		> = false
+	>
+	bool try_emplace(Args&& ... args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>) {
+		if constexpr(std::is_nothrow_constructible_v<T, Args&&...>) {
+			std::size_t pos;
+			slot_type* slot = claim_push(pos);
+			if(!slot) {
+				return false;
+			}
+			slot->construct(std::forward<Args>(args)...);
+			slot->sequence.store(pos + 1u, std::memory_order_release);
+			return true;
+		} else {
+			T value(std::forward<Args>(args)...);
+			return try_emplace(std::move(value));
+		}
+	}
+
+	// Removes the front value, if there is one.
+	Optional<T> try_pop() noexcept {
+		std::size_t pos;
+		slot_type* slot = claim_pop(pos);
+		if(!slot) {
+			return nullopt;
+		}
+		// Runs after the result has been constructed from the slot.
+		auto release = detail::make_manual_scope_guard([&]() { release_pop(slot, pos); });
+		return Optional<T>(tim::in_place, std::move(slot->value()));
+	}
+
+	// As 'try_pop()', but emplaces into 'out'.  Returns false, leaving 'out'
+	// unchanged, if the queue is empty.
+	bool try_pop_into(Optional<T>& out) noexcept {
+		std::size_t pos;
+		slot_type* slot = claim_pop(pos);
+		if(!slot) {
+			return false;
+		}
+		out.emplace(std::move(slot->value()));
+		release_pop(slot, pos);
+		return true;
+	}
+
+private:
+	static std::size_t round_capacity(std::size_t capacity) noexcept {
+		std::size_t n = 2;
+		while(n < capacity) {
+			n *= 2u;
+		}
+		return n;
+	}
+
+	// Claims the next push position, or returns null if the queue is full.
+	slot_type* claim_push(std::size_t& pos) noexcept {
+		pos = push_position_.load(std::memory_order_relaxed);
+		for(;;) {
+			slot_type* slot = std::addressof(slots_[pos & mask_]);
+			std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+			if(diff == 0) {
+				if(push_position_.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+					return slot;
+				}
+			} else if(diff < 0) {
+				return nullptr;
+			} else {
+				pos = push_position_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Claims the next pop position, or returns null if the queue is empty.
+	slot_type* claim_pop(std::size_t& pos) noexcept {
+		pos = pop_position_.load(std::memory_order_relaxed);
+		for(;;) {
+			slot_type* slot = std::addressof(slots_[pos & mask_]);
+			std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1u));
+			if(diff == 0) {
+				if(pop_position_.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+					return slot;
+				}
+			} else if(diff < 0) {
+				return nullptr;
+			} else {
+				pos = pop_position_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Destroys the moved-from value and hands the slot to the producer of the
+	// next lap.
+	void release_pop(slot_type* slot, std::size_t pos) noexcept {
+		slot->destroy();
+		slot->sequence.store(pos + mask_ + 1u, std::memory_order_release);
+	}
+
+	const std::size_t mask_;
+	std::unique_ptr<slot_type[]> slots_;
+	alignas(64) std::atomic<std::size_t> push_position_{0};
+	alignas(64) std::atomic<std::size_t> pop_position_{0};
+};
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_MPMCQUEUE_HPP */
@@ -0,0 +1,155 @@
+#ifndef TIM_OPTIONAL_ONCEOPTIONAL_HPP
+#define TIM_OPTIONAL_ONCEOPTIONAL_HPP
+
+#include "tim/optional/Optional.hpp"
+#include "tim/optional/detail/Futex.hpp"
+#include <type_traits>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <thread>
+#include <cstdint>
+
+namespace tim {
+
+inline namespace optional {
+
+/*
+ * An Optional<T> that is filled at most once, by whichever thread first calls
+ * 'get_or_init(f)'.  Once filled, 'get_or_init()' and 'get()' cost a single
+ * acquire load.  Threads that arrive while 'f' runs spin briefly (on machines
+ * where 'f' can run meanwhile), yield a few times, and then sleep on the state
+ * word until it finishes; nothing is allocated.
+ *
+ * If 'f' throws, the OnceOptional stays empty and the exception propagates to
+ * the caller.  One of the waiting threads (or the next caller) then runs its
+ * own 'f'.
+ */
+template <class T>
+class OnceOptional {
+	static_assert(std::is_object_v<T> && !std::is_array_v<T>,
+		"OnceOptional<T> requires a non-array object type.");
+
+public:
+	using value_type = T;
+
+	constexpr OnceOptional() noexcept:
+		empty_()
+	{
+
+	}
+
+	OnceOptional(const OnceOptional&) = delete;
+	OnceOptional& operator=(const OnceOptional&) = delete;
+
+	~OnceOptional() {
+		if(state_.load(std::memory_order_acquire) == ready) {
+			std::destroy_at(std::addressof(value_));
+		}
+	}
+
+	/*
+	 * Returns the value, first initializing it from 'std::invoke(f)' if no
+	 * thread has yet done so.  A 'T' returned by value is constructed in place.
+	 */
+	template <class F>
+	T& get_or_init(F&& f) {
+		if(state_.load(std::memory_order_acquire) == ready) {
+			return value_;
+		}
+		return init_slow(std::forward<F>(f));
+	}
+
+	Optional<T&> get() noexcept {
+		if(state_.load(std::memory_order_acquire) == ready) {
+			return Optional<T&>(value_);
+		}
+		return nullopt;
+	}
+
+	Optional<const T&> get() const noexcept {
+		if(state_.load(std::memory_order_acquire) == ready) {
+			return Optional<const T&>(value_);
+		}
+		return nullopt;
+	}
+
+	bool has_value() const noexcept {
+		return state_.load(std::memory_order_acquire) == ready;
+	}
+
+private:
+	enum : std::uint32_t {
+		empty = 0,
+		running = 1,
+		// 'running', and at least one thread is (or is about to be) asleep.
+		running_with_waiters = 2,
+		ready = 3
+	};
+
+	// As in WaitableOptional: spinning only helps when the initializer can run
+	// on another hardware thread.
+	static constexpr int spin_limit = 128;
+	static constexpr int yield_limit = 4;
+
+	template <class F>
+	T& init_slow(F&& f) {
+		const int spin_rounds = detail::spinning_helps() ? spin_limit : 0;
+		int rounds = 0;
+		for(;;) {
+			std::uint32_t state = state_.load(std::memory_order_acquire);
+			if(state == ready) {
+				return value_;
+			}
+			if(state == empty) {
+				if(state_.compare_exchange_weak(state, running, std::memory_order_acquire, std::memory_order_acquire)) {
+					return run(std::forward<F>(f));
+				}
+				continue;
+			}
+			if(rounds < spin_rounds + yield_limit) {
+				if(rounds++ < spin_rounds) {
+					detail::cpu_relax();
+				} else {
+					std::this_thread::yield();
+				}
+				continue;
+			}
+			if(state == running && !state_.compare_exchange_weak(
+				state, running_with_waiters, std::memory_order_acquire, std::memory_order_acquire
+			)) {
+				continue;
+			}
+			detail::futex_wait(state_, running_with_waiters);
+		}
+	}
+
+	template <class F>
+	T& run(F&& f) {
+		// On a throw, hand the job back and wake everyone so that one of the
+		// waiters retries.
+		auto guard = detail::make_manual_scope_guard([this]() {
+			if(state_.exchange(empty, std::memory_order_release) == running_with_waiters) {
+				detail::futex_wake_all(state_);
+			}
+		});
+		::new (static_cast<void*>(std::addressof(value_))) T(detail::invoke(std::forward<F>(f)));
+		guard.active = false;
+		if(state_.exchange(ready, std::memory_order_release) == running_with_waiters) {
+			detail::futex_wake_all(state_);
+		}
+		return value_;
+	}
+
+	std::atomic<std::uint32_t> state_{empty};
+	union {
+		detail::EmptyAlternative empty_;
+		T value_;
+	};
+};
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_ONCEOPTIONAL_HPP */
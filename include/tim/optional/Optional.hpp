@@ -2,8 +2,41 @@
 #define TIM_OPTIONAL_OPTIONAL_HPP
 
 #include <type_traits>
+#include <initializer_list>
+#include <utility>
+#include <functional>
 #include <memory>
 #include <exception>
+#include <cstring>
+#include <cstddef>
+
+#if defined(__has_cpp_attribute) && !defined(TIM_OPTIONAL_NO_UNIQUE_ADDRESS)
+# if __has_cpp_attribute(no_unique_address)
+#  define TIM_OPTIONAL_NO_UNIQUE_ADDRESS [[no_unique_address]]
+# endif
+#endif
+
+#ifndef TIM_OPTIONAL_NO_UNIQUE_ADDRESS
+# define TIM_OPTIONAL_NO_UNIQUE_ADDRESS
+#endif
+
+/*
+ * Define TIM_OPTIONAL_ENABLE_TRIVIAL_ABI to mark Optional's storage layers
+ * 'clang::trivial_abi'.  Optional<T> is then passed and returned in registers
+ * whenever 'T' is.  This is an ABI change (and by-value parameters are
+ * destroyed by the callee), hence opt-in.
+ */
+#if defined(TIM_OPTIONAL_ENABLE_TRIVIAL_ABI) && defined(__has_cpp_attribute)
+# if __has_cpp_attribute(clang::trivial_abi)
+#  define TIM_OPTIONAL_TRIVIAL_ABI [[clang::trivial_abi]]
+#  define TIM_OPTIONAL_HAS_TRIVIAL_ABI 1
+# endif
+#endif
+
+#ifndef TIM_OPTIONAL_TRIVIAL_ABI
+# define TIM_OPTIONAL_TRIVIAL_ABI
+# define TIM_OPTIONAL_HAS_TRIVIAL_ABI 0
+#endif
 
 namespace tim {
 
@@ -27,6 +60,18 @@ inline constexpr empty_tag_t empty_tag = empty_tag_t{};
 
 struct nullopt_constructor_t {};
 
+// 'std::invoke()' is not constexpr until C++20.
+template <class F, class ... Args>
+constexpr std::invoke_result_t<F, Args...> invoke(F&& f, Args&& ... args)
+	noexcept(std::is_nothrow_invocable_v<F, Args...>)
+{
+	if constexpr(std::is_member_pointer_v<std::decay_t<F>>) {
+		return std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+	} else {
+		return std::forward<F>(f)(std::forward<Args>(args)...);
+	}
+}
+
 } /* namespace detail */
 
 struct nullopt_t {
@@ -34,6 +79,96 @@ struct nullopt_t {
 };
 inline constexpr nullopt_t nullopt = nullopt_t{{}};
 
+// 'Optional<T>(from_invoke, f, args...)' initializes the payload directly from
+// the result of 'std::invoke(f, args...)', so a 'T' returned by value is never
+// moved.
+struct from_invoke_t {
+	explicit from_invoke_t() = default;
+};
+inline constexpr from_invoke_t from_invoke{};
+
+// 'opt.reset(defer_to(r))' empties 'opt' by handing its payload to 'r' rather
+// than destroying it inline.  'r.retire(p)' must take over '*p', ending its
+// lifetime at that address, without throwing; see Reclaimer.hpp.
+template <class R>
+struct defer_to_t {
+	R& reclaimer;
+};
+
+template <class R>
+constexpr defer_to_t<R> defer_to(R& reclaimer) noexcept {
+	return defer_to_t<R>{reclaimer};
+}
+
+namespace detail {
+
+/*
+ * Whether a 'T' payload is stored as a potentially-overlapping subobject: an
+ * empty 'T', or one whose tail padding holds the presence flag.  Guaranteed
+ * elision does not reach such subobjects, so 'from_invoke' moves into them.
+ */
+template <class T, bool = std::is_class_v<T>>
+struct payload_overlaps: std::false_type {};
+
+template <class T>
+struct payload_overlaps<T, true> {
+	struct probe {
+		TIM_OPTIONAL_NO_UNIQUE_ADDRESS T value;
+		char c;
+	};
+	static constexpr bool value = std::is_empty_v<T> || sizeof(probe) == sizeof(T);
+};
+
+// Otherwise a prvalue 'T' initializes the payload by elision, and so needs no
+// (nothrow) move constructor.
+template <class T, class R>
+inline constexpr bool is_elided_result_v = !payload_overlaps<T>::value
+	&& !std::is_reference_v<R>
+	&& std::is_same_v<std::remove_cv_t<T>, std::remove_cv_t<R>>;
+
+template <class T, class F, class ... Args>
+constexpr bool is_constructible_from_invoke() {
+	if constexpr(std::is_invocable_v<F, Args...>) {
+		using result_type = std::invoke_result_t<F, Args...>;
+		return is_elided_result_v<T, result_type> || std::is_constructible_v<T, result_type>;
+	} else {
+		return false;
+	}
+}
+
+template <class T, class F, class ... Args>
+constexpr bool is_nothrow_constructible_from_invoke() {
+	if constexpr(std::is_nothrow_invocable_v<F, Args...>) {
+		using result_type = std::invoke_result_t<F, Args...>;
+		return is_elided_result_v<T, result_type> || std::is_nothrow_constructible_v<T, result_type>;
+	} else {
+		return false;
+	}
+}
+
+// The storage layers' 'emplace(args...)' also accepts 'from_invoke_t{}, f, args...'.
+template <class T, class ... Args>
+struct is_emplaceable: std::is_constructible<T, Args...> {};
+
+template <class T, class F, class ... Args>
+struct is_emplaceable<T, from_invoke_t&&, F, Args...>:
+	std::bool_constant<is_constructible_from_invoke<T, F, Args...>()>
+{
+
+};
+
+template <class T, class ... Args>
+struct is_nothrow_emplaceable: std::is_nothrow_constructible<T, Args...> {};
+
+template <class T, class F, class ... Args>
+struct is_nothrow_emplaceable<T, from_invoke_t&&, F, Args...>:
+	std::bool_constant<is_nothrow_constructible_from_invoke<T, F, Args...>()>
+{
+
+};
+
+} /* namespace detail */
+
 class BadOptionalAccess: public std::exception {
 public:
 	BadOptionalAccess() noexcept = default;
@@ -43,6 +178,128 @@ public:
 	}
 };
 
+/*
+ * Customization point for storing the empty state of an Optional<T> inside
+ * an otherwise-invalid value of 'T', so that sizeof(Optional<T>) == sizeof(T).
+ * Specializations must provide:
+ *
+ *     static constexpr T empty_value() noexcept;
+ *     static constexpr bool is_empty(const T& value) noexcept;
+ *
+ * 'is_empty()' must hold for 'empty_value()' and for no value that an engaged
+ * Optional<T> is expected to contain.  The niche is only used when 'T' is
+ * trivially copyable; otherwise the specialization is ignored.
+ */
+template <class T>
+struct optional_niche_traits {};
+
+namespace detail {
+
+template <class T, bool = std::is_scalar_v<T> || std::is_void_v<T>>
+struct PointerNicheTraits {};
+
+template <class T>
+struct PointerNicheTraits<T, true> {
+private:
+	// A private object whose address no user pointer can compare equal to.
+	static inline std::conditional_t<std::is_void_v<T>, char, std::remove_cv_t<T>> anchor_{};
+public:
+	static constexpr T* empty_value() noexcept { return &anchor_; }
+	static constexpr bool is_empty(T* const& value) noexcept { return value == &anchor_; }
+};
+
+} /* namespace detail */
+
+template <class T>
+struct optional_niche_traits<T*>:
+	detail::PointerNicheTraits<T>
+{
+};
+
+/*
+ * Whether relocating a 'T' (move-constructing a new object from it and then
+ * destroying it) is equivalent to copying its bytes.  Defaults to
+ * 'std::is_trivially_copyable' (plus 'trivial_abi' types, when enabled);
+ * specialize it to opt other types in.
+ */
+template <class T>
+struct is_trivially_relocatable: std::bool_constant<
+	std::is_trivially_copyable_v<T>
+#if TIM_OPTIONAL_HAS_TRIVIAL_ABI && defined(__has_builtin)
+# if __has_builtin(__is_trivially_relocatable)
+	|| __is_trivially_relocatable(T)
+# endif
+#endif
+> {};
+
+template <class T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+template <class T, class D>
+struct is_trivially_relocatable<std::unique_ptr<T, D>>:
+	std::conjunction<
+		is_trivially_relocatable<D>,
+		is_trivially_relocatable<typename std::unique_ptr<T, D>::pointer>
+	>
+{
+};
+
+template <class T>
+struct is_trivially_relocatable<std::shared_ptr<T>>: std::true_type {};
+
+template <class T>
+struct is_trivially_relocatable<std::weak_ptr<T>>: std::true_type {};
+
+template <class T>
+struct is_trivially_relocatable<Optional<T>>:
+	std::disjunction<
+		std::is_trivially_copyable<Optional<T>>,
+		is_trivially_relocatable<T>
+	>
+{
+};
+
+/*
+ * Relocates '*src' into the uninitialized storage at 'dest', ending the
+ * lifetime of '*src'.  'dest' must not be a potentially-overlapping subobject.
+ */
+template <class T>
+T* relocate_at(T* src, T* dest)
+	noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>)
+{
+	if constexpr(is_trivially_relocatable_v<T>) {
+		std::memcpy(static_cast<void*>(dest), static_cast<const void*>(src), sizeof(T));
+		return std::launder(dest);
+	} else {
+		T* result = ::new (static_cast<void*>(dest)) T(std::move(*src));
+		std::destroy_at(src);
+		return result;
+	}
+}
+
+/*
+ * Relocates [first, last) into the uninitialized storage at 'd_first'.  The
+ * ranges must not overlap.  For trivially relocatable types this is a single
+ * 'memcpy()'; otherwise the elements are moved and then destroyed, leaving the
+ * source untouched if a move constructor throws.
+ */
+template <class T>
+T* uninitialized_relocate(T* first, T* last, T* d_first)
+	noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>)
+{
+	if constexpr(is_trivially_relocatable_v<T>) {
+		const std::size_t count = static_cast<std::size_t>(last - first);
+		if(count > 0) {
+			std::memcpy(static_cast<void*>(d_first), static_cast<const void*>(first), count * sizeof(T));
+		}
+		return d_first + count;
+	} else {
+		T* d_last = std::uninitialized_move(first, last, d_first);
+		std::destroy(first, last);
+		return d_last;
+	}
+}
+
 namespace detail {
 
 template <class T>
@@ -60,6 +317,24 @@ struct is_optional<Optional<T>>: std::true_type {};
 template <class T>
 inline constexpr bool is_cv_void_v = is_cv_void<T>::value;
 
+template <class T, class = void>
+struct has_optional_niche: std::false_type {};
+
+template <class T>
+struct has_optional_niche<
+	T,
+	std::void_t<
+		decltype(optional_niche_traits<T>::empty_value()),
+		decltype(optional_niche_traits<T>::is_empty(std::declval<const T&>()))
+	>
+>:
+	std::is_trivially_copyable<T>
+{
+};
+
+template <class T>
+inline constexpr bool has_optional_niche_v = has_optional_niche<T>::value;
+
 template <class T>
 struct ManualScopeGuard {
 
@@ -101,8 +376,52 @@ template <
 >
 struct ValueWrapper;
 
+// Holds a 'T' member that may share its tail padding only when that padding
+// is worth having; see 'payload_overlaps'.
+template <class T, bool = payload_overlaps<T>::value>
+struct PayloadMember {
+	PayloadMember() = default;
+
+	template <class ... Args>
+	constexpr PayloadMember(tim::in_place_t, Args&& ... args):
+		value_(std::forward<Args>(args)...)
+	{
+
+	}
+
+	template <class F, class ... Args>
+	constexpr PayloadMember(from_invoke_t, F&& f, Args&& ... args):
+		value_(detail::invoke(std::forward<F>(f), std::forward<Args>(args)...))
+	{
+
+	}
+
+	TIM_OPTIONAL_NO_UNIQUE_ADDRESS T value_;
+};
+
 template <class T>
-struct ValueWrapper<T, false> {
+struct PayloadMember<T, false> {
+	PayloadMember() = default;
+
+	template <class ... Args>
+	constexpr PayloadMember(tim::in_place_t, Args&& ... args):
+		value_(std::forward<Args>(args)...)
+	{
+
+	}
+
+	template <class F, class ... Args>
+	constexpr PayloadMember(from_invoke_t, F&& f, Args&& ... args):
+		value_(detail::invoke(std::forward<F>(f), std::forward<Args>(args)...))
+	{
+
+	}
+
+	T value_;
+};
+
+template <class T>
+struct ValueWrapper<T, false>: private PayloadMember<T> {
 	using value_type = T;
 
 	ValueWrapper() = default;
@@ -127,7 +446,7 @@ struct ValueWrapper<T, false> {
 		> = false
 	>
 	constexpr ValueWrapper(tim::in_place_t, Args&& ... args):
-		value_(std::forward<Args>(args)...)
+		PayloadMember<T>(tim::in_place, std::forward<Args>(args)...)
 	{
 
 	}
@@ -141,7 +460,14 @@ struct ValueWrapper<T, false> {
 		> = false
 	>
 	constexpr ValueWrapper(tim::in_place_t, std::initializer_list<U> ilist, Args&& ... args):
-		value_(ilist, std::forward<Args>(args)...)
+		PayloadMember<T>(tim::in_place, ilist, std::forward<Args>(args)...)
+	{
+
+	}
+
+	template <class F, class ... Args>
+	constexpr ValueWrapper(tim::in_place_t, from_invoke_t, F&& f, Args&& ... args):
+		PayloadMember<T>(from_invoke, std::forward<F>(f), std::forward<Args>(args)...)
 	{
 
 	}
@@ -153,9 +479,6 @@ struct ValueWrapper<T, false> {
 	constexpr       value_type&  value()      &  { return this->value_; }
 	constexpr const value_type&& value() const&& { return std::move(this->value_); }
 	constexpr       value_type&& value()      && { return std::move(this->value_); }
-
-private:
-	T value_;
 };
 
 template <class T>
@@ -203,6 +526,13 @@ struct ValueWrapper<T, true>: private T {
 
 	}
 
+	template <class F, class ... Args>
+	constexpr ValueWrapper(tim::in_place_t, from_invoke_t, F&& f, Args&& ... args):
+		value_type(detail::invoke(std::forward<F>(f), std::forward<Args>(args)...))
+	{
+
+	}
+
 	ValueWrapper& operator=(const ValueWrapper&) = default;
 	ValueWrapper& operator=(ValueWrapper&&) = default;
 
@@ -213,6 +543,95 @@ struct ValueWrapper<T, true>: private T {
 
 };
 
+// A named union (rather than an anonymous one) so that, together with
+// 'no_unique_address', the tail padding of 'W' stays reusable by whatever
+// follows the storage.
+template <
+	class W,
+	bool = std::is_trivially_destructible_v<W>,
+	bool = TIM_OPTIONAL_HAS_TRIVIAL_ABI && std::conjunction_v<
+		std::negation<std::is_trivially_destructible<W>>,
+		std::negation<std::is_trivially_copy_constructible<W>>,
+		std::negation<std::is_trivially_move_constructible<W>>,
+		is_trivially_relocatable<typename W::value_type>
+	>
+>
+union OptionalUnionStorage {
+	OptionalUnionStorage() = default;
+
+	constexpr OptionalUnionStorage(detail::empty_tag_t) noexcept:
+		hidden_{}
+	{
+
+	}
+
+	template <class ... Args>
+	constexpr OptionalUnionStorage(in_place_t, Args&& ... args):
+		value(tim::in_place, std::forward<Args>(args)...)
+	{
+
+	}
+
+	EmptyAlternative hidden_;
+	TIM_OPTIONAL_NO_UNIQUE_ADDRESS W value;
+};
+
+template <class W>
+union OptionalUnionStorage<W, false, false> {
+	OptionalUnionStorage() = default;
+
+	constexpr OptionalUnionStorage(detail::empty_tag_t) noexcept:
+		hidden_{}
+	{
+
+	}
+
+	template <class ... Args>
+	constexpr OptionalUnionStorage(in_place_t, Args&& ... args):
+		value(tim::in_place, std::forward<Args>(args)...)
+	{
+
+	}
+
+	~OptionalUnionStorage() {}
+
+	EmptyAlternative hidden_;
+	TIM_OPTIONAL_NO_UNIQUE_ADDRESS W value;
+};
+
+// Variant members with non-trivial copy and move constructors leave the
+// union without any, which makes 'trivial_abi' ill-formed for it and for
+// everything built on top of it.  For relocatable payloads, provide a move
+// constructor that relocates the bytes.  The layers above never call it
+// (engaged state is only ever transferred through 'relocate_from()'); it
+// exists so that the compiler may do the same when passing the Optional.
+template <class W>
+union TIM_OPTIONAL_TRIVIAL_ABI OptionalUnionStorage<W, false, true> {
+	OptionalUnionStorage() = default;
+
+	constexpr OptionalUnionStorage(detail::empty_tag_t) noexcept:
+		hidden_{}
+	{
+
+	}
+
+	template <class ... Args>
+	constexpr OptionalUnionStorage(in_place_t, Args&& ... args):
+		value(tim::in_place, std::forward<Args>(args)...)
+	{
+
+	}
+
+	OptionalUnionStorage(OptionalUnionStorage&& other) noexcept {
+		std::memcpy(static_cast<void*>(this), static_cast<const void*>(std::addressof(other)), sizeof(*this));
+	}
+
+	~OptionalUnionStorage() {}
+
+	EmptyAlternative hidden_;
+	TIM_OPTIONAL_NO_UNIQUE_ADDRESS W value;
+};
+
 template <class T>
 struct OptionalUnionImpl<MemberStatus::Defaulted, T> {
 
@@ -223,22 +642,21 @@ struct OptionalUnionImpl<MemberStatus::Defaulted, T> {
 	constexpr OptionalUnionImpl& operator=(OptionalUnionImpl&&) = default;
 
 	constexpr OptionalUnionImpl(detail::empty_tag_t) noexcept:
-		hidden_{}
+		storage_(detail::empty_tag)
 	{
 	
 	}
 
 	template <class ... Args>
 	constexpr OptionalUnionImpl(in_place_t, Args&& ... args):
-		value(tim::in_place, std::forward<Args>(args)...)
+		storage_(in_place, std::forward<Args>(args)...)
 	{
 		
 	}
 
-	union {
-		EmptyAlternative hidden_;
-		ValueWrapper<std::conditional_t<is_cv_void_v<T>, EmptyAlternative, T>> value;
-	};
+	TIM_OPTIONAL_NO_UNIQUE_ADDRESS OptionalUnionStorage<
+		ValueWrapper<std::conditional_t<is_cv_void_v<T>, EmptyAlternative, T>>
+	> storage_;
 };
 
 template <class T>
@@ -255,26 +673,25 @@ struct OptionalUnionImpl<MemberStatus::Deleted, T> {
 	~OptionalUnionImpl() = delete;	
 
 	constexpr OptionalUnionImpl(detail::empty_tag_t) noexcept:
-		hidden_{}
+		storage_(detail::empty_tag)
 	{
 	
 	}
 
 	template <class ... Args>
 	constexpr OptionalUnionImpl(in_place_t, Args&& ... args):
-		value(tim::in_place, std::forward<Args>(args)...)
+		storage_(in_place, std::forward<Args>(args)...)
 	{
 		
 	}
 
-	union {
-		EmptyAlternative hidden_;
-		ValueWrapper<std::conditional_t<is_cv_void_v<T>, EmptyAlternative, T>> value;
-	};
+	TIM_OPTIONAL_NO_UNIQUE_ADDRESS OptionalUnionStorage<
+		ValueWrapper<std::conditional_t<is_cv_void_v<T>, EmptyAlternative, T>>
+	> storage_;
 };
 
 template <class T>
-struct OptionalUnionImpl<MemberStatus::Defined, T> {
+struct TIM_OPTIONAL_TRIVIAL_ABI OptionalUnionImpl<MemberStatus::Defined, T> {
 
 	constexpr OptionalUnionImpl() = default;
                      
@@ -287,22 +704,21 @@ struct OptionalUnionImpl<MemberStatus::Defined, T> {
 	~OptionalUnionImpl() {}
 
 	constexpr OptionalUnionImpl(detail::empty_tag_t):
-		hidden_{}
+		storage_(detail::empty_tag)
 	{
 	
 	}
 
 	template <class ... Args>
 	constexpr OptionalUnionImpl(in_place_t, Args&& ... args):
-		value(tim::in_place, std::forward<Args>(args)...)
+		storage_(in_place, std::forward<Args>(args)...)
 	{
 		
 	}
 
-	union {
-		EmptyAlternative hidden_;
-		ValueWrapper<std::conditional_t<is_cv_void_v<T>, EmptyAlternative, T>> value;
-	};
+	TIM_OPTIONAL_NO_UNIQUE_ADDRESS OptionalUnionStorage<
+		ValueWrapper<std::conditional_t<is_cv_void_v<T>, EmptyAlternative, T>>
+	> storage_;
 };
 
 template <>
@@ -382,68 +798,112 @@ using OptionalUnion = std::conditional_t<
 	OptionalUnionImpl<MemberStatus::Deleted, T>
 >;
 
-template <class T, bool = detail::is_cv_void_v<T>>
+enum class OptionalLayout {
+	Void,
+	Flag,
+	Niche,
+	Empty
+};
+
+template <class T>
+inline constexpr OptionalLayout optional_layout_v = (
+	detail::is_cv_void_v<T> ? OptionalLayout::Void
+	: detail::has_optional_niche_v<T> ? OptionalLayout::Niche
+	: std::conjunction_v<
+		std::is_same<std::remove_cv_t<T>, T>,
+		std::is_empty<T>,
+		std::is_trivially_copyable<T>,
+		std::is_trivially_default_constructible<T>,
+		std::is_trivially_move_assignable<T>
+	> ? OptionalLayout::Empty
+	: OptionalLayout::Flag
+);
+
+template <class T, OptionalLayout = optional_layout_v<T>>
 struct OptionalBaseMethods;
 
 template <class T>
-struct OptionalBaseMethods<T, false> {
+struct OptionalBaseMethods<T, OptionalLayout::Flag> {
 	using value_type = T;
 
 	constexpr OptionalBaseMethods() = default;
 
 	template <class ... Args>
 	constexpr OptionalBaseMethods(in_place_t, Args&& ... args):
-		has_value_(true),
-		data_(in_place, std::forward<Args>(args)...)
+		data_(in_place, std::forward<Args>(args)...),
+		has_value_(true)
 	{
 		
 	}
 
 	template <class ... Args>
 	constexpr OptionalBaseMethods(detail::empty_tag_t) noexcept:
-		has_value_(false),
-		data_(detail::empty_tag)
+		data_(detail::empty_tag),
+		has_value_(false)
 	{
 
 	}
 
-	constexpr const value_type& value() const { return std::launder(std::addressof(data_.value))->value(); }
-	constexpr       value_type& value()       { return std::launder(std::addressof(data_.value))->value(); }
+	constexpr const value_type& value() const { return std::launder(std::addressof(data_.storage_.value))->value(); }
+	constexpr       value_type& value()       { return std::launder(std::addressof(data_.storage_.value))->value(); }
 
-	constexpr const bool& has_value() const noexcept { return has_value_; }
-	constexpr bool&       has_value()       noexcept { return has_value_; }
+	constexpr bool has_value() const noexcept { return has_value_; }
+	constexpr void set_has_value(bool v) noexcept { has_value_ = v; }
 
 	template <
 		class ... Args,
 		std::enable_if_t<
-			std::is_constructible_v<value_type, Args&&...>,
+			detail::is_emplaceable<value_type, Args&&...>::value,
 			bool
 		> = false
 	>
 	constexpr void emplace(Args&& ... args)
-		noexcept(std::is_nothrow_constructible_v<value_type, Args&&...>)
+		noexcept(detail::is_nothrow_emplaceable<value_type, Args&&...>::value)
 	{
-		new (std::addressof(data_.value)) ValueWrapper<T>(tim::in_place, std::forward<Args>(args)...);
+		new (std::addressof(data_.storage_.value)) ValueWrapper<T>(tim::in_place, std::forward<Args>(args)...);
 	}
 
 	constexpr void destruct() noexcept {
 		if constexpr(!std::is_trivially_destructible_v<T>) {
-			std::destroy_at(std::addressof(data_.value));
+			std::destroy_at(std::addressof(data_.storage_.value));
 		}
 	}
 
+	// Moves the payload of (engaged) 'src' into this (disengaged) storage and
+	// leaves 'src' disengaged, by copying bytes when 'T' allows it.
+	constexpr void relocate_from(OptionalBaseMethods& src)
+		noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>)
+	{
+		if constexpr(std::is_trivially_copyable_v<T>) {
+			data_ = src.data_;
+		} else if constexpr(is_trivially_relocatable_v<T>) {
+			std::memcpy(
+				static_cast<void*>(std::addressof(data_)),
+				static_cast<const void*>(std::addressof(src.data_)),
+				sizeof(data_)
+			);
+		} else {
+			emplace(std::move(src.value()));
+			src.destruct();
+		}
+		// Set last: the copy above may have spanned tail padding holding the flag.
+		has_value_ = true;
+		src.has_value_ = false;
+	}
+
 	[[noreturn]]
 	void throw_bad_optional_access() const noexcept(false) {
 		throw BadOptionalAccess();
 	}
 	
 private:
+	// The flag follows the payload so that it can live in T's tail padding.
+	TIM_OPTIONAL_NO_UNIQUE_ADDRESS OptionalUnion<T> data_;
 	bool has_value_ = false;
-	OptionalUnion<T> data_;
 };
 
 template <class T>
-struct OptionalBaseMethods<T, true> {
+struct OptionalBaseMethods<T, OptionalLayout::Void> {
 
 	constexpr OptionalBaseMethods() = default;
 
@@ -460,19 +920,152 @@ struct OptionalBaseMethods<T, true> {
 
 	}
 
-	constexpr const bool& has_value() const noexcept { return has_value_; }
-	constexpr bool&       has_value()       noexcept { return has_value_; }
+	constexpr bool has_value() const noexcept { return has_value_; }
+	constexpr void set_has_value(bool v) noexcept { has_value_ = v; }
 
 	constexpr void emplace() noexcept {}
 
 	constexpr void destruct() noexcept {}
 
+	constexpr void relocate_from(OptionalBaseMethods& src) noexcept {
+		has_value_ = true;
+		src.has_value_ = false;
+	}
+
+	[[noreturn]]
+	void throw_bad_optional_access() const noexcept(false) {
+		throw BadOptionalAccess();
+	}
+	
+private:
+	bool has_value_ = false;
+};
+
+template <class T>
+struct OptionalBaseMethods<T, OptionalLayout::Niche> {
+	using value_type = T;
+	using niche_traits = optional_niche_traits<T>;
+
+	constexpr OptionalBaseMethods() noexcept:
+		OptionalBaseMethods(detail::empty_tag)
+	{
+
+	}
+
+	template <class ... Args>
+	constexpr OptionalBaseMethods(in_place_t, Args&& ... args):
+		data_(in_place, std::forward<Args>(args)...)
+	{
+		
+	}
+
+	constexpr OptionalBaseMethods(detail::empty_tag_t) noexcept:
+		data_(in_place, niche_traits::empty_value())
+	{
+
+	}
+
+	constexpr const value_type& value() const { return std::launder(std::addressof(data_.storage_.value))->value(); }
+	constexpr       value_type& value()       { return std::launder(std::addressof(data_.storage_.value))->value(); }
+
+	constexpr bool has_value() const noexcept { return !niche_traits::is_empty(value()); }
+
+	constexpr void set_has_value(bool v) noexcept {
+		if(!v) {
+			data_.storage_.value = ValueWrapper<T>(tim::in_place, niche_traits::empty_value());
+		}
+	}
+
+	template <
+		class ... Args,
+		std::enable_if_t<
+			detail::is_emplaceable<value_type, Args&&...>::value,
+			bool
+		> = false
+	>
+	constexpr void emplace(Args&& ... args)
+		noexcept(detail::is_nothrow_emplaceable<value_type, Args&&...>::value)
+	{
+		new (std::addressof(data_.storage_.value)) ValueWrapper<T>(tim::in_place, std::forward<Args>(args)...);
+	}
+
+	constexpr void destruct() noexcept {}
+
+	constexpr void relocate_from(OptionalBaseMethods& src) noexcept {
+		data_ = src.data_;
+		set_has_value(true);
+		src.set_has_value(false);
+	}
+
+	[[noreturn]]
+	void throw_bad_optional_access() const noexcept(false) {
+		throw BadOptionalAccess();
+	}
+	
+private:
+	// The payload is always alive; the empty state is 'niche_traits::empty_value()'.
+	OptionalUnion<T> data_;
+};
+
+template <class T>
+struct OptionalBaseMethods<T, OptionalLayout::Empty> {
+	using value_type = T;
+
+	constexpr OptionalBaseMethods() = default;
+
+	template <class ... Args>
+	constexpr OptionalBaseMethods(in_place_t, Args&& ... args):
+		data_(tim::in_place, std::forward<Args>(args)...),
+		has_value_(true)
+	{
+		
+	}
+
+	constexpr OptionalBaseMethods(detail::empty_tag_t) noexcept:
+		data_(),
+		has_value_(false)
+	{
+
+	}
+
+	constexpr const value_type& value() const { return data_.value(); }
+	constexpr       value_type& value()       { return data_.value(); }
+
+	constexpr bool has_value() const noexcept { return has_value_; }
+	constexpr void set_has_value(bool v) noexcept { has_value_ = v; }
+
+	template <
+		class ... Args,
+		std::enable_if_t<
+			detail::is_emplaceable<value_type, Args&&...>::value,
+			bool
+		> = false
+	>
+	constexpr void emplace(Args&& ... args)
+		noexcept(detail::is_nothrow_emplaceable<value_type, Args&&...>::value)
+	{
+		// Assigning is a no-op for a trivially copyable empty type, but it avoids
+		// placement-new over the flag that 'data_' shares its address with.
+		data_ = ValueWrapper<T>(tim::in_place, std::forward<Args>(args)...);
+	}
+
+	constexpr void destruct() noexcept {}
+
+	constexpr void relocate_from(OptionalBaseMethods& src) noexcept {
+		data_ = src.data_;
+		set_has_value(true);
+		src.set_has_value(false);
+	}
+
 	[[noreturn]]
 	void throw_bad_optional_access() const noexcept(false) {
 		throw BadOptionalAccess();
 	}
 	
 private:
+	// 'T' is stateless and trivial, so it is kept alive even while disengaged
+	// and overlaps the flag, making sizeof(Optional<T>) == 1.
+	TIM_OPTIONAL_NO_UNIQUE_ADDRESS ValueWrapper<T> data_;
 	bool has_value_ = false;
 };
 
@@ -612,9 +1205,11 @@ struct OptionalDestructor<MemberStatus::Defaulted, T>:
 	using base_type = OptionalBaseMethods<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 
 	constexpr OptionalDestructor() = default;
@@ -627,15 +1222,17 @@ struct OptionalDestructor<MemberStatus::Defaulted, T>:
 };
 
 template <class T>
-struct OptionalDestructor<MemberStatus::Defined, T>:
+struct TIM_OPTIONAL_TRIVIAL_ABI OptionalDestructor<MemberStatus::Defined, T>:
 	OptionalBaseMethods<T>
 {
 	using base_type = OptionalBaseMethods<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 	
 	constexpr OptionalDestructor() = default;
@@ -658,9 +1255,11 @@ struct OptionalDefaultConstructor<MemberStatus::Defaulted, T>:
 	using base_type = optional_destructor_type<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 
 	constexpr OptionalDefaultConstructor() = default;
@@ -677,9 +1276,11 @@ struct OptionalDefaultConstructor<MemberStatus::Deleted, T>:
 	using base_type = optional_destructor_type<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 
 	constexpr OptionalDefaultConstructor() = delete;
@@ -696,9 +1297,11 @@ struct OptionalDefaultConstructor<MemberStatus::Defined, T>:
 	using base_type = optional_destructor_type<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 	
 	constexpr OptionalDefaultConstructor() noexcept:
@@ -720,9 +1323,11 @@ struct OptionalCopyConstructor<MemberStatus::Defaulted, T>:
 	using base_type = optional_default_constructor_type<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 
 	constexpr OptionalCopyConstructor() = default;
@@ -739,9 +1344,11 @@ struct OptionalCopyConstructor<MemberStatus::Deleted, T>:
 	using base_type = optional_default_constructor_type<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 
 	constexpr OptionalCopyConstructor() = default;
@@ -752,7 +1359,7 @@ struct OptionalCopyConstructor<MemberStatus::Deleted, T>:
 };
 
 template <class T>
-struct OptionalCopyConstructor<MemberStatus::Defined, T>
+struct TIM_OPTIONAL_TRIVIAL_ABI OptionalCopyConstructor<MemberStatus::Defined, T>
 {
 	using base_type = optional_default_constructor_type<T>;
 	using value_type = std::conditional_t<is_cv_void_v<T>, EmptyAlternative, T>;
@@ -791,18 +1398,18 @@ struct OptionalCopyConstructor<MemberStatus::Defined, T>
 	constexpr const value_type& value() const { return base_.value(); }
 	constexpr       value_type& value()       { return base_.value(); }
 
-	constexpr const bool& has_value() const noexcept { return base_.has_value(); }
-	constexpr bool&       has_value()       noexcept { return base_.has_value(); }
+	constexpr bool has_value() const noexcept { return base_.has_value(); }
+	constexpr void set_has_value(bool v) noexcept { base_.set_has_value(v); }
 
 	template <
 		class ... Args,
 		std::enable_if_t<
-			std::is_constructible_v<value_type, Args&&...>,
+			detail::is_emplaceable<value_type, Args&&...>::value,
 			bool
 		> = false
 	>
 	constexpr void emplace(Args&& ... args)
-		noexcept(std::is_nothrow_constructible_v<value_type, Args&&...>)
+		noexcept(detail::is_nothrow_emplaceable<value_type, Args&&...>::value)
 	{
 		base_.emplace(std::forward<Args>(args)...);
 	}
@@ -814,6 +1421,12 @@ struct OptionalCopyConstructor<MemberStatus::Defined, T>
 		return base_.destruct();
 	}
 
+	constexpr void relocate_from(OptionalCopyConstructor& src)
+		noexcept(noexcept(std::declval<base_type&>().relocate_from(std::declval<base_type&>())))
+	{
+		base_.relocate_from(src.base_);
+	}
+
 private:
 	base_type base_;
 };
@@ -826,9 +1439,11 @@ struct OptionalMoveConstructor<MemberStatus::Defaulted, T>:
 	using base_type = optional_copy_constructor_type<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 
 	constexpr OptionalMoveConstructor() = default;
@@ -848,9 +1463,11 @@ struct OptionalMoveConstructor<MemberStatus::Deleted, T>:
 	using base_type = optional_copy_constructor_type<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 
 	constexpr OptionalMoveConstructor() = default;
@@ -861,7 +1478,7 @@ struct OptionalMoveConstructor<MemberStatus::Deleted, T>:
 };
 
 template <class T>
-struct OptionalMoveConstructor<MemberStatus::Defined, T> {
+struct TIM_OPTIONAL_TRIVIAL_ABI OptionalMoveConstructor<MemberStatus::Defined, T> {
 	using base_type = optional_copy_constructor_type<T>;
 	using value_type = std::conditional_t<is_cv_void_v<T>, EmptyAlternative, T>;
 	
@@ -898,18 +1515,18 @@ struct OptionalMoveConstructor<MemberStatus::Defined, T> {
 	constexpr const value_type& value() const { return base_.value(); }
 	constexpr       value_type& value()       { return base_.value(); }
 
-	constexpr const bool& has_value() const noexcept { return base_.has_value(); }
-	constexpr bool&       has_value()       noexcept { return base_.has_value(); }
+	constexpr bool has_value() const noexcept { return base_.has_value(); }
+	constexpr void set_has_value(bool v) noexcept { base_.set_has_value(v); }
 
 	template <
 		class ... Args,
 		std::enable_if_t<
-			std::is_constructible_v<value_type, Args&&...>,
+			detail::is_emplaceable<value_type, Args&&...>::value,
 			bool
 		> = false
 	>
 	constexpr void emplace(Args&& ... args)
-		noexcept(std::is_nothrow_constructible_v<value_type, Args&&...>)
+		noexcept(detail::is_nothrow_emplaceable<value_type, Args&&...>::value)
 	{
 		base_.emplace(std::forward<Args>(args)...);
 	}
@@ -921,6 +1538,12 @@ struct OptionalMoveConstructor<MemberStatus::Defined, T> {
 		return base_.destruct();
 	}
 
+	constexpr void relocate_from(OptionalMoveConstructor& src)
+		noexcept(noexcept(std::declval<base_type&>().relocate_from(std::declval<base_type&>())))
+	{
+		base_.relocate_from(src.base_);
+	}
+
 private:
 	base_type base_;
 };
@@ -932,9 +1555,11 @@ struct OptionalCopyAssign<MemberStatus::Defaulted, T>:
 	using base_type = optional_move_constructor_type<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 
 	constexpr OptionalCopyAssign() = default;
@@ -951,9 +1576,11 @@ struct OptionalCopyAssign<MemberStatus::Deleted, T>:
 	using base_type = optional_move_constructor_type<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 
 	constexpr OptionalCopyAssign() = default;
@@ -970,9 +1597,11 @@ struct OptionalCopyAssign<MemberStatus::Defined, T>:
 	using base_type = optional_move_constructor_type<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 	
 	constexpr OptionalCopyAssign() = default;
@@ -987,12 +1616,12 @@ struct OptionalCopyAssign<MemberStatus::Defined, T>:
 				this->value() = other.value();
 			} else {
 				this->destruct();
-				this->has_value() = false;
+				this->set_has_value(false);
 			}
 		} else {
 			if(other.has_value()) {
 				this->emplace(other.value());
-				this->has_value() = true;
+				this->set_has_value(true);
 			}
 		}
 		return *this;
@@ -1008,9 +1637,11 @@ struct OptionalMoveAssign<MemberStatus::Defaulted, T>:
 	using base_type = optional_copy_assign_type<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 
 	constexpr OptionalMoveAssign() = default;
@@ -1027,9 +1658,11 @@ struct OptionalMoveAssign<MemberStatus::Deleted, T>:
 	using base_type = optional_copy_assign_type<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 
 	constexpr OptionalMoveAssign() = default;
@@ -1046,9 +1679,11 @@ struct OptionalMoveAssign<MemberStatus::Defined, T>:
 	using base_type = optional_copy_assign_type<T>;
 	using base_type::base_type;
 	using base_type::has_value;
+	using base_type::set_has_value;
 	using base_type::value;
 	using base_type::destruct;
 	using base_type::emplace;
+	using base_type::relocate_from;
 	using base_type::throw_bad_optional_access;
 	
 	constexpr OptionalMoveAssign() = default;
@@ -1064,12 +1699,12 @@ struct OptionalMoveAssign<MemberStatus::Defined, T>:
 				this->value() = std::move(other.value());
 			} else {
 				this->destruct();
-				this->has_value() = false;
+				this->set_has_value(false);
 			}
 		} else {
 			if(other.has_value()) {
 				this->emplace(std::move(other.value()));
-				this->has_value() = true;
+				this->set_has_value(true);
 			}
 		}
 		return *this;
@@ -1123,6 +1758,57 @@ struct is_optional<Optional<T>>: std::true_type {};
 
 } /* namespace traits */
 
+namespace detail {
+
+template <class T>
+inline constexpr bool is_optional_v = is_optional<remove_cvref_t<T>>::value;
+
+// What 'transform()' wraps a callable's result 'R' in: lvalue references
+// stay references, anything else is held by value, and 'void' gives
+// 'Optional<void>'.
+template <class R>
+using transform_result_t = std::conditional_t<
+	std::is_lvalue_reference_v<R>,
+	Optional<R>,
+	Optional<std::remove_cv_t<std::remove_reference_t<R>>>
+>;
+
+template <class F, class ... Args>
+constexpr transform_result_t<std::invoke_result_t<F, Args...>> invoke_into_optional(F&& f, Args&& ... args) {
+	using result_type = std::invoke_result_t<F, Args...>;
+	using optional_type = transform_result_t<result_type>;
+	if constexpr(std::is_void_v<result_type>) {
+		detail::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+		return optional_type(in_place);
+	} else if constexpr(std::is_reference_v<result_type>) {
+		return optional_type(detail::invoke(std::forward<F>(f), std::forward<Args>(args)...));
+	} else {
+		return optional_type(from_invoke, std::forward<F>(f), std::forward<Args>(args)...);
+	}
+}
+
+template <class F, class Value>
+using and_then_result_t = remove_cvref_t<std::invoke_result_t<F, Value>>;
+
+// 'U&&' names an lvalue of type (possibly const) 'T'.
+template <class U, class T>
+inline constexpr bool is_lvalue_of_v = std::is_lvalue_reference_v<U>
+	&& std::is_same_v<remove_cvref_t<U>, std::remove_cv_t<T>>;
+
+// 'U&&' names a const lvalue of type 'T'.
+template <class U, class T>
+inline constexpr bool is_const_lvalue_of_v = is_lvalue_of_v<U, T>
+	&& std::is_const_v<std::remove_reference_t<U>>;
+
+template <class T, class F>
+using value_or_else_result_t = std::conditional_t<
+	is_lvalue_of_v<std::invoke_result_t<F>, T>,
+	const T&,
+	T
+>;
+
+} /* namespace detail */
+
 template <class T>
 struct Optional {
 private:
@@ -1343,6 +2029,24 @@ public:
 
 	}
 
+	// Engaged, with the payload initialized from 'std::invoke(f, args...)'.  When
+	// that returns 'T' by value the result is constructed in place, not moved.
+	template <
+		class F,
+		class ... Args,
+		std::enable_if_t<
+			detail::is_constructible_from_invoke<T, F&&, Args&&...>(),
+			bool
+		> = false
+	>
+	constexpr explicit Optional(from_invoke_t, F&& f, Args&& ... args) noexcept(
+		detail::is_nothrow_constructible_from_invoke<T, F&&, Args&&...>()
+	):
+		data_(in_place, from_invoke, std::forward<F>(f), std::forward<Args>(args)...)
+	{
+
+	}
+
 	constexpr Optional& operator=(const Optional&) = default;
 	constexpr Optional& operator=(Optional&&) = default;
 
@@ -1351,7 +2055,7 @@ public:
 			return *this;
 		}
 		data_.destruct();
-		data_.has_value() = false;
+		data_.set_has_value(false);
 		return *this;
 	}
 
@@ -1380,7 +2084,7 @@ public:
 			return *this;
 		}
 		data_.emplace(std::forward<U>(v));
-		data_.has_value() = true;
+		data_.set_has_value(true);
 		return *this;
 	}
 
@@ -1418,12 +2122,12 @@ public:
 				data_.value() = *v;
 			} else {
 				data_.destruct();
-				data_.has_value() = false;
+				data_.set_has_value(false);
 			}
 		} else {
 			if(v.has_value()) {
 				data_.emplace(*v);
-				data_.has_value() = true;
+				data_.set_has_value(true);
 			} else {
 				(void)0;
 			}
@@ -1465,12 +2169,12 @@ public:
 				data_.value() = std::move(*v);
 			} else {
 				data_.destruct();
-				data_.has_value() = false;
+				data_.set_has_value(false);
 			}
 		} else {
 			if(v.has_value()) {
 				data_.emplace(std::move(*v));
-				data_.has_value() = true;
+				data_.set_has_value(true);
 			} else {
 				(void)0;
 			}
@@ -1491,7 +2195,7 @@ public:
 				data_.destruct();
 			}
 			data_.emplace(std::forward<Args>(args)...);
-			data_.has_value() = true;
+			data_.set_has_value(true);
 		// } else if constexpr(std::is_nothrow_move_constructible_v<T>) {
 		// 	if(!data_.has_value()) {
 		// 		data_.emplace(std::forward<Args>(args)...);
@@ -1504,14 +2208,14 @@ public:
 		// 		data_.emplace(std::forward<Args>(args)...);
 		// 		guard.active = false;
 		// 	}
-		// 	data_.has_value() = true;
+		// 	data_.set_has_value(true);
 		} else {
 			if(data_.has_value()) {
 				data_.destruct();
-				data_.has_value() = false;
+				data_.set_has_value(false);
 			}
 			data_.emplace(std::forward<Args>(args)...);
-			data_.has_value() = true;
+			data_.set_has_value(true);
 		}
 		return this->val();
 	}
@@ -1532,7 +2236,7 @@ public:
 				data_.destruct();
 			}
 			data_.emplace(ilist, std::forward<Args>(args)...);
-			data_.has_value() = true;
+			data_.set_has_value(true);
 		// } else if constexpr(std::is_nothrow_move_constructible_v<T>) {
 		// 	if(!data_.has_value()) {
 		// 		data_.emplace(ilist, std::forward<Args>(args)...);
@@ -1545,15 +2249,37 @@ public:
 		// 		data_.emplace(ilist, std::forward<Args>(args)...);
 		// 		guard.active = false;
 		// 	}
-		// 	data_.has_value() = true;
+		// 	data_.set_has_value(true);
 		} else {
 			if(data_.has_value()) {
 				data_.destruct();
-				data_.has_value() = false;
+				data_.set_has_value(false);
 			}
 			data_.emplace(ilist, std::forward<Args>(args)...);
-			data_.has_value() = true;
+			data_.set_has_value(true);
+		}
+		return this->val();
+	}
+
+	// Like 'emplace()', but the new payload is initialized directly from
+	// 'std::invoke(f, args...)'.
+	template <
+		class F,
+		class ... Args,
+		std::enable_if_t<
+			detail::is_constructible_from_invoke<T, F&&, Args&&...>(),
+			bool
+		> = false
+	>
+	constexpr T& emplace_invoke(F&& f, Args&& ... args) noexcept(
+		detail::is_nothrow_constructible_from_invoke<T, F&&, Args&&...>()
+	) {
+		if(data_.has_value()) {
+			data_.destruct();
+			data_.set_has_value(false);
 		}
+		data_.emplace(from_invoke_t{}, std::forward<F>(f), std::forward<Args>(args)...);
+		data_.set_has_value(true);
 		return this->val();
 	}
 
@@ -1576,20 +2302,21 @@ public:
 	) {
 		if(this->has_value()) {
 			if(other.has_value()) {
-				using std::swap;
-				swap(this->val(), other.val());
+				if constexpr(is_trivially_relocatable_v<T> && !std::is_trivially_copyable_v<T>) {
+					data_type tmp(detail::empty_tag);
+					tmp.relocate_from(this->data_);
+					this->data_.relocate_from(other.data_);
+					other.data_.relocate_from(tmp);
+				} else {
+					using std::swap;
+					swap(this->val(), other.val());
+				}
 			} else {
-				other.data_.emplace(std::move(this->val()));
-				other.data_.has_value() = true;
-				this->data_.destruct();
-				this->data_.has_value() = false;
+				other.data_.relocate_from(this->data_);
 			}
 		} else {
 			if(other.has_value()) {
-				data_.emplace(std::move(other.val()));
-				data_.has_value() = true;
-				other.data_.destruct();
-				other.data_.has_value() = false;
+				data_.relocate_from(other.data_);
 			} else {
 				(void)0;
 			}
@@ -1599,7 +2326,17 @@ public:
 	constexpr void reset() noexcept {
 		if(this->has_value()) {
 			data_.destruct();
-			data_.has_value() = false;
+			data_.set_has_value(false);
+		}
+	}
+
+	template <class R>
+	void reset(defer_to_t<R> to) noexcept {
+		static_assert(noexcept(to.reclaimer.retire(std::declval<T*>())),
+			"'retire()' must not throw.");
+		if(this->has_value()) {
+			to.reclaimer.retire(std::addressof(this->val()));
+			data_.set_has_value(false);
 		}
 	}
 
@@ -1607,7 +2344,7 @@ public:
 		assert_has_value();
 		auto guard = detail::make_manual_scope_guard([this](){
 			this->data_.destruct();
-			this->data_.has_value() = false;
+			this->data_.set_has_value(false);
 		});
 		return static_cast<T>(std::move(this->val()));
 	}
@@ -1679,7 +2416,13 @@ public:
 		return std::move(this->val());
 	}
 
-	template <class U>
+	template <
+		class U,
+		std::enable_if_t<
+			!detail::is_const_lvalue_of_v<U, T>,
+			bool
+		> = false
+	>
 	constexpr T value_or(U&& alt) const& {
 		if(this->has_value()) {
 			return this->val();
@@ -1687,6 +2430,16 @@ public:
 		return std::forward<U>(alt);
 	}
 
+	// A const lvalue fallback of type 'T' outlives the call, so nothing needs
+	// to be copied: return a reference to the value or to 'alt'.  Non-const
+	// lvalues still get a copy, as before.
+	constexpr const T& value_or(const T& alt) const& noexcept {
+		if(this->has_value()) {
+			return this->val();
+		}
+		return alt;
+	}
+
 	template <class U>
 	constexpr T value_or(U&& alt) && {
 		if(this->has_value()) {
@@ -1695,8 +2448,121 @@ public:
 		return std::forward<U>(alt);
 	}
 
+	/*
+	 * Like 'value_or()', but the fallback is 'f()', which only runs when this
+	 * is empty.  When 'f' returns an lvalue of type 'T' the const& overload
+	 * returns a reference.
+	 */
+	template <class F>
+	constexpr detail::value_or_else_result_t<T, F> value_or_else(F&& f) const& {
+		static_assert(std::is_convertible_v<std::invoke_result_t<F>, T>,
+			"Optional<T>::value_or_else(): 'f()' must be convertible to T.");
+		if(this->has_value()) {
+			return this->val();
+		}
+		return detail::invoke(std::forward<F>(f));
+	}
+
+	template <class F>
+	constexpr T value_or_else(F&& f) && {
+		static_assert(std::is_convertible_v<std::invoke_result_t<F>, T>,
+			"Optional<T>::value_or_else(): 'f()' must be convertible to T.");
+		if(this->has_value()) {
+			return std::move(this->val());
+		}
+		return detail::invoke(std::forward<F>(f));
+	}
+
+	/*
+	 * Monadic operations.  'and_then(f)' returns 'f(value)', which must be an
+	 * Optional, or an empty Optional of that type.  'transform(f)' returns
+	 * 'f(value)' wrapped in an Optional, constructed in place.  'or_else(f)'
+	 * returns this Optional if it is engaged and 'f()' otherwise.  'filter(p)'
+	 * returns this Optional if it is engaged and 'p(value)' holds, and an empty
+	 * one otherwise.
+	 */
+	template <class F>
+	constexpr auto and_then(F&& f) & { return and_then_impl(*this, std::forward<F>(f)); }
+
+	template <class F>
+	constexpr auto and_then(F&& f) const& { return and_then_impl(*this, std::forward<F>(f)); }
+
+	template <class F>
+	constexpr auto and_then(F&& f) && { return and_then_impl(std::move(*this), std::forward<F>(f)); }
+
+	template <class F>
+	constexpr auto and_then(F&& f) const&& { return and_then_impl(std::move(*this), std::forward<F>(f)); }
+
+	template <class F>
+	constexpr auto transform(F&& f) & { return transform_impl(*this, std::forward<F>(f)); }
+
+	template <class F>
+	constexpr auto transform(F&& f) const& { return transform_impl(*this, std::forward<F>(f)); }
+
+	template <class F>
+	constexpr auto transform(F&& f) && { return transform_impl(std::move(*this), std::forward<F>(f)); }
+
+	template <class F>
+	constexpr auto transform(F&& f) const&& { return transform_impl(std::move(*this), std::forward<F>(f)); }
+
+	template <class F>
+	constexpr Optional or_else(F&& f) const& {
+		static_assert(std::is_same_v<detail::remove_cvref_t<std::invoke_result_t<F>>, Optional>,
+			"Optional<T>::or_else(): 'f' must return Optional<T>.");
+		if(this->has_value()) {
+			return *this;
+		}
+		return detail::invoke(std::forward<F>(f));
+	}
+
+	template <class F>
+	constexpr Optional or_else(F&& f) && {
+		static_assert(std::is_same_v<detail::remove_cvref_t<std::invoke_result_t<F>>, Optional>,
+			"Optional<T>::or_else(): 'f' must return Optional<T>.");
+		if(this->has_value()) {
+			return std::move(*this);
+		}
+		return detail::invoke(std::forward<F>(f));
+	}
+
+	template <class P>
+	constexpr Optional filter(P&& pred) const& {
+		if(this->has_value() && detail::invoke(std::forward<P>(pred), this->val())) {
+			return *this;
+		}
+		return nullopt;
+	}
+
+	template <class P>
+	constexpr Optional filter(P&& pred) && {
+		if(this->has_value() && detail::invoke(std::forward<P>(pred), std::as_const(this->val()))) {
+			return std::move(*this);
+		}
+		return nullopt;
+	}
+
 private:
 
+	template <class Self, class F>
+	static constexpr auto and_then_impl(Self&& self, F&& f) {
+		using result_type = detail::and_then_result_t<F, decltype(*std::forward<Self>(self))>;
+		static_assert(detail::is_optional<result_type>::value,
+			"Optional<T>::and_then(): 'f' must return a specialization of Optional.");
+		if(self.has_value()) {
+			return result_type(detail::invoke(std::forward<F>(f), *std::forward<Self>(self)));
+		}
+		return result_type(nullopt);
+	}
+
+	template <class Self, class F>
+	static constexpr auto transform_impl(Self&& self, F&& f) {
+		using result_type = detail::transform_result_t<std::invoke_result_t<F, decltype(*std::forward<Self>(self))>>;
+		if(self.has_value()) {
+			return detail::invoke_into_optional(std::forward<F>(f), *std::forward<Self>(self));
+		}
+		return result_type(nullopt);
+	}
+
 	constexpr void assert_has_value() const {
 #if defined(assert) && !defined(TIM_OPTIONAL_OPTIONAL_DISABLE_ASSERTIONS)
 		assert(this->has_value());
@@ -1724,6 +2590,234 @@ private:
 	data_type data_;
 };
 
+/*
+ * Optional lvalue reference.  Stored as a single pointer where null means
+ * empty; assignment rebinds rather than assigning through.  Only lvalues
+ * that bind directly to 'T&' are accepted, so an Optional<const T&> can never
+ * be bound to a temporary.
+ */
+template <class T>
+struct Optional<T&> {
+private:
+	static_assert(!std::is_same_v<tim::in_place_t, std::remove_cv_t<T>>,
+		"Instantiating Optional<T&> where 'T' is const- or volatile-qualified 'in_place_t' is not permitted.");
+	static_assert(!std::is_same_v<nullopt_t, std::remove_cv_t<T>>,
+		"Instantiating Optional<T&> where 'T' is const- or volatile-qualified 'nullopt_t' is not permitted.");
+
+	template <class U>
+	friend struct Optional;
+
+	template <class U>
+	using binds_directly = std::conjunction<
+		std::is_lvalue_reference<U>,
+		std::is_convertible<std::remove_reference_t<U>*, T*>
+	>;
+
+	template <class U>
+	using binds_temporary = std::conjunction<
+		std::negation<std::is_lvalue_reference<U>>,
+		std::is_convertible<std::remove_reference_t<U>*, T*>
+	>;
+public:
+
+	using value_type = T&;
+
+	constexpr Optional() noexcept = default;
+	constexpr Optional(const Optional&) noexcept = default;
+	constexpr Optional(Optional&&) noexcept = default;
+
+	constexpr Optional(nullopt_t) noexcept:
+		ptr_(nullptr)
+	{
+
+	}
+
+	template <
+		class U,
+		std::enable_if_t<binds_directly<U&&>::value, bool> = false
+	>
+	constexpr Optional(U&& ref) noexcept:
+		ptr_(std::addressof(ref))
+	{
+
+	}
+
+	template <
+		class U,
+		std::enable_if_t<binds_temporary<U&&>::value, bool> = false
+	>
+	Optional(U&& ref) = delete;
+
+	template <
+		class U,
+		std::enable_if_t<binds_directly<U&&>::value, bool> = false
+	>
+	constexpr explicit Optional(in_place_t, U&& ref) noexcept:
+		ptr_(std::addressof(ref))
+	{
+
+	}
+
+	template <
+		class U,
+		std::enable_if_t<
+			!std::is_same_v<T, U>
+			&& std::is_convertible_v<U*, T*>,
+			bool
+		> = false
+	>
+	constexpr Optional(const Optional<U&>& other) noexcept:
+		ptr_(other.ptr_)
+	{
+
+	}
+
+	constexpr Optional& operator=(const Optional&) noexcept = default;
+	constexpr Optional& operator=(Optional&&) noexcept = default;
+
+	constexpr Optional& operator=(nullopt_t) noexcept {
+		ptr_ = nullptr;
+		return *this;
+	}
+
+	template <
+		class U,
+		std::enable_if_t<binds_directly<U&&>::value, bool> = false
+	>
+	constexpr Optional& operator=(U&& ref) noexcept {
+		ptr_ = std::addressof(ref);
+		return *this;
+	}
+
+	template <
+		class U,
+		std::enable_if_t<binds_temporary<U&&>::value, bool> = false
+	>
+	Optional& operator=(U&& ref) = delete;
+
+	template <
+		class U,
+		std::enable_if_t<binds_directly<U&&>::value, bool> = false
+	>
+	constexpr T& emplace(U&& ref) noexcept {
+		ptr_ = std::addressof(ref);
+		return *ptr_;
+	}
+
+	constexpr void swap(Optional& other) noexcept {
+		T* tmp = other.ptr_;
+		other.ptr_ = ptr_;
+		ptr_ = tmp;
+	}
+
+	constexpr void reset() noexcept {
+		ptr_ = nullptr;
+	}
+
+	constexpr T& gut() {
+		assert_has_value();
+		T* p = ptr_;
+		ptr_ = nullptr;
+		return *p;
+	}
+
+	constexpr bool has_value() const noexcept {
+		return ptr_ != nullptr;
+	}
+
+	explicit constexpr operator bool() const noexcept {
+		return this->has_value();
+	}
+
+	constexpr T* operator->() const {
+		assert_has_value();
+		return ptr_;
+	}
+
+	constexpr T& operator*() const {
+		assert_has_value();
+		return *ptr_;
+	}
+
+	constexpr T& value() const noexcept(false) {
+		if(!this->has_value()) {
+			throw BadOptionalAccess();
+		}
+		return *ptr_;
+	}
+
+	template <class U>
+	constexpr std::remove_cv_t<T> value_or(U&& alt) const {
+		if(this->has_value()) {
+			return *ptr_;
+		}
+		return std::forward<U>(alt);
+	}
+
+	template <class F>
+	constexpr std::remove_cv_t<T> value_or_else(F&& f) const {
+		static_assert(std::is_convertible_v<std::invoke_result_t<F>, std::remove_cv_t<T>>,
+			"Optional<T&>::value_or_else(): 'f()' must be convertible to T.");
+		if(this->has_value()) {
+			return *ptr_;
+		}
+		return detail::invoke(std::forward<F>(f));
+	}
+
+	// As for Optional<T>; the referent is always passed as 'T&'.
+	template <class F>
+	constexpr auto and_then(F&& f) const {
+		using result_type = detail::and_then_result_t<F, T&>;
+		static_assert(detail::is_optional<result_type>::value,
+			"Optional<T&>::and_then(): 'f' must return a specialization of Optional.");
+		if(this->has_value()) {
+			return result_type(detail::invoke(std::forward<F>(f), *ptr_));
+		}
+		return result_type(nullopt);
+	}
+
+	template <class F>
+	constexpr auto transform(F&& f) const {
+		using result_type = detail::transform_result_t<std::invoke_result_t<F, T&>>;
+		if(this->has_value()) {
+			return detail::invoke_into_optional(std::forward<F>(f), *ptr_);
+		}
+		return result_type(nullopt);
+	}
+
+	template <class F>
+	constexpr Optional or_else(F&& f) const {
+		static_assert(std::is_same_v<detail::remove_cvref_t<std::invoke_result_t<F>>, Optional>,
+			"Optional<T&>::or_else(): 'f' must return Optional<T&>.");
+		if(this->has_value()) {
+			return *this;
+		}
+		return detail::invoke(std::forward<F>(f));
+	}
+
+	template <class P>
+	constexpr Optional filter(P&& pred) const {
+		if(this->has_value() && detail::invoke(std::forward<P>(pred), std::as_const(*ptr_))) {
+			return *this;
+		}
+		return nullopt;
+	}
+
+private:
+
+	constexpr void assert_has_value() const {
+#if defined(assert) && !defined(TIM_OPTIONAL_OPTIONAL_DISABLE_ASSERTIONS)
+		assert(this->has_value());
+#endif
+	}
+
+	constexpr T& val() const {
+		return *ptr_;
+	}
+
+	T* ptr_ = nullptr;
+};
+
 template <>
 struct Optional<void> {
 	template <class U>
@@ -2597,6 +3691,11 @@ constexpr void swap(Optional<T>& lhs, Optional<T>& rhs) noexcept(noexcept(lhs.sw
 	return lhs.swap(rhs);
 }
 
+template <class T>
+constexpr void swap(Optional<T&>& lhs, Optional<T&>& rhs) noexcept {
+	return lhs.swap(rhs);
+}
+
 constexpr void swap(Optional<void>& lhs, Optional<void>& rhs) noexcept(noexcept(lhs.swap(rhs))) {
 	return lhs.swap(rhs);
 }
@@ -2636,15 +3735,44 @@ constexpr Optional<std::decay_t<T>> some(T&& value) {
 	return Optional<std::decay_t<T>>(std::forward<T>(value));
 }
 
+// 'make_optional(from_invoke, f, args...)' and 'some(from_invoke, f, args...)'
+// construct the payload in place from 'std::invoke(f, args...)'.
+template <class T, class F, class ... Args>
+constexpr Optional<T> make_optional(from_invoke_t, F&& f, Args&& ... args) {
+	return Optional<T>(from_invoke, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template <
+	class F,
+	class ... Args,
+	class T = std::remove_cv_t<std::invoke_result_t<F&&, Args&&...>>
+>
+constexpr Optional<T> make_optional(from_invoke_t, F&& f, Args&& ... args) {
+	return Optional<T>(from_invoke, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template <
+	class F,
+	class ... Args,
+	class T = std::remove_cv_t<std::invoke_result_t<F&&, Args&&...>>
+>
+constexpr Optional<T> some(from_invoke_t, F&& f, Args&& ... args) {
+	return Optional<T>(from_invoke, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
 namespace hash_detail {
 
+// Optional<T&> hashes like Optional<T>.
+template <class T>
+using hashed_type = std::remove_const_t<std::remove_reference_t<T>>;
+
 template <
 	class T,
-	bool = std::is_default_constructible_v<std::hash<std::remove_const_t<T>>>
-		&& std::is_copy_constructible_v<std::hash<std::remove_const_t<T>>>
-		&& std::is_move_constructible_v<std::hash<std::remove_const_t<T>>>
-		&& std::is_copy_assignable_v<std::hash<std::remove_const_t<T>>>
-		&& std::is_move_assignable_v<std::hash<std::remove_const_t<T>>>
+	bool = std::is_default_constructible_v<std::hash<hashed_type<T>>>
+		&& std::is_copy_constructible_v<std::hash<hashed_type<T>>>
+		&& std::is_move_constructible_v<std::hash<hashed_type<T>>>
+		&& std::is_copy_assignable_v<std::hash<hashed_type<T>>>
+		&& std::is_move_assignable_v<std::hash<hashed_type<T>>>
 >
 struct OptionalHashBase;
 
@@ -2657,9 +3785,9 @@ struct OptionalHashBase<T, true> {
 	OptionalHashBase& operator=(OptionalHashBase&&) = default;
 
 	constexpr std::size_t operator()(const tim::optional::Optional<T>& v) const
-		noexcept(noexcept(std::hash<std::remove_const_t<T>>{}(std::declval<const T&>())))
+		noexcept(noexcept(std::hash<hashed_type<T>>{}(std::declval<const std::remove_reference_t<T>&>())))
 	{
-		return v ? std::hash<std::remove_const_t<T>>{}(*v) : 0;
+		return v ? std::hash<hashed_type<T>>{}(*v) : 0;
 	}
 };
 
@@ -0,0 +1,538 @@
+#ifndef TIM_OPTIONAL_OPTIONALALGORITHMS_HPP
+#define TIM_OPTIONAL_OPTIONALALGORITHMS_HPP
+
+#include "tim/optional/Optional.hpp"
+#include "tim/optional/detail/BitOps.hpp"
+#include "tim/optional/detail/PackedKernels.hpp"
+#include "tim/optional/WorkStealingPool.hpp"
+#include <type_traits>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace tim {
+
+inline namespace optional {
+
+namespace detail {
+
+template <class InputIt, class OutputIt>
+struct is_optional_span_to_values: std::false_type {};
+
+template <class T>
+struct is_optional_span_to_values<Optional<T>*, T*>: std::true_type {};
+
+template <class T>
+struct is_optional_span_to_values<const Optional<T>*, T*>: std::true_type {};
+
+template <class InputIt, class OutputIt>
+inline constexpr bool is_optional_span_to_values_v = is_optional_span_to_values<InputIt, OutputIt>::value;
+
+template <class It>
+struct is_mutable_optional_span: std::false_type {};
+
+template <class T>
+struct is_mutable_optional_span<Optional<T>*>: std::is_object<T> {};
+
+template <class It>
+inline constexpr bool is_mutable_optional_span_v = is_mutable_optional_span<It>::value;
+
+template <class Range, class = void>
+struct is_contiguous_range: std::false_type {};
+
+template <class Range>
+struct is_contiguous_range<
+	Range,
+	std::void_t<decltype(std::data(std::declval<Range&>())), decltype(std::size(std::declval<Range&>()))>
+>: std::true_type {};
+
+template <class Range>
+inline constexpr bool is_contiguous_range_v = is_contiguous_range<Range>::value;
+
+// Compacts 'n' optionals with the kernels for 'isa' (which must be supported)
+// and returns the number of values written.
+template <class T>
+std::size_t compact_with(SimdIsa isa, const Optional<T>* in, std::size_t n, T* out, std::uint64_t* mask) {
+	if(mask) {
+		std::fill_n(mask, bitmap_word_count(n), std::uint64_t(0));
+	}
+	KernelProgress done{0, 0};
+	if constexpr(optional_is_packed_v<T>) {
+		done = compact_packed_blocks(isa, in, n, out, mask);
+	}
+	std::size_t k = done.out;
+	for(std::size_t i = done.in; i < n; ++i) {
+		if(in[i].has_value()) {
+			out[k++] = *in[i];
+			if(mask) {
+				mask[bitmap_word_index(i)] |= bitmap_bit_mask(i);
+			}
+		}
+	}
+	return k;
+}
+
+// Expands into 'n' optionals with the kernels for 'isa' (which must be
+// supported) and returns the number of values read from 'dense'.
+template <class T>
+std::size_t expand_with(SimdIsa isa, const T* dense, const std::uint64_t* mask, std::size_t n, Optional<T>* out) {
+	KernelProgress done{0, 0};
+	if constexpr(optional_is_packed_v<T>) {
+		done = expand_packed_blocks(isa, dense, mask, n, out);
+	}
+	std::size_t k = done.out;
+	for(std::size_t i = done.in; i < n; ++i) {
+		if(mask[bitmap_word_index(i)] & bitmap_bit_mask(i)) {
+			out[i] = dense[k++];
+		} else {
+			out[i] = nullopt;
+		}
+	}
+	return k;
+}
+
+// Writes 'in[i].value_or(fallback)' to 'out[i]' for 'n' optionals with the
+// kernels for 'isa' (which must be supported).
+template <class T>
+void fill_missing_with(SimdIsa isa, const Optional<T>* in, std::size_t n, const T& fallback, T* out) {
+	std::size_t i = 0;
+	if constexpr(optional_is_packed_v<T>) {
+		i = fill_packed_blocks(isa, in, n, fallback, out);
+	}
+	for(; i < n; ++i) {
+		out[i] = in[i].has_value() ? *in[i] : fallback;
+	}
+}
+
+template <class T>
+void fill_missing_in_place_with(SimdIsa isa, Optional<T>* data, std::size_t n, const T& fallback) {
+	std::size_t i = 0;
+	if constexpr(optional_is_packed_v<T>) {
+		i = fill_packed_blocks_in_place(isa, data, n, fallback);
+	}
+	for(; i < n; ++i) {
+		if(!data[i].has_value()) {
+			data[i].emplace(fallback);
+		}
+	}
+}
+
+template <class Range, class = void>
+struct is_range: std::false_type {};
+
+template <class Range>
+struct is_range<
+	Range,
+	std::void_t<decltype(std::begin(std::declval<Range&>())), decltype(std::end(std::declval<Range&>()))>
+>: std::true_type {};
+
+template <class Range>
+inline constexpr bool is_range_v = is_range<Range>::value;
+
+/*
+ * Chunking for the parallel algorithms.  Chunk 'c > 0' starts at element
+ * 'head + c * grain', where 'head' is the first element of 'base' that starts
+ * a cache line and 'grain' spans a whole number of cache lines, so adjacent
+ * chunks of the written range never share a line (whenever the element size
+ * and the alignment of 'base' allow a line-aligned element at all).
+ */
+inline constexpr std::size_t cache_line_size = 64;
+
+struct ChunkPlan {
+	std::size_t size;
+	std::size_t head;
+	std::size_t grain;
+	std::size_t chunks;
+
+	std::size_t begin(std::size_t c) const noexcept {
+		return c == 0 ? 0 : std::min(size, head + c * grain);
+	}
+
+	std::size_t end(std::size_t c) const noexcept {
+		return begin(c + 1u);
+	}
+};
+
+// 'participants' is the pool size; aim for several chunks each so stealing
+// can even out the load, without making them too small to amortize.
+inline ChunkPlan plan_chunks(const void* base, std::size_t element_size, std::size_t n, unsigned participants) noexcept {
+	constexpr std::size_t min_grain = 1024;
+	const std::size_t step = cache_line_size / std::gcd(element_size, cache_line_size);
+	std::size_t head = 0;
+	if(base) {
+		auto address = reinterpret_cast<std::uintptr_t>(base);
+		for(std::size_t i = 0; i < step; ++i) {
+			if((address + i * element_size) % cache_line_size == 0) {
+				head = i;
+				break;
+			}
+		}
+	}
+	std::size_t grain = std::max(n / (std::size_t(participants) * 8u), min_grain);
+	grain = (grain + step - 1u) / step * step;
+	std::size_t chunks = n <= head ? 1 : 1 + (n - head - 1u) / grain;
+	return ChunkPlan{n, head, grain, chunks};
+}
+
+template <class It>
+const void* element_address(It it) noexcept {
+	if constexpr(std::is_pointer_v<It>) {
+		return static_cast<const void*>(it);
+	} else {
+		return nullptr;
+	}
+}
+
+template <class It>
+inline constexpr bool is_random_access_iterator_v = std::is_base_of_v<
+	std::random_access_iterator_tag,
+	typename std::iterator_traits<It>::iterator_category
+>;
+
+// Calls 'body(begin, end)' over [0, n) in chunks aligned to the elements
+// written through 'written'.
+template <class Written, class Body>
+void parallel_chunks(const execution::parallel_policy& policy, Written written, std::size_t n, Body&& body) {
+	WorkStealingPool& pool = policy.pool();
+	using element_type = typename std::iterator_traits<Written>::value_type;
+	ChunkPlan plan = plan_chunks(element_address(written), sizeof(element_type), n, pool.thread_count());
+	if(pool.thread_count() == 1 || plan.chunks == 1) {
+		body(std::size_t(0), n);
+		return;
+	}
+	pool.parallel_for(plan.chunks, [&](std::size_t c) { body(plan.begin(c), plan.end(c)); });
+}
+
+// Mirrors 'OptionalArray::for_each_present()': 'f(i, value)' or 'f(value)'.
+template <class F, class Value>
+void invoke_present(F& f, std::size_t i, Value&& value) {
+	if constexpr(std::is_invocable_v<F&, std::size_t, Value&&>) {
+		std::invoke(f, i, std::forward<Value>(value));
+	} else {
+		std::invoke(f, std::forward<Value>(value));
+	}
+}
+
+inline std::size_t bitmap_count(const std::uint64_t* mask, std::size_t n) noexcept {
+	std::size_t count = 0;
+	std::size_t words = n / bitmap_word_bits;
+	for(std::size_t w = 0; w < words; ++w) {
+		count += static_cast<std::size_t>(popcount(mask[w]));
+	}
+	if(n % bitmap_word_bits) {
+		count += static_cast<std::size_t>(popcount(mask[words] & bitmap_low_mask(n % bitmap_word_bits)));
+	}
+	return count;
+}
+
+} /* namespace detail */
+
+/*
+ * Stream compaction: copies the values of the engaged optionals in
+ * [first, last) to 'out', in order, and returns the end of the written range.
+ *
+ * Contiguous ranges of "packed" optionals (see detail/PackedKernels.hpp; e.g.
+ * 'Optional<int>', 'Optional<double>') are compacted with AVX-512 or AVX2
+ * when the running CPU has them, and with a scalar loop otherwise.
+ */
+template <class InputIt, class OutputIt>
+OutputIt compact(InputIt first, InputIt last, OutputIt out) {
+	if constexpr(detail::is_optional_span_to_values_v<InputIt, OutputIt>) {
+		auto n = static_cast<std::size_t>(last - first);
+		return out + detail::compact_with(detail::simd_isa(), first, n, out, nullptr);
+	} else {
+		for(; first != last; ++first) {
+			if(first->has_value()) {
+				*out = **first;
+				++out;
+			}
+		}
+		return out;
+	}
+}
+
+// As above, and also records which inputs were engaged in the presence bitmap
+// 'mask' (bit 'i % 64' of word 'i / 64'), which must hold at least
+// '(last - first + 63) / 64' words.  'expand()' reverses this.
+template <class T>
+T* compact(const Optional<T>* first, const Optional<T>* last, T* out, std::uint64_t* mask) {
+	auto n = static_cast<std::size_t>(last - first);
+	return out + detail::compact_with(detail::simd_isa(), first, n, out, mask);
+}
+
+// Appends the values of the engaged optionals in 'in' to 'out'.
+template <class Range, class T, class Alloc>
+void compact(const Range& in, std::vector<T, Alloc>& out) {
+	if constexpr(detail::is_contiguous_range_v<const Range> && std::is_default_constructible_v<T>) {
+		std::size_t old_size = out.size();
+		out.resize(old_size + std::size(in));
+		T* end = compact(std::data(in), std::data(in) + std::size(in), out.data() + old_size);
+		out.resize(static_cast<std::size_t>(end - out.data()));
+	} else {
+		compact(std::begin(in), std::end(in), std::back_inserter(out));
+	}
+}
+
+/*
+ * Scatter, the inverse of 'compact()': for each 'i' in [0, last - first),
+ * assigns the next value from 'dense' to 'first[i]' if bit 'i' of 'mask' is
+ * set, and resets 'first[i]' otherwise.  Returns one past the last value read.
+ * Uses the same kernels as 'compact()'.
+ */
+template <class T>
+const T* expand(const T* dense, const std::uint64_t* mask, Optional<T>* first, Optional<T>* last) {
+	auto n = static_cast<std::size_t>(last - first);
+	return dense + detail::expand_with(detail::simd_isa(), dense, mask, n, first);
+}
+
+// Checked range form.  Throws 'std::invalid_argument' if 'mask' has fewer than
+// 'size(out)' bits or sets more of them than 'dense' has values.
+template <class DenseRange, class MaskRange, class OutRange>
+void expand(const DenseRange& dense, const MaskRange& mask, OutRange& out) {
+	std::size_t n = std::size(out);
+	if(std::size(mask) < detail::bitmap_word_count(n)) {
+		throw std::invalid_argument("tim::expand(): presence mask is shorter than the output range.");
+	}
+	if(std::size(dense) < detail::bitmap_count(std::data(mask), n)) {
+		throw std::invalid_argument("tim::expand(): presence mask selects more values than are available.");
+	}
+	expand(std::data(dense), std::data(mask), std::data(out), std::data(out) + n);
+}
+
+/*
+ * Batched 'value_or': writes 'first[i].value_or(fallback)' to 'out[i]' for
+ * each element of [first, last) and returns the end of the written range.
+ * Contiguous packed ranges (see 'compact()') blend with SIMD masks taken from
+ * the flag bytes instead of branching per element.
+ */
+template <class InputIt, class U, class OutputIt>
+OutputIt fill_missing(InputIt first, InputIt last, const U& fallback, OutputIt out) {
+	if constexpr(detail::is_optional_span_to_values_v<InputIt, OutputIt>) {
+		using value_type = std::remove_pointer_t<OutputIt>;
+		auto n = static_cast<std::size_t>(last - first);
+		detail::fill_missing_with<value_type>(
+			detail::simd_isa(), first, n, static_cast<value_type>(fallback), out
+		);
+		return out + n;
+	} else {
+		for(; first != last; ++first, ++out) {
+			*out = first->value_or(fallback);
+		}
+		return out;
+	}
+}
+
+// Range form.  Throws 'std::invalid_argument' if 'out' is shorter than 'in'.
+template <
+	class InRange,
+	class U,
+	class OutRange,
+	std::enable_if_t<detail::is_range_v<const InRange> && detail::is_range_v<OutRange>, bool> = false
+>
+void fill_missing(const InRange& in, const U& fallback, OutRange&& out) {
+	if(std::size(out) < std::size(in)) {
+		throw std::invalid_argument("tim::fill_missing(): output range is shorter than the input range.");
+	}
+	if constexpr(detail::is_contiguous_range_v<const InRange> && detail::is_contiguous_range_v<OutRange>) {
+		fill_missing(std::data(in), std::data(in) + std::size(in), fallback, std::data(out));
+	} else {
+		fill_missing(std::begin(in), std::end(in), fallback, std::begin(out));
+	}
+}
+
+// In place: engages every empty optional in [first, last) with 'fallback'.
+template <
+	class ForwardIt,
+	class U,
+	std::enable_if_t<!detail::is_range_v<ForwardIt>, bool> = false
+>
+void fill_missing(ForwardIt first, ForwardIt last, const U& fallback) {
+	if constexpr(detail::is_mutable_optional_span_v<ForwardIt>) {
+		using value_type = typename std::remove_pointer_t<ForwardIt>::value_type;
+		detail::fill_missing_in_place_with<value_type>(
+			detail::simd_isa(), first, static_cast<std::size_t>(last - first), static_cast<value_type>(fallback)
+		);
+	} else {
+		for(; first != last; ++first) {
+			if(!first->has_value()) {
+				first->emplace(fallback);
+			}
+		}
+	}
+}
+
+template <class Range, class U, std::enable_if_t<detail::is_range_v<Range>, bool> = false>
+void fill_missing(Range&& inout, const U& fallback) {
+	if constexpr(detail::is_contiguous_range_v<Range>) {
+		fill_missing(std::data(inout), std::data(inout) + std::size(inout), fallback);
+	} else {
+		fill_missing(std::begin(inout), std::end(inout), fallback);
+	}
+}
+
+/*
+ * Bulk operations on the engaged elements of a range of optionals.  Each takes
+ * an execution policy first: 'execution::seq' runs the plain loop, while
+ * 'execution::par' (or 'execution::par.on(pool)') splits random-access
+ * ranges into cache-line-aligned chunks on a 'WorkStealingPool'.  With 'par',
+ * the callables run concurrently and must not race with each other.
+ */
+
+// Calls 'f(i, *first[i])' (or 'f(*first[i])') for each engaged 'first[i]'.
+template <
+	class Policy,
+	class It,
+	class F,
+	std::enable_if_t<execution::is_execution_policy_v<Policy>, bool> = false
+>
+void for_each_present(Policy&& policy, It first, It last, F f) {
+	if constexpr(std::is_same_v<detail::remove_cvref_t<Policy>, execution::parallel_policy>
+		&& detail::is_random_access_iterator_v<It>)
+	{
+		auto n = static_cast<std::size_t>(last - first);
+		detail::parallel_chunks(policy, first, n, [&](std::size_t b, std::size_t e) {
+			for(std::size_t i = b; i < e; ++i) {
+				if(first[i].has_value()) {
+					detail::invoke_present(f, i, *first[i]);
+				}
+			}
+		});
+	} else {
+		(void)policy;
+		for(std::size_t i = 0; first != last; ++first, ++i) {
+			if(first->has_value()) {
+				detail::invoke_present(f, i, **first);
+			}
+		}
+	}
+}
+
+template <
+	class Policy,
+	class Range,
+	class F,
+	std::enable_if_t<execution::is_execution_policy_v<Policy>, bool> = false
+>
+void for_each_present(Policy&& policy, Range&& range, F f) {
+	if constexpr(detail::is_contiguous_range_v<Range>) {
+		for_each_present(policy, std::data(range), std::data(range) + std::size(range), std::move(f));
+	} else {
+		for_each_present(policy, std::begin(range), std::end(range), std::move(f));
+	}
+}
+
+template <
+	class Policy,
+	class It,
+	std::enable_if_t<execution::is_execution_policy_v<Policy>, bool> = false
+>
+std::size_t count_present(Policy&& policy, It first, It last) {
+	if constexpr(std::is_same_v<detail::remove_cvref_t<Policy>, execution::parallel_policy>
+		&& detail::is_random_access_iterator_v<It>)
+	{
+		auto n = static_cast<std::size_t>(last - first);
+		std::atomic<std::size_t> total{0};
+		detail::parallel_chunks(policy, first, n, [&](std::size_t b, std::size_t e) {
+			std::size_t count = 0;
+			for(std::size_t i = b; i < e; ++i) {
+				count += first[i].has_value();
+			}
+			total.fetch_add(count, std::memory_order_relaxed);
+		});
+		return total.load(std::memory_order_relaxed);
+	} else {
+		(void)policy;
+		std::size_t count = 0;
+		for(; first != last; ++first) {
+			count += first->has_value();
+		}
+		return count;
+	}
+}
+
+template <
+	class Policy,
+	class Range,
+	std::enable_if_t<execution::is_execution_policy_v<Policy>, bool> = false
+>
+std::size_t count_present(Policy&& policy, const Range& range) {
+	if constexpr(detail::is_contiguous_range_v<const Range>) {
+		return count_present(policy, std::data(range), std::data(range) + std::size(range));
+	} else {
+		return count_present(policy, std::begin(range), std::end(range));
+	}
+}
+
+// Sets 'out[i]' to 'f(*first[i])' if 'first[i]' is engaged and to 'nullopt'
+// otherwise; 'out' is typically a range of 'Optional<U>'.  Chunks are aligned
+// to the elements of 'out'.  Returns the end of the written range.
+template <
+	class Policy,
+	class InputIt,
+	class OutputIt,
+	class F,
+	std::enable_if_t<execution::is_execution_policy_v<Policy>, bool> = false
+>
+OutputIt transform_present(Policy&& policy, InputIt first, InputIt last, OutputIt out, F f) {
+	if constexpr(std::is_same_v<detail::remove_cvref_t<Policy>, execution::parallel_policy>
+		&& detail::is_random_access_iterator_v<InputIt>
+		&& detail::is_random_access_iterator_v<OutputIt>)
+	{
+		auto n = static_cast<std::size_t>(last - first);
+		detail::parallel_chunks(policy, out, n, [&](std::size_t b, std::size_t e) {
+			for(std::size_t i = b; i < e; ++i) {
+				if(first[i].has_value()) {
+					out[i] = std::invoke(f, *first[i]);
+				} else {
+					out[i] = nullopt;
+				}
+			}
+		});
+		return out + static_cast<typename std::iterator_traits<OutputIt>::difference_type>(n);
+	} else {
+		(void)policy;
+		for(; first != last; ++first, ++out) {
+			if(first->has_value()) {
+				*out = std::invoke(f, **first);
+			} else {
+				*out = nullopt;
+			}
+		}
+		return out;
+	}
+}
+
+// Range form.  Throws 'std::invalid_argument' if 'out' is shorter than 'in'.
+template <
+	class Policy,
+	class InRange,
+	class OutRange,
+	class F,
+	std::enable_if_t<
+		execution::is_execution_policy_v<Policy> && detail::is_range_v<const InRange> && detail::is_range_v<OutRange>,
+		bool
+	> = false
+>
+void transform_present(Policy&& policy, const InRange& in, OutRange&& out, F f) {
+	if(std::size(out) < std::size(in)) {
+		throw std::invalid_argument("tim::transform_present(): output range is shorter than the input range.");
+	}
+	if constexpr(detail::is_contiguous_range_v<const InRange> && detail::is_contiguous_range_v<OutRange>) {
+		transform_present(policy, std::data(in), std::data(in) + std::size(in), std::data(out), std::move(f));
+	} else {
+		transform_present(policy, std::begin(in), std::end(in), std::begin(out), std::move(f));
+	}
+}
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_OPTIONALALGORITHMS_HPP */
@@ -0,0 +1,509 @@
+#ifndef TIM_OPTIONAL_OPTIONALARRAY_HPP
+#define TIM_OPTIONAL_OPTIONALARRAY_HPP
+
+#include "tim/optional/Optional.hpp"
+#include "tim/optional/detail/BitOps.hpp"
+#include <type_traits>
+#include <utility>
+#include <tuple>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+
+namespace tim {
+
+inline namespace optional {
+
+template <class T, std::size_t N>
+struct OptionalArray;
+
+namespace detail {
+
+// Slots are 'OptionalUnion<T>'s: each holds an inactive placeholder or a
+// live 'T', and never destroys it by itself.  Bit 'i' of 'mask_' says which.
+template <class T, std::size_t N>
+struct OptionalArraySlots {
+	using wrapper_type = ValueWrapper<T>;
+
+	constexpr OptionalArraySlots() noexcept:
+		OptionalArraySlots(std::make_index_sequence<N>{}, std::tuple<>())
+	{
+
+	}
+
+	// Engages the leading slots from 'values' (see OptionalArray's constructor).
+	template <class ... U>
+	constexpr OptionalArraySlots(in_place_t, U&& ... values):
+		OptionalArraySlots(std::make_index_sequence<N>{}, std::forward_as_tuple(std::forward<U>(values)...))
+	{
+
+	}
+
+	constexpr bool slot_has_value(std::size_t i) const noexcept {
+		return (mask_ >> i) & 1u;
+	}
+
+	constexpr const T& slot_value(std::size_t i) const {
+		return std::launder(std::addressof(slots_[i].storage_.value))->value();
+	}
+
+	constexpr T& slot_value(std::size_t i) {
+		return std::launder(std::addressof(slots_[i].storage_.value))->value();
+	}
+
+	// Both of these leave 'mask_' to the caller.
+	template <class ... Args>
+	void construct_slot(std::size_t i, Args&& ... args) {
+		::new (static_cast<void*>(std::addressof(slots_[i].storage_.value)))
+			wrapper_type(tim::in_place, std::forward<Args>(args)...);
+	}
+
+	void destroy_slot(std::size_t i) noexcept {
+		if constexpr(!std::is_trivially_destructible_v<T>) {
+			std::destroy_at(std::addressof(slots_[i].storage_.value));
+		}
+	}
+
+	// The mask comes first so that it is computed before 'values' are moved.
+	std::uint64_t mask_;
+	OptionalUnion<T> slots_[N];
+
+private:
+	using slot_type = OptionalUnion<T>;
+
+	// Every slot has to be initialized explicitly: unions of non-trivial
+	// payloads have no default constructor.
+	template <std::size_t ... I, class Values>
+	constexpr OptionalArraySlots(std::index_sequence<I...>, Values values):
+		mask_(((engaged_at<I>(values) ? (std::uint64_t(1) << I) : std::uint64_t(0)) | ... | std::uint64_t(0))),
+		slots_{slot_at<I>(values)...}
+	{
+
+	}
+
+	template <std::size_t I, class Values>
+	static constexpr bool engaged_at(const Values& values) noexcept {
+		if constexpr(I < std::tuple_size_v<Values>) {
+			return engaged(std::get<I>(values));
+		} else {
+			return false;
+		}
+	}
+
+	template <std::size_t I, class Values>
+	static constexpr slot_type slot_at(Values& values) {
+		if constexpr(I < std::tuple_size_v<Values>) {
+			return make_slot(std::forward<std::tuple_element_t<I, Values>>(std::get<I>(values)));
+		} else {
+			return slot_type(empty_tag);
+		}
+	}
+
+	static constexpr bool engaged(nullopt_t) noexcept { return false; }
+
+	template <class U>
+	static constexpr bool engaged(const Optional<U>& v) noexcept { return v.has_value(); }
+
+	template <class U>
+	static constexpr bool engaged(const U&) noexcept { return true; }
+
+	static constexpr slot_type make_slot(nullopt_t) noexcept {
+		return slot_type(empty_tag);
+	}
+
+	template <class U>
+	static constexpr slot_type make_slot(const Optional<U>& v) {
+		return v.has_value() ? slot_type(in_place, *v) : slot_type(empty_tag);
+	}
+
+	template <class U>
+	static constexpr slot_type make_slot(Optional<U>&& v) {
+		return v.has_value() ? slot_type(in_place, std::move(*v)) : slot_type(empty_tag);
+	}
+
+	template <
+		class U,
+		std::enable_if_t<
+			!std::is_same_v<std::decay_t<U>, nullopt_t> && !is_optional<std::decay_t<U>>::value,
+			bool
+		> = false
+	>
+	static constexpr slot_type make_slot(U&& v) {
+		return slot_type(in_place, std::forward<U>(v));
+	}
+};
+
+template <class T, std::size_t N, bool = std::is_trivially_destructible_v<T>>
+struct OptionalArrayDestructor: OptionalArraySlots<T, N> {
+	using OptionalArraySlots<T, N>::OptionalArraySlots;
+};
+
+template <class T, std::size_t N>
+struct OptionalArrayDestructor<T, N, false>: OptionalArraySlots<T, N> {
+	using OptionalArraySlots<T, N>::OptionalArraySlots;
+
+	OptionalArrayDestructor() = default;
+	OptionalArrayDestructor(const OptionalArrayDestructor&) = default;
+	OptionalArrayDestructor(OptionalArrayDestructor&&) = default;
+	OptionalArrayDestructor& operator=(const OptionalArrayDestructor&) = default;
+	OptionalArrayDestructor& operator=(OptionalArrayDestructor&&) = default;
+
+	~OptionalArrayDestructor() {
+		for(std::uint64_t m = this->mask_; m; m &= m - 1u) {
+			this->destroy_slot(static_cast<std::size_t>(countr_zero(m)));
+		}
+	}
+};
+
+// Trivially copyable payloads copy the slots and the mask bitwise; anything
+// else copies slot by slot with 'Optional<T>'s rules.
+template <class T, std::size_t N, bool = std::is_trivially_copyable_v<T>>
+struct OptionalArrayCopy: OptionalArrayDestructor<T, N> {
+	using OptionalArrayDestructor<T, N>::OptionalArrayDestructor;
+};
+
+template <class T, std::size_t N>
+struct OptionalArrayCopy<T, N, false>: OptionalArrayDestructor<T, N> {
+	using OptionalArrayDestructor<T, N>::OptionalArrayDestructor;
+
+	OptionalArrayCopy() = default;
+
+	OptionalArrayCopy(const OptionalArrayCopy& other):
+		OptionalArrayDestructor<T, N>()
+	{
+		for(std::uint64_t m = other.mask_; m; m &= m - 1u) {
+			const auto i = static_cast<std::size_t>(countr_zero(m));
+			this->construct_slot(i, other.slot_value(i));
+			this->mask_ |= std::uint64_t(1) << i;
+		}
+	}
+
+	OptionalArrayCopy(OptionalArrayCopy&& other) noexcept(std::is_nothrow_move_constructible_v<T>):
+		OptionalArrayDestructor<T, N>()
+	{
+		for(std::uint64_t m = other.mask_; m; m &= m - 1u) {
+			const auto i = static_cast<std::size_t>(countr_zero(m));
+			this->construct_slot(i, std::move(other.slot_value(i)));
+			this->mask_ |= std::uint64_t(1) << i;
+		}
+	}
+
+	OptionalArrayCopy& operator=(const OptionalArrayCopy& other) {
+		assign_from(other, [&](std::size_t i) -> const T& { return other.slot_value(i); });
+		return *this;
+	}
+
+	OptionalArrayCopy& operator=(OptionalArrayCopy&& other) noexcept(
+		std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>
+	) {
+		assign_from(other, [&](std::size_t i) -> T&& { return std::move(other.slot_value(i)); });
+		return *this;
+	}
+
+private:
+	template <class Get>
+	void assign_from(const OptionalArrayCopy& other, Get get) {
+		for(std::uint64_t m = this->mask_ | other.mask_; m; m &= m - 1u) {
+			const auto i = static_cast<std::size_t>(countr_zero(m));
+			if(!other.slot_has_value(i)) {
+				this->mask_ &= ~(std::uint64_t(1) << i);
+				this->destroy_slot(i);
+			} else if(this->slot_has_value(i)) {
+				this->slot_value(i) = get(i);
+			} else {
+				this->construct_slot(i, get(i));
+				this->mask_ |= std::uint64_t(1) << i;
+			}
+		}
+	}
+};
+
+// Empty bases that delete whichever special members 'T' cannot support.
+template <bool Copy, bool Move>
+struct OptionalArrayEnableConstruct {};
+
+template <>
+struct OptionalArrayEnableConstruct<false, true> {
+	OptionalArrayEnableConstruct() = default;
+	OptionalArrayEnableConstruct(const OptionalArrayEnableConstruct&) = delete;
+	OptionalArrayEnableConstruct(OptionalArrayEnableConstruct&&) = default;
+	OptionalArrayEnableConstruct& operator=(const OptionalArrayEnableConstruct&) = default;
+	OptionalArrayEnableConstruct& operator=(OptionalArrayEnableConstruct&&) = default;
+};
+
+template <>
+struct OptionalArrayEnableConstruct<false, false> {
+	OptionalArrayEnableConstruct() = default;
+	OptionalArrayEnableConstruct(const OptionalArrayEnableConstruct&) = delete;
+	OptionalArrayEnableConstruct(OptionalArrayEnableConstruct&&) = delete;
+	OptionalArrayEnableConstruct& operator=(const OptionalArrayEnableConstruct&) = default;
+	OptionalArrayEnableConstruct& operator=(OptionalArrayEnableConstruct&&) = default;
+};
+
+template <bool Copy, bool Move>
+struct OptionalArrayEnableAssign {};
+
+template <>
+struct OptionalArrayEnableAssign<false, true> {
+	OptionalArrayEnableAssign() = default;
+	OptionalArrayEnableAssign(const OptionalArrayEnableAssign&) = default;
+	OptionalArrayEnableAssign(OptionalArrayEnableAssign&&) = default;
+	OptionalArrayEnableAssign& operator=(const OptionalArrayEnableAssign&) = delete;
+	OptionalArrayEnableAssign& operator=(OptionalArrayEnableAssign&&) = default;
+};
+
+template <>
+struct OptionalArrayEnableAssign<false, false> {
+	OptionalArrayEnableAssign() = default;
+	OptionalArrayEnableAssign(const OptionalArrayEnableAssign&) = default;
+	OptionalArrayEnableAssign(OptionalArrayEnableAssign&&) = default;
+	OptionalArrayEnableAssign& operator=(const OptionalArrayEnableAssign&) = delete;
+	OptionalArrayEnableAssign& operator=(OptionalArrayEnableAssign&&) = delete;
+};
+
+template <class T>
+using optional_array_enable_construct = OptionalArrayEnableConstruct<
+	std::is_copy_constructible_v<T>,
+	std::is_move_constructible_v<T>
+>;
+
+template <class T>
+using optional_array_enable_assign = OptionalArrayEnableAssign<
+	std::is_copy_constructible_v<T> && std::is_copy_assignable_v<T>,
+	std::is_move_constructible_v<T> && std::is_move_assignable_v<T>
+>;
+
+} /* namespace detail */
+
+/*
+ * 'N' (at most 64) optional 'T's stored inline, with a single 64-bit mask in
+ * place of 'N' flags.  Slot queries reduce to bit operations on the mask.
+ * Slots follow 'Optional<T>'s construction and destruction rules, and the
+ * array is trivially copyable when 'T' is.
+ */
+template <class T, std::size_t N>
+struct OptionalArray:
+	private detail::OptionalArrayCopy<T, N>,
+	private detail::optional_array_enable_construct<T>,
+	private detail::optional_array_enable_assign<T>
+{
+private:
+	static_assert(N <= 64,
+		"OptionalArray<T, N> keeps its presence mask in one 64-bit word; 'N' must not exceed 64.");
+	static_assert(std::is_object_v<T> && !std::is_array_v<T>,
+		"Instantiating OptionalArray<T, N> for non-object or array type 'T' is not permitted.");
+	static_assert(!std::is_same_v<std::remove_cv_t<T>, tim::in_place_t>,
+		"Instantiating OptionalArray<T, N> where 'T' is 'in_place_t' is not permitted.");
+	static_assert(!std::is_same_v<std::remove_cv_t<T>, nullopt_t>,
+		"Instantiating OptionalArray<T, N> where 'T' is 'nullopt_t' is not permitted.");
+
+	using base_type = detail::OptionalArrayCopy<T, N>;
+
+	static constexpr std::uint64_t all_mask = detail::bitmap_low_mask(N);
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+
+	constexpr OptionalArray() noexcept = default;
+
+	/*
+	 * Initializes the leading slots from 'values'.  Each may be a 'T' (or
+	 * something 'T' is constructible from), an 'Optional', or 'nullopt'.
+	 */
+	template <
+		class ... U,
+		std::enable_if_t<
+			(sizeof...(U) > 0)
+			&& (sizeof...(U) <= N)
+			&& std::conjunction_v<
+				std::negation<std::is_same<std::decay_t<U>, OptionalArray>>...,
+				std::is_constructible<Optional<T>, U&&>...
+			>,
+			bool
+		> = false
+	>
+	constexpr OptionalArray(U&& ... values):
+		base_type(in_place, std::forward<U>(values)...)
+	{
+
+	}
+
+	static constexpr size_type size() noexcept { return N; }
+
+	// The presence mask; bit 'i' is set when slot 'i' is engaged.
+	constexpr std::uint64_t mask() const noexcept { return this->mask_; }
+
+	constexpr size_type count() const noexcept {
+		return static_cast<size_type>(detail::popcount(this->mask_));
+	}
+
+	constexpr bool empty() const noexcept { return this->mask_ == 0; }
+	constexpr bool full() const noexcept { return this->mask_ == all_mask; }
+
+	constexpr bool has_value(size_type pos) const noexcept {
+		assert_in_range(pos);
+		return this->slot_has_value(pos);
+	}
+
+	// Index of the first disengaged slot, or 'size()' when there is none.
+	constexpr size_type find_first_empty() const noexcept {
+		const std::uint64_t free = ~this->mask_ & all_mask;
+		return free ? static_cast<size_type>(detail::countr_zero(free)) : N;
+	}
+
+	// Index of the first engaged slot, or 'size()' when there is none.
+	constexpr size_type find_first_present() const noexcept {
+		return this->mask_ ? static_cast<size_type>(detail::countr_zero(this->mask_)) : N;
+	}
+
+	/*
+	 * Calls 'f(i, value)' (or 'f(value)') for each engaged slot in index
+	 * order.  'f' must not engage or reset slots of this array.
+	 */
+	template <class F>
+	constexpr void for_each_present(F&& f) {
+		for_each_present_impl(*this, std::forward<F>(f));
+	}
+
+	template <class F>
+	constexpr void for_each_present(F&& f) const {
+		for_each_present_impl(*this, std::forward<F>(f));
+	}
+
+	constexpr Optional<T&> operator[](size_type pos) noexcept {
+		if(has_value(pos)) {
+			return Optional<T&>(this->slot_value(pos));
+		}
+		return Optional<T&>();
+	}
+
+	constexpr Optional<const T&> operator[](size_type pos) const noexcept {
+		if(has_value(pos)) {
+			return Optional<const T&>(this->slot_value(pos));
+		}
+		return Optional<const T&>();
+	}
+
+	constexpr T& value(size_type pos) noexcept(false) {
+		if(!has_value(pos)) {
+			throw BadOptionalAccess();
+		}
+		return this->slot_value(pos);
+	}
+
+	constexpr const T& value(size_type pos) const noexcept(false) {
+		if(!has_value(pos)) {
+			throw BadOptionalAccess();
+		}
+		return this->slot_value(pos);
+	}
+
+	// As 'Optional<T>::emplace()': destroys any current value first, and
+	// leaves the slot disengaged if construction throws.
+	template <
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, Args&&...>,
+			bool
+		> = false
+	>
+	constexpr T& emplace(size_type pos, Args&& ... args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>) {
+		reset(pos);
+		this->construct_slot(pos, std::forward<Args>(args)...);
+		this->mask_ |= bit(pos);
+		return this->slot_value(pos);
+	}
+
+	constexpr void reset(size_type pos) noexcept {
+		if(has_value(pos)) {
+			this->mask_ &= ~bit(pos);
+			this->destroy_slot(pos);
+		}
+	}
+
+	constexpr void clear() noexcept {
+		const std::uint64_t engaged = this->mask_;
+		this->mask_ = 0;
+		for(std::uint64_t m = engaged; m; m &= m - 1u) {
+			this->destroy_slot(static_cast<size_type>(detail::countr_zero(m)));
+		}
+	}
+
+	template <
+		class Other = OptionalArray,
+		std::enable_if_t<
+			std::conjunction_v<
+				std::is_same<Other, OptionalArray>,
+				std::is_move_constructible<T>,
+				std::is_swappable<T>
+			>,
+			bool
+		> = false
+	>
+	constexpr void swap(Other& other) noexcept(
+		std::conjunction_v<
+			std::is_nothrow_move_constructible<T>,
+			std::is_nothrow_swappable<T>
+		>
+	) {
+		for(std::uint64_t m = this->mask_ | other.mask_; m; m &= m - 1u) {
+			const auto i = static_cast<size_type>(detail::countr_zero(m));
+			if(this->slot_has_value(i) && other.slot_has_value(i)) {
+				using std::swap;
+				swap(this->slot_value(i), other.slot_value(i));
+			} else if(this->slot_has_value(i)) {
+				other.emplace(i, std::move(this->slot_value(i)));
+				reset(i);
+			} else {
+				emplace(i, std::move(other.slot_value(i)));
+				other.reset(i);
+			}
+		}
+	}
+
+private:
+	template <class Self, class F>
+	static constexpr void for_each_present_impl(Self& self, F&& f) {
+		for(std::uint64_t m = self.mask_; m; m &= m - 1u) {
+			const auto i = static_cast<size_type>(detail::countr_zero(m));
+			if constexpr(std::is_invocable_v<F&, size_type, decltype(self.slot_value(i))>) {
+				f(i, self.slot_value(i));
+			} else {
+				f(self.slot_value(i));
+			}
+		}
+	}
+
+	static constexpr std::uint64_t bit(size_type pos) noexcept {
+		return std::uint64_t(1) << pos;
+	}
+
+	constexpr void assert_in_range([[maybe_unused]] size_type pos) const noexcept {
+#if defined(assert) && !defined(TIM_OPTIONAL_OPTIONAL_DISABLE_ASSERTIONS)
+		assert(pos < N);
+#endif
+	}
+};
+
+template <
+	class T,
+	std::size_t N,
+	std::enable_if_t<
+		std::conjunction_v<
+			std::is_move_constructible<T>,
+			std::is_swappable<T>
+		>,
+		bool
+	> = false
+>
+constexpr void swap(OptionalArray<T, N>& l, OptionalArray<T, N>& r) noexcept(noexcept(l.swap(r))) {
+	l.swap(r);
+}
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_OPTIONALARRAY_HPP */
@@ -0,0 +1,522 @@
+#ifndef TIM_OPTIONAL_OPTIONALCOLUMN_HPP
+#define TIM_OPTIONAL_OPTIONALCOLUMN_HPP
+
+#include "tim/optional/Optional.hpp"
+#include "tim/optional/detail/BitOps.hpp"
+#include "tim/optional/detail/ArrowCDataInterface.hpp"
+#include <type_traits>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <memory>
+#include <new>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+namespace tim {
+
+inline namespace optional {
+
+namespace detail {
+
+// Arrow format string for fixed-width primitive 'T', or nullptr.
+template <class T>
+constexpr const char* arrow_format_string() noexcept {
+	if constexpr(std::is_same_v<T, bool> || !std::is_same_v<std::remove_cv_t<T>, T>) {
+		return nullptr;
+	} else if constexpr(std::is_integral_v<T>) {
+		constexpr bool s = std::is_signed_v<T>;
+		switch(sizeof(T)) {
+		case 1: return s ? "c" : "C";
+		case 2: return s ? "s" : "S";
+		case 4: return s ? "i" : "I";
+		case 8: return s ? "l" : "L";
+		default: return nullptr;
+		}
+	} else if constexpr(std::is_same_v<T, float> && sizeof(float) == 4) {
+		return "f";
+	} else if constexpr(std::is_same_v<T, double> && sizeof(double) == 8) {
+		return "g";
+	} else {
+		return nullptr;
+	}
+}
+
+// Arrow recommends 64-byte aligned buffers, padded to a multiple of 64 bytes.
+inline constexpr std::size_t arrow_alignment = 64;
+
+constexpr std::size_t arrow_padded_size(std::size_t bytes) noexcept {
+	return (bytes + (arrow_alignment - 1)) / arrow_alignment * arrow_alignment;
+}
+
+constexpr std::size_t arrow_bitmap_bytes(std::size_t bits) noexcept {
+	return (bits + 7u) / 8u;
+}
+
+// Returns zeroed, aligned and padded storage for 'bytes' bytes.
+inline void* arrow_allocate(std::size_t bytes) {
+	if(!bytes) {
+		return nullptr;
+	}
+	void* p = ::operator new(arrow_padded_size(bytes), std::align_val_t(arrow_alignment));
+	std::memset(p, 0, arrow_padded_size(bytes));
+	return p;
+}
+
+inline void arrow_deallocate(void* p) noexcept {
+	if(p) {
+		::operator delete(p, std::align_val_t(arrow_alignment));
+	}
+}
+
+inline bool arrow_get_bit(const std::uint8_t* bitmap, std::size_t i) noexcept {
+	return (bitmap[i / 8u] >> (i % 8u)) & 1u;
+}
+
+inline void arrow_set_bit(std::uint8_t* bitmap, std::size_t i) noexcept {
+	bitmap[i / 8u] |= static_cast<std::uint8_t>(1u << (i % 8u));
+}
+
+inline void arrow_clear_bit(std::uint8_t* bitmap, std::size_t i) noexcept {
+	bitmap[i / 8u] &= static_cast<std::uint8_t>(~(1u << (i % 8u)));
+}
+
+// Number of set bits among 'bitmap' bits [first, first + n).
+inline std::size_t arrow_count_set_bits(const std::uint8_t* bitmap, std::size_t first, std::size_t n) noexcept {
+	std::size_t count = 0;
+	std::size_t i = first;
+	const std::size_t last = first + n;
+	for(; i < last && (i % 8u); ++i) {
+		count += arrow_get_bit(bitmap, i);
+	}
+	for(; i + bitmap_word_bits <= last; i += bitmap_word_bits) {
+		std::uint64_t w;
+		std::memcpy(&w, bitmap + i / 8u, sizeof(w));
+		count += static_cast<std::size_t>(popcount(w));
+	}
+	for(; i < last; ++i) {
+		count += arrow_get_bit(bitmap, i);
+	}
+	return count;
+}
+
+// Private data of an exported ArrowArray: the buffers it owns and, for
+// columns that were themselves imported, the array they still borrow from.
+struct ArrowExportedColumn {
+	const void* buffers[2];
+	void* owned_values;
+	void* owned_validity;
+	ArrowArray source;
+};
+
+inline void arrow_release_exported_column(ArrowArray* array) noexcept {
+	auto* exported = static_cast<ArrowExportedColumn*>(array->private_data);
+	arrow_deallocate(exported->owned_values);
+	arrow_deallocate(exported->owned_validity);
+	if(exported->source.release) {
+		exported->source.release(&exported->source);
+	}
+	delete exported;
+	array->release = nullptr;
+}
+
+inline void arrow_release_static_schema(ArrowSchema* schema) noexcept {
+	schema->release = nullptr;
+}
+
+} /* namespace detail */
+
+/*
+ * A column of optional fixed-width 'T's laid out exactly as an Arrow
+ * primitive array: a 64-byte aligned values buffer and an LSB-ordered
+ * validity bitmap, plus a cached null count.  Columns can be handed to and
+ * taken from the Arrow C data interface without copying either buffer.
+ * Imported buffers are never written to: the first change to an imported
+ * column copies them into buffers of its own.
+ */
+template <class T>
+struct OptionalColumn {
+private:
+	static_assert(detail::arrow_format_string<T>() != nullptr,
+		"OptionalColumn<T> requires a fixed-width arithmetic type 'T' with an Arrow primitive format.");
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+
+	OptionalColumn() noexcept = default;
+
+	explicit OptionalColumn(size_type count):
+		OptionalColumn()
+	{
+		resize(count);
+	}
+
+	OptionalColumn(std::initializer_list<Optional<T>> ilist):
+		OptionalColumn()
+	{
+		reserve(ilist.size());
+		for(const Optional<T>& v: ilist) {
+			push_back(v);
+		}
+	}
+
+	OptionalColumn(const OptionalColumn& other):
+		OptionalColumn()
+	{
+		reserve(other.size_);
+		copy_slots(values_, validity_, other.values_, other.validity_, other.size_);
+		size_ = other.size_;
+		null_count_ = other.null_count_;
+	}
+
+	OptionalColumn(OptionalColumn&& other) noexcept:
+		OptionalColumn()
+	{
+		swap(other);
+	}
+
+	OptionalColumn& operator=(const OptionalColumn& other) {
+		if(this != std::addressof(other)) {
+			OptionalColumn(other).swap(*this);
+		}
+		return *this;
+	}
+
+	OptionalColumn& operator=(OptionalColumn&& other) noexcept {
+		OptionalColumn(std::move(other)).swap(*this);
+		return *this;
+	}
+
+	~OptionalColumn() {
+		release_buffers();
+	}
+
+	// The Arrow format string of 'T', e.g. "i" for int32_t.
+	static constexpr const char* arrow_format() noexcept {
+		return detail::arrow_format_string<T>();
+	}
+
+	size_type size() const noexcept { return size_; }
+	bool empty() const noexcept { return size_ == 0; }
+	size_type capacity() const noexcept { return capacity_; }
+	size_type null_count() const noexcept { return null_count_; }
+	size_type count() const noexcept { return size_ - null_count_; }
+
+	// The raw Arrow buffers.  'validity()' is null when the column was
+	// imported without a bitmap and has had no nulls since.
+	const T* values() const noexcept { return values_; }
+	const std::uint8_t* validity() const noexcept { return validity_; }
+
+	bool has_value(size_type pos) const noexcept {
+		assert_in_range(pos);
+		return !validity_ || detail::arrow_get_bit(validity_, pos);
+	}
+
+	Optional<T> operator[](size_type pos) const noexcept {
+		if(has_value(pos)) {
+			return Optional<T>(values_[pos]);
+		}
+		return Optional<T>();
+	}
+
+	const T& value(size_type pos) const noexcept(false) {
+		if(!has_value(pos)) {
+			throw BadOptionalAccess();
+		}
+		return values_[pos];
+	}
+
+	template <
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, Args&&...>,
+			bool
+		> = false
+	>
+	T& emplace(size_type pos, Args&& ... args) {
+		own_buffers();
+		values_[pos] = T(std::forward<Args>(args)...);
+		if(!has_value(pos)) {
+			detail::arrow_set_bit(validity_, pos);
+			--null_count_;
+		}
+		return values_[pos];
+	}
+
+	void reset(size_type pos) {
+		if(has_value(pos)) {
+			own_buffers();
+			detail::arrow_clear_bit(validity_, pos);
+			++null_count_;
+		}
+	}
+
+	template <
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, Args&&...>,
+			bool
+		> = false
+	>
+	T& emplace_back(Args&& ... args) {
+		grow_for_append();
+		values_[size_] = T(std::forward<Args>(args)...);
+		detail::arrow_set_bit(validity_, size_);
+		return values_[size_++];
+	}
+
+	void push_back(nullopt_t) {
+		grow_for_append();
+		append_null();
+	}
+
+	void push_back(const Optional<T>& v) {
+		if(v.has_value()) {
+			emplace_back(*v);
+		} else {
+			push_back(nullopt);
+		}
+	}
+
+	void pop_back() noexcept {
+		assert_in_range(size_ - 1);
+		truncate(size_ - 1);
+	}
+
+	void reserve(size_type new_cap) {
+		if(new_cap > capacity_) {
+			reallocate(new_cap);
+		}
+	}
+
+	// Grows with null slots, or shrinks to the first 'new_size' slots.
+	void resize(size_type new_size) {
+		if(new_size < size_) {
+			truncate(new_size);
+		} else if(new_size > size_) {
+			reserve(new_size);
+			own_buffers();
+			while(size_ < new_size) {
+				append_null();
+			}
+		}
+	}
+
+	void clear() noexcept {
+		truncate(0);
+	}
+
+	void swap(OptionalColumn& other) noexcept {
+		using std::swap;
+		swap(values_, other.values_);
+		swap(validity_, other.validity_);
+		swap(size_, other.size_);
+		swap(capacity_, other.capacity_);
+		swap(null_count_, other.null_count_);
+		swap(owns_values_, other.owns_values_);
+		swap(owns_validity_, other.owns_validity_);
+		swap(source_, other.source_);
+	}
+
+	// Describes 'T' as a nullable Arrow primitive type.
+	static void export_schema(ArrowSchema* out) noexcept {
+		*out = ArrowSchema{
+			arrow_format(), "", nullptr, ARROW_FLAG_NULLABLE, 0, nullptr, nullptr,
+			&detail::arrow_release_static_schema, nullptr
+		};
+	}
+
+	/*
+	 * Hands the buffers over to 'out' without copying them and leaves the
+	 * column empty.  The consumer frees them through 'out->release'.
+	 */
+	void export_array(ArrowArray* out) && {
+		auto* exported = new detail::ArrowExportedColumn{
+			{validity_, values_},
+			owns_values_ ? values_ : nullptr,
+			owns_validity_ ? validity_ : nullptr,
+			source_
+		};
+		*out = ArrowArray{
+			static_cast<std::int64_t>(size_), static_cast<std::int64_t>(null_count_), 0, 2, 0,
+			exported->buffers, nullptr, nullptr,
+			&detail::arrow_release_exported_column, exported
+		};
+		values_ = nullptr;
+		validity_ = nullptr;
+		size_ = capacity_ = null_count_ = 0;
+		owns_values_ = owns_validity_ = true;
+		source_ = ArrowArray{};
+	}
+
+	/*
+	 * Takes ownership of 'array' (leaving it released, as the interface
+	 * prescribes for moves) and adopts its buffers in place, read-only.  Only
+	 * a validity bitmap starting mid-byte is copied, to realign it.  Throws
+	 * std::invalid_argument if 'array' does not hold 'T's.
+	 */
+	static OptionalColumn import_array(ArrowArray* array, const ArrowSchema* schema) {
+		if(!array || !array->release) {
+			throw std::invalid_argument("OptionalColumn: cannot import a released ArrowArray.");
+		}
+		if(!schema || !schema->format || std::strcmp(schema->format, arrow_format()) != 0) {
+			throw std::invalid_argument("OptionalColumn: ArrowSchema format does not match the column type.");
+		}
+		if(array->n_buffers != 2 || array->n_children != 0 || array->dictionary || array->length < 0 || array->offset < 0) {
+			throw std::invalid_argument("OptionalColumn: ArrowArray is not a primitive array.");
+		}
+		if(!array->buffers || (array->length > 0 && !array->buffers[1])) {
+			throw std::invalid_argument("OptionalColumn: ArrowArray has no values buffer.");
+		}
+		OptionalColumn col;
+		col.source_ = *array;
+		array->release = nullptr;
+		const auto offset = static_cast<size_type>(col.source_.offset);
+		const auto length = static_cast<size_type>(col.source_.length);
+		const auto* bitmap = static_cast<const std::uint8_t*>(col.source_.buffers[0]);
+		// Borrowed buffers are only read; see 'own_buffers()'.
+		col.values_ = const_cast<T*>(static_cast<const T*>(col.source_.buffers[1])) + offset;
+		col.owns_values_ = false;
+		col.size_ = col.capacity_ = length;
+		if(!bitmap) {
+			col.owns_validity_ = false;
+		} else if(offset % 8u == 0) {
+			col.validity_ = const_cast<std::uint8_t*>(bitmap) + offset / 8u;
+			col.owns_validity_ = false;
+		} else {
+			col.validity_ = static_cast<std::uint8_t*>(detail::arrow_allocate(detail::arrow_bitmap_bytes(length)));
+			for(size_type i = 0; i < length; ++i) {
+				if(detail::arrow_get_bit(bitmap, offset + i)) {
+					detail::arrow_set_bit(col.validity_, i);
+				}
+			}
+		}
+		if(!col.validity_) {
+			col.null_count_ = 0;
+		} else if(col.source_.null_count >= 0) {
+			col.null_count_ = static_cast<size_type>(col.source_.null_count);
+		} else {
+			col.null_count_ = length - detail::arrow_count_set_bits(col.validity_, 0, length);
+		}
+		return col;
+	}
+
+private:
+	// Also takes over borrowed buffers, which have spare capacity once an
+	// imported column has been shrunk.
+	void grow_for_append() {
+		if(size_ == capacity_) {
+			reallocate(capacity_ ? 2 * capacity_ : detail::arrow_alignment / sizeof(T));
+		} else {
+			own_buffers();
+		}
+	}
+
+	void append_null() noexcept {
+		values_[size_] = T();
+		detail::arrow_clear_bit(validity_, size_);
+		++size_;
+		++null_count_;
+	}
+
+	// Copies the first 'n' slots; a null 'validity' means "all valid".
+	static void copy_slots(
+		T* dst_values, std::uint8_t* dst_validity,
+		const T* values, const std::uint8_t* validity,
+		size_type n
+	) noexcept {
+		if(!n) {
+			return;
+		}
+		std::memcpy(dst_values, values, n * sizeof(T));
+		if(validity) {
+			std::memcpy(dst_validity, validity, detail::arrow_bitmap_bytes(n));
+		} else {
+			std::memset(dst_validity, 0xFF, n / 8u);
+			for(size_type i = n / 8u * 8u; i < n; ++i) {
+				detail::arrow_set_bit(dst_validity, i);
+			}
+		}
+	}
+
+	// Moves into freshly allocated, owned buffers of 'new_cap' slots.
+	void reallocate(size_type new_cap) {
+		auto* values = static_cast<T*>(detail::arrow_allocate(new_cap * sizeof(T)));
+		auto guard = detail::make_manual_scope_guard([&]() { detail::arrow_deallocate(values); });
+		auto* validity = static_cast<std::uint8_t*>(detail::arrow_allocate(detail::arrow_bitmap_bytes(new_cap)));
+		guard.active = false;
+		copy_slots(values, validity, values_, validity_, size_);
+		const size_type size = size_;
+		const size_type null_count = null_count_;
+		release_buffers();
+		values_ = values;
+		validity_ = validity;
+		size_ = size;
+		capacity_ = new_cap;
+		null_count_ = null_count;
+	}
+
+	// Copies borrowed (imported) buffers into owned ones before a write, and
+	// gives a bitmap-less column a bitmap.  The exporter's buffers must be
+	// treated as immutable; they may even be read-only pages.
+	void own_buffers() {
+		if(!owns_values_ || !owns_validity_ || !validity_) {
+			reallocate(capacity_);
+		}
+	}
+
+	void truncate(size_type new_size) noexcept {
+		if(validity_) {
+			const size_type removed = size_ - new_size;
+			null_count_ -= removed - detail::arrow_count_set_bits(validity_, new_size, removed);
+		}
+		size_ = new_size;
+	}
+
+	void release_buffers() noexcept {
+		if(owns_values_) {
+			detail::arrow_deallocate(values_);
+		}
+		if(owns_validity_) {
+			detail::arrow_deallocate(validity_);
+		}
+		if(source_.release) {
+			source_.release(&source_);
+		}
+		values_ = nullptr;
+		validity_ = nullptr;
+		size_ = capacity_ = null_count_ = 0;
+		owns_values_ = owns_validity_ = true;
+		source_ = ArrowArray{};
+	}
+
+	void assert_in_range([[maybe_unused]] size_type pos) const noexcept {
+#if defined(assert) && !defined(TIM_OPTIONAL_OPTIONAL_DISABLE_ASSERTIONS)
+		assert(pos < size_);
+#endif
+	}
+
+	T* values_ = nullptr;
+	std::uint8_t* validity_ = nullptr;
+	size_type size_ = 0;
+	size_type capacity_ = 0;
+	size_type null_count_ = 0;
+	// False for buffers borrowed from 'source_', which are never written.
+	bool owns_values_ = true;
+	bool owns_validity_ = true;
+	// The imported array our buffers are borrowed from, if any.
+	ArrowArray source_{};
+};
+
+template <class T>
+void swap(OptionalColumn<T>& l, OptionalColumn<T>& r) noexcept {
+	l.swap(r);
+}
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_OPTIONALCOLUMN_HPP */
@@ -0,0 +1,293 @@
+#ifndef TIM_OPTIONAL_OPTIONALPIPELINE_HPP
+#define TIM_OPTIONAL_OPTIONALPIPELINE_HPP
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <cstddef>
+
+namespace tim {
+
+inline namespace optional {
+
+/*
+ * Lazy monadic chains:
+ *
+ *     Optional<R> r = opt | tim::transform(f) | tim::filter(p) | tim::and_then(g);
+ *
+ * 'opt | step' records the step instead of running it, and the chain runs
+ * when it is converted to its result type (or on 'eval()').  Evaluation tests
+ * the source once and then passes values straight from one callable to the
+ * next, so consecutive 'transform's never materialize an Optional in
+ * between, and a trailing 'transform' constructs the final value in place.
+ * 'and_then' and 'filter' add their own test, and 'or_else' only runs on the
+ * empty path.
+ *
+ * A chain holds a reference to its source and is consumed by evaluation, like
+ * an expression template: evaluate it within the full-expression that builds
+ * it, or while the source is still alive.
+ */
+
+namespace detail {
+
+template <class F>
+struct TransformStep {
+	F f;
+};
+
+template <class F>
+struct AndThenStep {
+	F f;
+};
+
+template <class F>
+struct OrElseStep {
+	F f;
+};
+
+template <class P>
+struct FilterStep {
+	P pred;
+};
+
+template <class T>
+struct is_pipeline_step: std::false_type {};
+
+template <class F>
+struct is_pipeline_step<TransformStep<F>>: std::true_type {};
+
+template <class F>
+struct is_pipeline_step<AndThenStep<F>>: std::true_type {};
+
+template <class F>
+struct is_pipeline_step<OrElseStep<F>>: std::true_type {};
+
+template <class P>
+struct is_pipeline_step<FilterStep<P>>: std::true_type {};
+
+template <template <class> class Step, class T>
+inline constexpr bool is_step = false;
+
+template <template <class> class Step, class F>
+inline constexpr bool is_step<Step, Step<F>> = true;
+
+/*
+ * The type of the Optional after each step ('Chain') and of the expression
+ * that produces the engaged value at that point ('Get'; a prvalue type when a
+ * 'transform' has just computed it).
+ */
+template <class Chain, class Get, class ... Steps>
+struct pipeline_result {
+	using type = Chain;
+};
+
+template <class Chain, class Get, class F, class ... Steps>
+struct pipeline_result<Chain, Get, TransformStep<F>, Steps...> {
+	using value_type = std::invoke_result_t<F, Get>;
+	static_assert(!std::is_void_v<value_type>,
+		"tim::transform(): pipeline steps may not return void.");
+	using type = typename pipeline_result<transform_result_t<value_type>, value_type, Steps...>::type;
+};
+
+template <class Chain, class Get, class F, class ... Steps>
+struct pipeline_result<Chain, Get, AndThenStep<F>, Steps...> {
+	using optional_type = std::invoke_result_t<F, Get>;
+	static_assert(is_optional_v<optional_type>,
+		"tim::and_then(): 'f' must return a specialization of Optional.");
+	using type = typename pipeline_result<
+		remove_cvref_t<optional_type>,
+		decltype(*std::declval<optional_type>()),
+		Steps...
+	>::type;
+};
+
+template <class Chain, class Get, class P, class ... Steps>
+struct pipeline_result<Chain, Get, FilterStep<P>, Steps...> {
+	using type = typename pipeline_result<Chain, std::conditional_t<std::is_reference_v<Get>, Get, Get&&>, Steps...>::type;
+};
+
+template <class Chain, class Get, class F, class ... Steps>
+struct pipeline_result<Chain, Get, OrElseStep<F>, Steps...> {
+	static_assert(std::is_same_v<remove_cvref_t<std::invoke_result_t<F>>, Chain>,
+		"tim::or_else(): 'f' must return the Optional type of the chain at that point.");
+	using type = typename pipeline_result<Chain, Get, Steps...>::type;
+};
+
+/*
+ * Calls 'f(get())'.  Calling 'f' directly rather than through 'invoke()' lets a
+ * prvalue from 'get()' initialize a by-value parameter of 'f' without a move.
+ */
+template <class F, class Get>
+constexpr decltype(auto) invoke_with(F&& f, Get& get) {
+	if constexpr(std::is_member_pointer_v<std::decay_t<F>>) {
+		return invoke(std::forward<F>(f), get());
+	} else {
+		return std::forward<F>(f)(get());
+	}
+}
+
+// Builds the final Optional from 'get()', in place when it is a prvalue.
+template <class Result, class Get>
+constexpr Result materialize(Get& get) {
+	using get_type = decltype(get());
+	if constexpr(!std::is_reference_v<get_type>) {
+		return Result(from_invoke, get);
+	} else if constexpr(std::is_lvalue_reference_v<typename Result::value_type>) {
+		return Result(get());
+	} else {
+		return Result(in_place, get());
+	}
+}
+
+} /* namespace detail */
+
+template <class Source, class ... Steps>
+class OptionalPipeline {
+	static_assert(std::is_reference_v<Source>);
+
+	template <class S, class ... T>
+	friend class OptionalPipeline;
+
+	template <class O, class Step, std::enable_if_t<detail::is_optional_v<O>, bool>>
+	friend constexpr OptionalPipeline<O&&, std::decay_t<Step>> operator|(O&& source, Step&& step);
+
+public:
+	using result_type = typename detail::pipeline_result<
+		detail::remove_cvref_t<Source>,
+		decltype(*std::declval<Source>()),
+		Steps...
+	>::type;
+
+	OptionalPipeline(const OptionalPipeline&) = delete;
+	OptionalPipeline(OptionalPipeline&&) = default;
+	OptionalPipeline& operator=(const OptionalPipeline&) = delete;
+	OptionalPipeline& operator=(OptionalPipeline&&) = delete;
+
+	constexpr result_type eval() && {
+		if(source_.has_value()) {
+			auto get = [this]() -> decltype(auto) { return *std::forward<Source>(source_); };
+			return present<0>(get);
+		}
+		return empty<0>();
+	}
+
+	constexpr operator result_type() && {
+		return std::move(*this).eval();
+	}
+
+	template <class Step, std::enable_if_t<detail::is_pipeline_step<std::decay_t<Step>>::value, bool> = false>
+	friend constexpr OptionalPipeline<Source, Steps..., std::decay_t<Step>> operator|(OptionalPipeline&& pipeline, Step&& step) {
+		return std::move(pipeline).append(std::forward<Step>(step));
+	}
+
+private:
+	template <class Step>
+	constexpr OptionalPipeline<Source, Steps..., std::decay_t<Step>> append(Step&& step) && {
+		return OptionalPipeline<Source, Steps..., std::decay_t<Step>>(
+			std::forward<Source>(source_),
+			std::tuple_cat(std::move(steps_), std::tuple<std::decay_t<Step>>(std::forward<Step>(step)))
+		);
+	}
+
+	constexpr OptionalPipeline(Source source, std::tuple<Steps...>&& steps):
+		source_(std::forward<Source>(source)),
+		steps_(std::move(steps))
+	{
+
+	}
+
+	// Runs steps 'I...' on an engaged value produced by 'get()'.  Each 'get' is
+	// called at most once.
+	template <std::size_t I, class Get>
+	constexpr result_type present(Get& get) {
+		if constexpr(I == sizeof...(Steps)) {
+			return detail::materialize<result_type>(get);
+		} else {
+			auto& step = std::get<I>(steps_);
+			using step_type = std::tuple_element_t<I, std::tuple<Steps...>>;
+			if constexpr(detail::is_step<detail::TransformStep, step_type>) {
+				auto next = [&]() -> decltype(auto) { return detail::invoke_with(std::move(step.f), get); };
+				return present<I + 1>(next);
+			} else if constexpr(detail::is_step<detail::AndThenStep, step_type>) {
+				auto&& opt = detail::invoke_with(std::move(step.f), get);
+				if(opt.has_value()) {
+					auto next = [&]() -> decltype(auto) { return *std::forward<decltype(opt)>(opt); };
+					return present<I + 1>(next);
+				}
+				return empty<I + 1>();
+			} else if constexpr(detail::is_step<detail::FilterStep, step_type>) {
+				auto&& value = get();
+				if(detail::invoke(step.pred, std::as_const(value))) {
+					auto next = [&]() -> decltype(auto) { return std::forward<decltype(value)>(value); };
+					return present<I + 1>(next);
+				}
+				return empty<I + 1>();
+			} else {
+				return present<I + 1>(get);
+			}
+		}
+	}
+
+	// Runs steps 'I...' on an empty chain: only 'or_else' does anything.
+	template <std::size_t I>
+	constexpr result_type empty() {
+		if constexpr(I == sizeof...(Steps)) {
+			return result_type(nullopt);
+		} else {
+			using step_type = std::tuple_element_t<I, std::tuple<Steps...>>;
+			if constexpr(detail::is_step<detail::OrElseStep, step_type>) {
+				auto&& opt = detail::invoke(std::move(std::get<I>(steps_).f));
+				if(opt.has_value()) {
+					auto next = [&]() -> decltype(auto) { return *std::forward<decltype(opt)>(opt); };
+					return present<I + 1>(next);
+				}
+			}
+			return empty<I + 1>();
+		}
+	}
+
+	Source source_;
+	std::tuple<Steps...> steps_;
+};
+
+template <
+	class O,
+	class Step,
+	std::enable_if_t<detail::is_optional_v<O>, bool> = false
+>
+constexpr OptionalPipeline<O&&, std::decay_t<Step>> operator|(O&& source, Step&& step) {
+	static_assert(detail::is_pipeline_step<std::decay_t<Step>>::value,
+		"The right-hand side of 'optional | step' must be tim::transform(), and_then(), or_else() or filter().");
+	return OptionalPipeline<O&&, std::decay_t<Step>>(
+		std::forward<O>(source),
+		std::tuple<std::decay_t<Step>>(std::forward<Step>(step))
+	);
+}
+
+template <class F>
+constexpr detail::TransformStep<std::decay_t<F>> transform(F&& f) {
+	return detail::TransformStep<std::decay_t<F>>{std::forward<F>(f)};
+}
+
+template <class F>
+constexpr detail::AndThenStep<std::decay_t<F>> and_then(F&& f) {
+	return detail::AndThenStep<std::decay_t<F>>{std::forward<F>(f)};
+}
+
+template <class F>
+constexpr detail::OrElseStep<std::decay_t<F>> or_else(F&& f) {
+	return detail::OrElseStep<std::decay_t<F>>{std::forward<F>(f)};
+}
+
+template <class P>
+constexpr detail::FilterStep<std::decay_t<P>> filter(P&& pred) {
+	return detail::FilterStep<std::decay_t<P>>{std::forward<P>(pred)};
+}
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_OPTIONALPIPELINE_HPP */
@@ -0,0 +1,661 @@
+#ifndef TIM_OPTIONAL_OPTIONALVECTOR_HPP
+#define TIM_OPTIONAL_OPTIONALVECTOR_HPP
+
+#include "tim/optional/Optional.hpp"
+#include "tim/optional/detail/BitOps.hpp"
+#include <type_traits>
+#include <initializer_list>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+namespace tim {
+
+inline namespace optional {
+
+/*
+ * A sequence of optional 'T's stored as a structure of arrays: a dense buffer
+ * of (possibly uninitialized) 'T' slots and a separate presence bitmap with
+ * one bit per slot.  Slots follow the same construction and destruction rules
+ * as 'Optional<T>'; a slot's 'T' is alive exactly when its bit is set.
+ */
+template <class T>
+struct OptionalVector {
+private:
+	static_assert(std::is_object_v<T> && !std::is_array_v<T>,
+		"Instantiating OptionalVector<T> for non-object or array type 'T' is not permitted.");
+	static_assert(std::is_same_v<std::remove_cv_t<T>, T>,
+		"Instantiating OptionalVector<T> for cv-qualified type 'T' is not permitted.");
+	static_assert(!std::is_same_v<T, tim::in_place_t>,
+		"Instantiating OptionalVector<T> where 'T' is 'in_place_t' is not permitted.");
+	static_assert(!std::is_same_v<T, nullopt_t>,
+		"Instantiating OptionalVector<T> where 'T' is 'nullopt_t' is not permitted.");
+
+	template <bool Const>
+	struct PresentIterator;
+
+	template <bool Const>
+	struct PresentRange;
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using const_reference = Optional<const T&>;
+	using iterator = PresentIterator<false>;
+	using const_iterator = PresentIterator<true>;
+
+	/*
+	 * Proxy returned by the non-const 'operator[]'.  Behaves like an
+	 * 'Optional<T>' bound to one slot of the vector.
+	 */
+	struct reference {
+
+		reference(const reference&) = default;
+
+		reference& operator=(const reference& other) {
+			return *this = static_cast<const_reference>(other);
+		}
+
+		reference& operator=(nullopt_t) noexcept {
+			reset();
+			return *this;
+		}
+
+		template <
+			class U = T,
+			std::enable_if_t<
+				std::conjunction_v<
+					std::negation<std::is_same<std::decay_t<U>, nullopt_t>>,
+					std::negation<std::is_same<std::decay_t<U>, reference>>,
+					std::negation<detail::is_optional<std::decay_t<U>>>,
+					std::is_constructible<T, U&&>,
+					std::is_assignable<T&, U&&>
+				>,
+				bool
+			> = false
+		>
+		reference& operator=(U&& v) {
+			if(has_value()) {
+				**this = std::forward<U>(v);
+			} else {
+				emplace(std::forward<U>(v));
+			}
+			return *this;
+		}
+
+		template <
+			class U,
+			std::enable_if_t<
+				std::conjunction_v<
+					std::is_constructible<T, const U&>,
+					std::is_assignable<T&, const U&>
+				>,
+				bool
+			> = false
+		>
+		reference& operator=(const Optional<U>& other) {
+			if(other.has_value()) {
+				*this = *other;
+			} else {
+				reset();
+			}
+			return *this;
+		}
+
+		template <
+			class U,
+			std::enable_if_t<
+				std::conjunction_v<
+					std::is_constructible<T, U&&>,
+					std::is_assignable<T&, U&&>
+				>,
+				bool
+			> = false
+		>
+		reference& operator=(Optional<U>&& other) {
+			if(other.has_value()) {
+				*this = std::move(*other);
+			} else {
+				reset();
+			}
+			return *this;
+		}
+
+		template <class ... Args>
+		T& emplace(Args&& ... args) {
+			return vec_->emplace(index_, std::forward<Args>(args)...);
+		}
+
+		void reset() noexcept {
+			vec_->reset(index_);
+		}
+
+		bool has_value() const noexcept {
+			return vec_->has_value(index_);
+		}
+
+		explicit operator bool() const noexcept {
+			return has_value();
+		}
+
+		T& operator*() const {
+			vec_->assert_has_value(index_);
+			return vec_->values_[index_];
+		}
+
+		T* operator->() const {
+			return std::addressof(**this);
+		}
+
+		T& value() const noexcept(false) {
+			return vec_->value(index_);
+		}
+
+		template <class U>
+		T value_or(U&& v) const {
+			if(has_value()) {
+				return **this;
+			}
+			return static_cast<T>(std::forward<U>(v));
+		}
+
+		operator Optional<T&>() const noexcept {
+			if(has_value()) {
+				return Optional<T&>(**this);
+			}
+			return Optional<T&>();
+		}
+
+		operator const_reference() const noexcept {
+			if(has_value()) {
+				return const_reference(**this);
+			}
+			return const_reference();
+		}
+
+		operator Optional<T>() const {
+			if(has_value()) {
+				return Optional<T>(**this);
+			}
+			return Optional<T>();
+		}
+
+		void swap(reference other) {
+			vec_->swap_slots(index_, *other.vec_, other.index_);
+		}
+
+		friend void swap(reference l, reference r) {
+			l.swap(r);
+		}
+
+	private:
+		friend struct OptionalVector;
+
+		reference(OptionalVector* vec, size_type index) noexcept:
+			vec_(vec),
+			index_(index)
+		{
+
+		}
+
+		OptionalVector* vec_;
+		size_type index_;
+	};
+
+	OptionalVector() noexcept = default;
+
+	explicit OptionalVector(size_type count):
+		OptionalVector()
+	{
+		resize(count);
+	}
+
+	OptionalVector(size_type count, const T& value):
+		OptionalVector()
+	{
+		reserve(count);
+		for(size_type i = 0; i < count; ++i) {
+			emplace_back(value);
+		}
+	}
+
+	OptionalVector(std::initializer_list<Optional<T>> ilist):
+		OptionalVector()
+	{
+		reserve(ilist.size());
+		for(const Optional<T>& v: ilist) {
+			push_back(v);
+		}
+	}
+
+	OptionalVector(const OptionalVector& other):
+		OptionalVector()
+	{
+		static_assert(std::is_copy_constructible_v<T>,
+			"OptionalVector<T> is only copyable if 'T' is copy constructible.");
+		// Delegating: if a copy throws, the destructor cleans up.
+		reallocate(other.size_);
+		size_ = other.size_;
+		for(const_iterator pos = other.present().begin(); pos != const_iterator(); ++pos) {
+			construct(pos.index(), *pos);
+			set_bit(pos.index());
+		}
+	}
+
+	OptionalVector(OptionalVector&& other) noexcept:
+		values_(std::exchange(other.values_, nullptr)),
+		bits_(std::move(other.bits_)),
+		size_(std::exchange(other.size_, 0)),
+		capacity_(std::exchange(other.capacity_, 0))
+	{
+		other.bits_.clear();
+	}
+
+	OptionalVector& operator=(const OptionalVector& other) {
+		if(this != std::addressof(other)) {
+			OptionalVector(other).swap(*this);
+		}
+		return *this;
+	}
+
+	OptionalVector& operator=(OptionalVector&& other) noexcept {
+		OptionalVector(std::move(other)).swap(*this);
+		return *this;
+	}
+
+	~OptionalVector() {
+		clear();
+		deallocate(values_, capacity_);
+	}
+
+	size_type size() const noexcept { return size_; }
+	bool empty() const noexcept { return size_ == 0; }
+	size_type capacity() const noexcept { return capacity_; }
+
+	// Number of engaged slots.
+	size_type count() const noexcept {
+		size_type n = 0;
+		for(std::uint64_t w: bits_) {
+			n += static_cast<size_type>(detail::popcount(w));
+		}
+		return n;
+	}
+
+	void reserve(size_type new_cap) {
+		if(new_cap > capacity_) {
+			reallocate(new_cap);
+		}
+	}
+
+	// Grows with disengaged slots, or shrinks destroying the trailing ones.
+	void resize(size_type new_size) {
+		if(new_size < size_) {
+			truncate(new_size);
+		} else {
+			reserve(new_size);
+			size_ = new_size;
+		}
+	}
+
+	void clear() noexcept {
+		truncate(0);
+	}
+
+	bool has_value(size_type pos) const noexcept {
+		assert_in_range(pos);
+		return (bits_[detail::bitmap_word_index(pos)] & detail::bitmap_bit_mask(pos)) != 0;
+	}
+
+	reference operator[](size_type pos) noexcept {
+		assert_in_range(pos);
+		return reference(this, pos);
+	}
+
+	const_reference operator[](size_type pos) const noexcept {
+		if(has_value(pos)) {
+			return const_reference(values_[pos]);
+		}
+		return const_reference();
+	}
+
+	T& value(size_type pos) noexcept(false) {
+		if(!has_value(pos)) {
+			throw BadOptionalAccess();
+		}
+		return values_[pos];
+	}
+
+	const T& value(size_type pos) const noexcept(false) {
+		if(!has_value(pos)) {
+			throw BadOptionalAccess();
+		}
+		return values_[pos];
+	}
+
+	// As 'Optional<T>::emplace()': destroys any current value first, and
+	// leaves the slot disengaged if construction throws.
+	template <
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, Args&&...>,
+			bool
+		> = false
+	>
+	T& emplace(size_type pos, Args&& ... args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>) {
+		reset(pos);
+		construct(pos, std::forward<Args>(args)...);
+		set_bit(pos);
+		return values_[pos];
+	}
+
+	template <
+		class U,
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, std::initializer_list<U>&, Args&&...>,
+			bool
+		> = false
+	>
+	T& emplace(size_type pos, std::initializer_list<U> ilist, Args&& ... args) noexcept(
+		std::is_nothrow_constructible_v<T, std::initializer_list<U>&, Args&&...>
+	) {
+		reset(pos);
+		construct(pos, ilist, std::forward<Args>(args)...);
+		set_bit(pos);
+		return values_[pos];
+	}
+
+	void reset(size_type pos) noexcept {
+		if(has_value(pos)) {
+			clear_bit(pos);
+			std::destroy_at(values_ + pos);
+		}
+	}
+
+	template <
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, Args&&...>,
+			bool
+		> = false
+	>
+	T& emplace_back(Args&& ... args) {
+		grow_for_append();
+		construct(size_, std::forward<Args>(args)...);
+		set_bit(size_);
+		return values_[size_++];
+	}
+
+	void push_back(nullopt_t) {
+		grow_for_append();
+		++size_;
+	}
+
+	void push_back(const Optional<T>& v) {
+		if(v.has_value()) {
+			emplace_back(*v);
+		} else {
+			push_back(nullopt);
+		}
+	}
+
+	void push_back(Optional<T>&& v) {
+		if(v.has_value()) {
+			emplace_back(std::move(*v));
+		} else {
+			push_back(nullopt);
+		}
+	}
+
+	void pop_back() noexcept {
+		assert_in_range(size_ - 1);
+		truncate(size_ - 1);
+	}
+
+	/*
+	 * The engaged elements, in index order.  Iteration scans the bitmap a
+	 * word at a time, so runs of disengaged slots cost one load per 64.
+	 */
+	PresentRange<false> present() noexcept {
+		return PresentRange<false>{iterator(values_, bits_.data(), bits_.size())};
+	}
+
+	PresentRange<true> present() const noexcept {
+		return PresentRange<true>{const_iterator(values_, bits_.data(), bits_.size())};
+	}
+
+	void swap(OptionalVector& other) noexcept {
+		using std::swap;
+		swap(values_, other.values_);
+		swap(bits_, other.bits_);
+		swap(size_, other.size_);
+		swap(capacity_, other.capacity_);
+	}
+
+private:
+	template <bool Const>
+	struct PresentIterator {
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using reference = std::conditional_t<Const, const T&, T&>;
+		using pointer = std::conditional_t<Const, const T*, T*>;
+
+		// The end iterator.
+		PresentIterator() = default;
+
+		template <bool C = Const, std::enable_if_t<C, bool> = false>
+		PresentIterator(const PresentIterator<false>& other) noexcept:
+			values_(other.values_),
+			words_(other.words_),
+			word_(other.word_),
+			word_count_(other.word_count_),
+			bits_(other.bits_)
+		{
+
+		}
+
+		reference operator*() const { return values_[index()]; }
+		pointer operator->() const { return values_ + index(); }
+
+		// Index of the current element within the vector.
+		size_type index() const noexcept {
+			return word_ * detail::bitmap_word_bits + static_cast<size_type>(detail::countr_zero(bits_));
+		}
+
+		PresentIterator& operator++() noexcept {
+			bits_ &= bits_ - 1u;
+			if(!bits_) {
+				seek();
+			}
+			return *this;
+		}
+
+		PresentIterator operator++(int) noexcept {
+			auto cpy = *this;
+			++*this;
+			return cpy;
+		}
+
+		friend bool operator==(const PresentIterator& l, const PresentIterator& r) noexcept {
+			return l.bits_ == r.bits_ && (!l.bits_ || l.word_ == r.word_);
+		}
+
+		friend bool operator!=(const PresentIterator& l, const PresentIterator& r) noexcept {
+			return !(l == r);
+		}
+
+	private:
+		friend struct OptionalVector;
+		friend struct PresentIterator<true>;
+
+		PresentIterator(pointer values, const std::uint64_t* words, size_type word_count) noexcept:
+			values_(values),
+			words_(words),
+			word_(0),
+			word_count_(word_count),
+			bits_(word_count ? words[0] : 0u)
+		{
+			if(!bits_) {
+				seek();
+			}
+		}
+
+		// Advances to the next nonzero word, leaving 'bits_' zero at the end.
+		void seek() noexcept {
+			while(++word_ < word_count_) {
+				if((bits_ = words_[word_]) != 0u) {
+					return;
+				}
+			}
+		}
+
+		pointer values_ = nullptr;
+		const std::uint64_t* words_ = nullptr;
+		size_type word_ = 0;
+		size_type word_count_ = 0;
+		std::uint64_t bits_ = 0;
+	};
+
+	template <bool Const>
+	struct PresentRange {
+		PresentIterator<Const> begin() const noexcept { return first_; }
+		PresentIterator<Const> end() const noexcept { return PresentIterator<Const>(); }
+
+		PresentIterator<Const> first_;
+	};
+
+	static T* allocate(size_type n) {
+		return n ? std::allocator<T>().allocate(n) : nullptr;
+	}
+
+	static void deallocate(T* p, size_type n) noexcept {
+		if(p) {
+			std::allocator<T>().deallocate(p, n);
+		}
+	}
+
+	template <class ... Args>
+	void construct(size_type pos, Args&& ... args) {
+		::new (static_cast<void*>(values_ + pos)) T(std::forward<Args>(args)...);
+	}
+
+	void set_bit(size_type pos) noexcept {
+		bits_[detail::bitmap_word_index(pos)] |= detail::bitmap_bit_mask(pos);
+	}
+
+	void clear_bit(size_type pos) noexcept {
+		bits_[detail::bitmap_word_index(pos)] &= ~detail::bitmap_bit_mask(pos);
+	}
+
+	void grow_for_append() {
+		if(size_ == capacity_) {
+			reallocate(capacity_ ? 2 * capacity_ : 1);
+		}
+	}
+
+	// Moves the engaged slots into a buffer of 'new_cap' slots.  Relocatable
+	// payloads are copied in one go; otherwise this gives the strong
+	// guarantee whenever 'T' is nothrow-movable or copyable.
+	void reallocate(size_type new_cap) {
+		T* values = allocate(new_cap);
+		auto guard = detail::make_manual_scope_guard([&]() { deallocate(values, new_cap); });
+		std::vector<std::uint64_t> bits(detail::bitmap_word_count(new_cap), 0u);
+		if constexpr(is_trivially_relocatable_v<T>) {
+			if(size_) {
+				std::memcpy(static_cast<void*>(values), static_cast<const void*>(values_), size_ * sizeof(T));
+			}
+		} else {
+			iterator pos = present().begin();
+			auto undo = detail::make_manual_scope_guard([&]() {
+				for(iterator p = present().begin(); p != pos; ++p) {
+					std::destroy_at(values + p.index());
+				}
+			});
+			for(; pos != iterator(); ++pos) {
+				::new (static_cast<void*>(values + pos.index())) T(std::move_if_noexcept(*pos));
+			}
+			undo.active = false;
+			for(T& v: present()) {
+				std::destroy_at(std::addressof(v));
+			}
+		}
+		guard.active = false;
+		std::copy(bits_.begin(), bits_.end(), bits.begin());
+		deallocate(values_, capacity_);
+		values_ = values;
+		bits_ = std::move(bits);
+		capacity_ = new_cap;
+	}
+
+	// Destroys the engaged slots at or after 'new_size' and shrinks to it.
+	void truncate(size_type new_size) noexcept {
+		if constexpr(!std::is_trivially_destructible_v<T>) {
+			for(size_type w = detail::bitmap_word_index(new_size); w < detail::bitmap_word_count(size_); ++w) {
+				std::uint64_t word = bits_[w];
+				if(w == detail::bitmap_word_index(new_size)) {
+					word &= ~detail::bitmap_low_mask(new_size % detail::bitmap_word_bits);
+				}
+				for(; word; word &= word - 1u) {
+					std::destroy_at(values_ + (w * detail::bitmap_word_bits + detail::countr_zero(word)));
+				}
+			}
+		}
+		const size_type first_word = detail::bitmap_word_index(new_size);
+		const size_type last_word = detail::bitmap_word_count(size_);
+		if(first_word < last_word) {
+			bits_[first_word] &= detail::bitmap_low_mask(new_size % detail::bitmap_word_bits);
+			std::fill(bits_.begin() + first_word + 1, bits_.begin() + last_word, 0u);
+		}
+		size_ = new_size;
+	}
+
+	void swap_slots(size_type pos, OptionalVector& other, size_type other_pos) {
+		if(has_value(pos)) {
+			if(other.has_value(other_pos)) {
+				using std::swap;
+				swap(values_[pos], other.values_[other_pos]);
+			} else {
+				other.emplace(other_pos, std::move(values_[pos]));
+				reset(pos);
+			}
+		} else if(other.has_value(other_pos)) {
+			emplace(pos, std::move(other.values_[other_pos]));
+			other.reset(other_pos);
+		}
+	}
+
+	void assert_in_range([[maybe_unused]] size_type pos) const noexcept {
+#if defined(assert) && !defined(TIM_OPTIONAL_OPTIONAL_DISABLE_ASSERTIONS)
+		assert(pos < size_);
+#endif
+	}
+
+	void assert_has_value([[maybe_unused]] size_type pos) const noexcept {
+#if defined(assert) && !defined(TIM_OPTIONAL_OPTIONAL_DISABLE_ASSERTIONS)
+		assert(has_value(pos));
+#endif
+	}
+
+	T* values_ = nullptr;
+	std::vector<std::uint64_t> bits_;
+	size_type size_ = 0;
+	size_type capacity_ = 0;
+};
+
+template <class T>
+void swap(OptionalVector<T>& l, OptionalVector<T>& r) noexcept {
+	l.swap(r);
+}
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_OPTIONALVECTOR_HPP */
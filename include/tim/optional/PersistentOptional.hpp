@@ -0,0 +1,264 @@
+#ifndef TIM_OPTIONAL_PERSISTENTOPTIONAL_HPP
+#define TIM_OPTIONAL_PERSISTENTOPTIONAL_HPP
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace tim {
+
+inline namespace optional {
+
+namespace detail {
+
+// Writes the pages spanning [data, data + size) of a file mapping back to the
+// file, and waits for the write to finish.
+inline void persist_range(const void* data, std::size_t size) {
+	static const auto page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+	const auto begin = reinterpret_cast<std::uintptr_t>(data) & ~(page - 1u);
+	const auto end = reinterpret_cast<std::uintptr_t>(data) + size;
+	if(::msync(reinterpret_cast<void*>(begin), end - begin, MS_SYNC) != 0) {
+		throw std::system_error(errno, std::generic_category(), "msync");
+	}
+}
+
+// 64-bit FNV-1a.  The offset basis is nonzero, so all-zero (never written)
+// memory does not checksum to its own zero checksum field.
+inline std::uint64_t persist_checksum(const unsigned char* bytes, std::size_t size) noexcept {
+	std::uint64_t h = 0xcbf29ce484222325u;
+	for(std::size_t i = 0; i < size; ++i) {
+		h ^= bytes[i];
+		h *= 0x100000001b3u;
+	}
+	return h;
+}
+
+} /* namespace detail */
+
+template <class T>
+class PersistentOptionalArray;
+
+/*
+ * The on-disk layout of one crash-consistent optional 'T', for arrays of them
+ * in memory-mapped files.  It holds no pointers and is valid at whatever
+ * address the file is mapped.
+ *
+ * A slot holds a value only if its flag carries the committed marker and its
+ * checksum matches its payload.  'store()' takes the slot out of that state,
+ * writes the payload and checksum, flushes them to the file, and only then
+ * sets the flag (and flushes again), so a crash at any point leaves either
+ * the old value, the new value, or a slot that 'recover()' will discard.
+ *
+ * Slots are not for concurrent use; see SharedMemoryOptional for that.
+ */
+template <class T>
+class PersistentOptional {
+	static_assert(std::is_same_v<std::remove_cv_t<T>, T> && std::is_object_v<T>,
+		"PersistentOptional<T> requires a cv-unqualified object type.");
+	static_assert(std::is_trivially_copyable_v<T>,
+		"PersistentOptional<T> requires a trivially copyable T.");
+	static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+		"PersistentOptional<T> requires lock-free 64-bit atomics.");
+
+	friend class PersistentOptionalArray<T>;
+
+	static constexpr std::uint64_t committed = 0x54494d4f50544c31u;
+
+public:
+	using value_type = T;
+
+	// A fresh slot is empty, as is a zero-filled one.
+	PersistentOptional() noexcept = default;
+
+	PersistentOptional(const PersistentOptional&) = delete;
+	PersistentOptional& operator=(const PersistentOptional&) = delete;
+
+	// Whether the slot is committed and intact, i.e. whether 'load()' returns
+	// a value.
+	bool has_value() const noexcept {
+		return valid();
+	}
+
+	// Whether the flag is set, regardless of the payload.  Differs from
+	// 'has_value()' only for a slot left behind by a crash that 'recover()'
+	// has not discarded yet.
+	bool is_committed() const noexcept {
+		return flag_.load(std::memory_order_acquire) == committed;
+	}
+
+	// The value if the slot is committed and intact.
+	Optional<T> load() const noexcept {
+		if(!valid()) {
+			return nullopt;
+		}
+		alignas(T) unsigned char storage[sizeof(T)];
+		std::memcpy(storage, payload_, sizeof(T));
+		return Optional<T>(*std::launder(reinterpret_cast<const T*>(storage)));
+	}
+
+	// Empties the slot if it is not committed and intact.  Returns whether it
+	// holds a value.
+	bool recover() {
+		if(discard_if_invalid()) {
+			detail::persist_range(this, sizeof(*this));
+		}
+		return has_value();
+	}
+
+	void store(const T& value) {
+		stage(std::addressof(value));
+		detail::persist_range(this, sizeof(*this));
+		publish();
+		detail::persist_range(this, sizeof(*this));
+	}
+
+	void store(const Optional<T>& value) {
+		if(value.has_value()) {
+			store(*value);
+		} else {
+			reset();
+		}
+	}
+
+	void reset() {
+		stage(nullptr);
+		detail::persist_range(this, sizeof(*this));
+	}
+
+private:
+	bool valid() const noexcept {
+		return is_committed() && checksum_.load(std::memory_order_relaxed) == detail::persist_checksum(payload_, sizeof(T));
+	}
+
+	// Clears the flag of a slot that is not committed and intact.  Returns
+	// whether there was anything to clear.  Nothing is flushed.
+	bool discard_if_invalid() noexcept {
+		if(valid() || flag_.load(std::memory_order_relaxed) == 0u) {
+			return false;
+		}
+		flag_.store(0u, std::memory_order_release);
+		return true;
+	}
+
+	// Uncommits the slot and, if 'value' is not null, writes its payload and
+	// checksum.  Nothing is flushed.
+	void stage(const T* value) noexcept {
+		flag_.store(0u, std::memory_order_release);
+		if(value) {
+			std::memcpy(payload_, value, sizeof(T));
+			checksum_.store(detail::persist_checksum(payload_, sizeof(T)), std::memory_order_release);
+		}
+	}
+
+	void publish() noexcept {
+		flag_.store(committed, std::memory_order_release);
+	}
+
+	std::atomic<std::uint64_t> flag_{0};
+	std::atomic<std::uint64_t> checksum_{0};
+	alignas(T) unsigned char payload_[sizeof(T)] = {};
+};
+
+/*
+ * A view of 'size' PersistentOptional<T> slots in a mapped file.  'commit()'
+ * writes many slots with two flushes in total instead of two per slot.
+ */
+template <class T>
+class PersistentOptionalArray {
+public:
+	using value_type = T;
+	using slot_type = PersistentOptional<T>;
+	using size_type = std::size_t;
+
+	PersistentOptionalArray(slot_type* slots, size_type size) noexcept:
+		slots_(slots),
+		size_(size)
+	{
+
+	}
+
+	// Views 'region' (for instance, a mapping of the file) as an array of as
+	// many slots as fit.  An all-zero region is an array of empty slots.
+	static PersistentOptionalArray from_region(void* region, std::size_t bytes) noexcept {
+		assert(reinterpret_cast<std::uintptr_t>(region) % alignof(slot_type) == 0);
+		return PersistentOptionalArray(std::launder(static_cast<slot_type*>(region)), bytes / sizeof(slot_type));
+	}
+
+	size_type size() const noexcept {
+		return size_;
+	}
+
+	slot_type& operator[](size_type pos) noexcept {
+		assert(pos < size_);
+		return slots_[pos];
+	}
+
+	const slot_type& operator[](size_type pos) const noexcept {
+		assert(pos < size_);
+		return slots_[pos];
+	}
+
+	Optional<T> load(size_type pos) const noexcept {
+		return (*this)[pos].load();
+	}
+
+	// Discards every slot left half-written by a crash.  Returns the number of
+	// slots discarded.
+	size_type recover() {
+		size_type discarded = 0;
+		for(size_type i = 0; i < size_; ++i) {
+			if(slots_[i].discard_if_invalid()) {
+				++discarded;
+			}
+		}
+		if(discarded) {
+			detail::persist_range(slots_, size_ * sizeof(slot_type));
+		}
+		return discarded;
+	}
+
+	/*
+	 * Stores 'values[0, count)' into slots '[first, first + count)': every
+	 * payload and checksum is written and flushed before any flag is set, and
+	 * the flags are then flushed together.  After a crash, each slot holds its
+	 * old value, its new value, or nothing.
+	 */
+	void commit(size_type first, const Optional<T>* values, size_type count) {
+		assert(first <= size_ && count <= size_ - first);
+		if(count == 0) {
+			return;
+		}
+		slot_type* slots = slots_ + first;
+		for(size_type i = 0; i < count; ++i) {
+			slots[i].stage(values[i].has_value() ? std::addressof(*values[i]) : nullptr);
+		}
+		detail::persist_range(slots, count * sizeof(slot_type));
+		for(size_type i = 0; i < count; ++i) {
+			if(values[i].has_value()) {
+				slots[i].publish();
+			}
+		}
+		detail::persist_range(slots, count * sizeof(slot_type));
+	}
+
+private:
+	slot_type* slots_;
+	size_type size_;
+};
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_PERSISTENTOPTIONAL_HPP */
@@ -0,0 +1,273 @@
+#ifndef TIM_OPTIONAL_POOLALLOCATOR_HPP
+#define TIM_OPTIONAL_POOLALLOCATOR_HPP
+
+#include <type_traits>
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <cstddef>
+
+namespace tim {
+
+inline namespace optional {
+
+namespace detail {
+
+// Pooled blocks are multiples of 'pool_granularity' bytes, from
+// 'pool_min_block' up to 'pool_max_block'.
+inline constexpr std::size_t pool_granularity = 16;
+inline constexpr std::size_t pool_min_block = 32;
+inline constexpr std::size_t pool_max_block = 4096;
+
+// The size of the blocks that hold an object of 'size' bytes.
+constexpr std::size_t pool_size_class(std::size_t size) noexcept {
+	return std::max(pool_min_block, (size + pool_granularity - 1u) / pool_granularity * pool_granularity);
+}
+
+/*
+ * A pool of 'BlockSize'-byte blocks, shared by every type whose objects round
+ * up to that size.  Blocks are carved from 64 KiB chunks, which are never
+ * returned to the system.
+ *
+ * Each thread allocates from and frees into its own free list without
+ * locking.  A list that grows past two chunks' worth, or whose thread exits,
+ * is handed to a shared stash, from which threads that run out take whole
+ * lists; the mutex is only taken once per list.  Once a thread's list is gone
+ * (objects destroyed after it at thread or program exit), that thread takes
+ * and returns single blocks through the stash instead.
+ */
+template <std::size_t BlockSize>
+class SizeClassPool {
+	static_assert(BlockSize % pool_granularity == 0 && BlockSize >= pool_min_block,
+		"SizeClassPool<BlockSize> requires a size class.");
+
+	// A free block.  The first block of a list in the stash also links the
+	// next list and records its own list's length.
+	struct Block {
+		Block* next;
+		Block* next_list;
+		std::size_t length;
+	};
+
+	static constexpr std::size_t blocks_per_chunk = std::max<std::size_t>(64u * 1024u / BlockSize, 16u);
+	static constexpr std::size_t cache_limit = 2u * blocks_per_chunk;
+
+	struct Stash {
+		std::mutex mutex;
+		Block* lists = nullptr;
+	};
+
+	struct Cache {
+		Cache() = default;
+		Cache(const Cache&) = delete;
+		Cache& operator=(const Cache&) = delete;
+
+		~Cache() {
+			give_back(*this);
+			cache_destroyed() = true;
+		}
+
+		Block* head = nullptr;
+		std::size_t length = 0;
+	};
+
+public:
+	static constexpr std::size_t block_size = BlockSize;
+
+	static void* allocate() {
+		if(cache_destroyed()) {
+			return take_one();
+		}
+		Cache& cache = local_cache();
+		if(!cache.head) {
+			refill(cache);
+		}
+		Block* block = cache.head;
+		cache.head = block->next;
+		--cache.length;
+		return block;
+	}
+
+	static void deallocate(void* p) noexcept {
+		if(cache_destroyed()) {
+			give_back_one(p);
+			return;
+		}
+		Cache& cache = local_cache();
+		cache.head = ::new (p) Block{cache.head, nullptr, 0};
+		if(++cache.length >= cache_limit) {
+			give_back(cache);
+		}
+	}
+
+private:
+	static Cache& local_cache() noexcept {
+		thread_local Cache cache;
+		return cache;
+	}
+
+	// Set when the calling thread's cache has been destroyed.  Trivially
+	// destructible, so it can still be read after that.
+	static bool& cache_destroyed() noexcept {
+		thread_local bool destroyed = false;
+		return destroyed;
+	}
+
+	// Never destroyed, so that blocks can still be freed during static
+	// destruction.
+	static Stash& stash() noexcept {
+		static Stash* const s = new Stash();
+		return *s;
+	}
+
+	static void give_back(Cache& cache) noexcept {
+		if(!cache.head) {
+			return;
+		}
+		Stash& s = stash();
+		cache.head->length = cache.length;
+		{
+			std::lock_guard<std::mutex> lock(s.mutex);
+			cache.head->next_list = s.lists;
+			s.lists = cache.head;
+		}
+		cache.head = nullptr;
+		cache.length = 0;
+	}
+
+	// Pushes the single block 'p' onto the stash, as a list of its own.
+	static void give_back_one(void* p) noexcept {
+		Stash& s = stash();
+		Block* block = ::new (p) Block{nullptr, nullptr, 1u};
+		std::lock_guard<std::mutex> lock(s.mutex);
+		block->next_list = s.lists;
+		s.lists = block;
+	}
+
+	// Takes a single block from the stash, topping it up from a new chunk if
+	// it is empty.
+	static void* take_one() {
+		Stash& s = stash();
+		std::unique_lock<std::mutex> lock(s.mutex);
+		if(!s.lists) {
+			lock.unlock();
+			Block* chunk = new_chunk();
+			lock.lock();
+			chunk->length = blocks_per_chunk;
+			chunk->next_list = s.lists;
+			s.lists = chunk;
+		}
+		Block* list = s.lists;
+		if(Block* rest = list->next) {
+			rest->length = list->length - 1u;
+			rest->next_list = list->next_list;
+			s.lists = rest;
+		} else {
+			s.lists = list->next_list;
+		}
+		return list;
+	}
+
+	// Carves a new chunk into a list of 'blocks_per_chunk' free blocks.
+	static Block* new_chunk() {
+		auto* chunk = static_cast<unsigned char*>(::operator new(blocks_per_chunk * BlockSize));
+		Block* head = nullptr;
+		for(std::size_t i = blocks_per_chunk; i-- > 0u;) {
+			head = ::new (static_cast<void*>(chunk + i * BlockSize)) Block{head, nullptr, 0};
+		}
+		return head;
+	}
+
+	static void refill(Cache& cache) {
+		Stash& s = stash();
+		{
+			std::lock_guard<std::mutex> lock(s.mutex);
+			if(Block* list = s.lists) {
+				s.lists = list->next_list;
+				cache.head = list;
+				cache.length = list->length;
+				return;
+			}
+		}
+		cache.head = new_chunk();
+		cache.length = blocks_per_chunk;
+	}
+};
+
+} /* namespace detail */
+
+/*
+ * A stateless allocator that serves single objects of up to 4 KiB from
+ * per-size-class pools (see detail::SizeClassPool), and everything else
+ * (arrays, larger or over-aligned types) from operator new.  All instances
+ * compare equal, and memory may be freed on any thread.
+ */
+template <class T>
+class PoolAllocator {
+public:
+	using value_type = T;
+	using is_always_equal = std::true_type;
+
+	// Whether single objects come from a pool, and the size of their blocks.
+	static constexpr bool pooled = sizeof(T) <= detail::pool_max_block
+		&& alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__
+		&& alignof(T) <= detail::pool_granularity;
+	static constexpr std::size_t block_size = pooled ? detail::pool_size_class(sizeof(T)) : sizeof(T);
+
+	PoolAllocator() noexcept = default;
+
+	template <class U>
+	PoolAllocator(const PoolAllocator<U>&) noexcept {
+
+	}
+
+	T* allocate(std::size_t n) {
+		if constexpr(pooled) {
+			if(n == 1u) {
+				return static_cast<T*>(pool_type::allocate());
+			}
+		}
+		if(n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+			throw std::bad_array_new_length();
+		}
+		if constexpr(alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+			return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+		} else {
+			return static_cast<T*>(::operator new(n * sizeof(T)));
+		}
+	}
+
+	void deallocate(T* p, std::size_t n) noexcept {
+		if constexpr(pooled) {
+			if(n == 1u) {
+				pool_type::deallocate(p);
+				return;
+			}
+		}
+		if constexpr(alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+			::operator delete(p, std::align_val_t(alignof(T)));
+		} else {
+			::operator delete(p);
+		}
+	}
+
+private:
+	using pool_type = detail::SizeClassPool<detail::pool_size_class(pooled ? sizeof(T) : 1u)>;
+};
+
+template <class T, class U>
+constexpr bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {
+	return true;
+}
+
+template <class T, class U>
+constexpr bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {
+	return false;
+}
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_POOLALLOCATOR_HPP */
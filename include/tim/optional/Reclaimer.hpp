@@ -0,0 +1,329 @@
+#ifndef TIM_OPTIONAL_RECLAIMER_HPP
+#define TIM_OPTIONAL_RECLAIMER_HPP
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace tim {
+
+inline namespace optional {
+
+namespace detail {
+
+// One retired object, relocated into a cache line along with its destructor.
+struct alignas(64) RetiredObject {
+	static constexpr std::size_t capacity = 48;
+	static constexpr std::size_t alignment = 16;
+
+	using destroy_fn = void (*)(void*) noexcept;
+
+	template <class T>
+	static void destroy(void* p) noexcept {
+		std::destroy_at(std::launder(static_cast<T*>(p)));
+	}
+
+	destroy_fn destroy_payload;
+	alignas(alignment) unsigned char bytes[capacity];
+};
+
+/*
+ * A single-producer, single-consumer ring of retired objects.  The producer
+ * is whichever thread currently holds the queue (see 'attached'); the
+ * consumer is the reclaimer's thread.
+ */
+class RetireQueue {
+public:
+	explicit RetireQueue(std::size_t capacity):
+		mask_(capacity - 1u),
+		slots_(new RetiredObject[capacity])
+	{
+
+	}
+
+	~RetireQueue() {
+		drain();
+	}
+
+	// Relocates '*value' into the queue.  Returns false, leaving '*value'
+	// alone, if the queue is full.
+	template <class T>
+	bool try_push(T* value) noexcept {
+		std::size_t head = head_.load(std::memory_order_relaxed);
+		if(head - cached_tail_ > mask_) {
+			cached_tail_ = tail_.load(std::memory_order_acquire);
+			if(head - cached_tail_ > mask_) {
+				return false;
+			}
+		}
+		RetiredObject& slot = slots_[head & mask_];
+		relocate_at(value, reinterpret_cast<T*>(slot.bytes));
+		slot.destroy_payload = &RetiredObject::destroy<T>;
+		head_.store(head + 1u, std::memory_order_release);
+		return true;
+	}
+
+	// Destroys everything pushed so far.  Consumer only.
+	std::size_t drain() noexcept {
+		std::size_t tail = tail_.load(std::memory_order_relaxed);
+		const std::size_t head = head_.load(std::memory_order_acquire);
+		const std::size_t count = head - tail;
+		for(; tail != head; ++tail) {
+			RetiredObject& slot = slots_[tail & mask_];
+			slot.destroy_payload(slot.bytes);
+		}
+		tail_.store(tail, std::memory_order_release);
+		return count;
+	}
+
+	// Whether a thread is currently pushing to this queue.
+	std::atomic<bool> attached{true};
+
+private:
+	const std::size_t mask_;
+	std::unique_ptr<RetiredObject[]> slots_;
+	alignas(64) std::atomic<std::size_t> head_{0};
+	std::size_t cached_tail_ = 0;
+	alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+// Set when the calling thread's queues have been destroyed.  Trivially
+// destructible, so it can still be read after that.
+inline bool& thread_retire_queues_destroyed() noexcept {
+	thread_local bool destroyed = false;
+	return destroyed;
+}
+
+// The calling thread's queues, one per reclaimer it has retired into.  They
+// are handed back when the thread exits, for another thread to reuse.
+struct ThreadRetireQueues {
+	ThreadRetireQueues() = default;
+	ThreadRetireQueues(const ThreadRetireQueues&) = delete;
+	ThreadRetireQueues& operator=(const ThreadRetireQueues&) = delete;
+
+	~ThreadRetireQueues() {
+		for(auto& entry: entries) {
+			entry.second->attached.store(false, std::memory_order_release);
+		}
+		thread_retire_queues_destroyed() = true;
+	}
+
+	std::vector<std::pair<std::uint64_t, std::shared_ptr<RetireQueue>>> entries;
+};
+
+inline ThreadRetireQueues& thread_retire_queues() {
+	thread_local ThreadRetireQueues queues;
+	return queues;
+}
+
+} /* namespace detail */
+
+/*
+ * Destroys retired objects on a background thread, off the threads that
+ * retire them.
+ *
+ * 'retire(p)' relocates '*p' into a bounded, lock-free queue owned by the
+ * calling thread and returns; the reclaimer's thread drains the queues every
+ * 'interval' and runs the destructors.  Use it through
+ * 'opt.reset(tim::defer_to(reclaimer))', which empties an Optional in
+ * constant time whatever its payload.
+ *
+ * Memory is bounded by 'queue_capacity' 64-byte entries per thread.  Objects
+ * that do not fit an entry (larger than 48 bytes or more than 16-byte
+ * aligned), that cannot be relocated without throwing, or that arrive while
+ * the thread's queue is full are destroyed inline instead, as are objects
+ * retired by a thread_local destroyed after the thread's queues.
+ *
+ * Retiring into a reclaimer that is being destroyed is not allowed.
+ */
+class Reclaimer {
+public:
+	// 'queue_capacity' is rounded up to a power of two.
+	explicit Reclaimer(
+		std::size_t queue_capacity = 1024,
+		std::chrono::microseconds interval = std::chrono::milliseconds(1)
+	):
+		id_(next_id()),
+		queue_capacity_(round_capacity(queue_capacity)),
+		interval_(interval),
+		thread_([this]() { run(); })
+	{
+
+	}
+
+	Reclaimer(const Reclaimer&) = delete;
+	Reclaimer& operator=(const Reclaimer&) = delete;
+
+	~Reclaimer() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		wake_.notify_one();
+		thread_.join();
+		// The thread may have stopped short of objects retired just before.
+		for(auto& queue: queues_) {
+			queue->drain();
+		}
+	}
+
+	// Whether 'retire<T>()' can defer a 'T' rather than destroy it inline.
+	template <class T>
+	static constexpr bool can_defer() noexcept {
+		return sizeof(T) <= detail::RetiredObject::capacity
+			&& alignof(T) <= detail::RetiredObject::alignment
+			&& (is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>);
+	}
+
+	// Takes over '*value', ending its lifetime at that address, and destroys
+	// it later on the reclaimer's thread.
+	template <class T>
+	void retire(T* value) noexcept {
+		static_assert(std::is_nothrow_destructible_v<T>,
+			"Reclaimer::retire() requires a nothrow destructible T.");
+		if constexpr(std::is_trivially_destructible_v<T>) {
+			static_cast<void>(value);
+		} else if constexpr(can_defer<T>()) {
+			detail::RetireQueue* queue = local_queue();
+			if(!queue || !queue->try_push(value)) {
+				std::destroy_at(value);
+			}
+		} else {
+			std::destroy_at(value);
+		}
+	}
+
+	// Blocks until every object retired (by any thread) before the call has
+	// been destroyed.
+	void flush() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		// The pass in progress, if any, may have passed over some queues already.
+		const std::uint64_t target = passes_ + 2u;
+		++flush_waiters_;
+		wake_.notify_one();
+		done_.wait(lock, [&]() { return passes_ >= target; });
+		--flush_waiters_;
+	}
+
+	// The number of objects destroyed on the reclaimer's thread so far.
+	std::uint64_t reclaimed() const noexcept {
+		return reclaimed_.load(std::memory_order_relaxed);
+	}
+
+private:
+	static std::uint64_t next_id() noexcept {
+		static std::atomic<std::uint64_t> id{0};
+		return id.fetch_add(1u, std::memory_order_relaxed) + 1u;
+	}
+
+	static std::size_t round_capacity(std::size_t capacity) noexcept {
+		std::size_t n = 2;
+		while(n < capacity) {
+			n *= 2u;
+		}
+		return n;
+	}
+
+	// Null once the thread's queues have been destroyed.
+	detail::RetireQueue* local_queue() noexcept {
+		if(detail::thread_retire_queues_destroyed()) {
+			return nullptr;
+		}
+		auto& entries = detail::thread_retire_queues().entries;
+		for(auto& entry: entries) {
+			if(entry.first == id_) {
+				return entry.second.get();
+			}
+		}
+		return attach_queue();
+	}
+
+	// Slow path: the calling thread's first retirement into this reclaimer.
+	// Reuses the queue of a thread that has exited if there is one.
+	detail::RetireQueue* attach_queue() noexcept {
+		try {
+			auto& entries = detail::thread_retire_queues().entries;
+			// Drop queues whose reclaimers are gone.
+			entries.erase(
+				std::remove_if(entries.begin(), entries.end(), [](const auto& entry) { return entry.second.use_count() == 1; }),
+				entries.end()
+			);
+			entries.reserve(entries.size() + 1u);
+			std::lock_guard<std::mutex> lock(mutex_);
+			std::shared_ptr<detail::RetireQueue> queue;
+			for(auto& q: queues_) {
+				if(!q->attached.load(std::memory_order_acquire)) {
+					q->attached.store(true, std::memory_order_relaxed);
+					queue = q;
+					break;
+				}
+			}
+			if(!queue) {
+				queue = std::make_shared<detail::RetireQueue>(queue_capacity_);
+				queues_.push_back(queue);
+				++queues_version_;
+			}
+			entries.emplace_back(id_, std::move(queue));
+			return entries.back().second.get();
+		} catch(...) {
+			return nullptr;
+		}
+	}
+
+	void run() {
+		std::vector<std::shared_ptr<detail::RetireQueue>> queues;
+		std::uint64_t version = 0;
+		std::unique_lock<std::mutex> lock(mutex_);
+		for(;;) {
+			if(version != queues_version_) {
+				queues = queues_;
+				version = queues_version_;
+			}
+			const bool stop = stop_;
+			lock.unlock();
+			std::size_t count = 0;
+			for(auto& queue: queues) {
+				count += queue->drain();
+			}
+			reclaimed_.fetch_add(count, std::memory_order_relaxed);
+			lock.lock();
+			++passes_;
+			done_.notify_all();
+			if(stop) {
+				return;
+			}
+			wake_.wait_for(lock, interval_, [&]() { return stop_ || flush_waiters_ > 0; });
+		}
+	}
+
+	const std::uint64_t id_;
+	const std::size_t queue_capacity_;
+	const std::chrono::microseconds interval_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable done_;
+	std::vector<std::shared_ptr<detail::RetireQueue>> queues_;
+	std::uint64_t queues_version_ = 0;
+	std::uint64_t passes_ = 0;
+	unsigned flush_waiters_ = 0;
+	bool stop_ = false;
+	std::atomic<std::uint64_t> reclaimed_{0};
+	std::thread thread_;
+};
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_RECLAIMER_HPP */
@@ -0,0 +1,286 @@
+#ifndef TIM_OPTIONAL_RECYCLINGOPTIONAL_HPP
+#define TIM_OPTIONAL_RECYCLINGOPTIONAL_HPP
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <memory>
+#include <new>
+#include <utility>
+#include <cassert>
+
+namespace tim {
+
+inline namespace optional {
+
+/*
+ * How RecyclingOptional<T> empties a 'T' without destroying it.  By default,
+ * types with both 'clear()' and 'empty()' members (the standard containers
+ * and strings) are recycled by calling 'clear()'.  A 'clear()' alone is not
+ * enough: std::stringstream's only resets the error state.  Specialize this
+ * for other types; a specialization provides 'can_recycle' and, when that is
+ * true, 'clear(T&)'.
+ */
+template <class T, class = void>
+struct recycle_traits {
+	static constexpr bool can_recycle = false;
+};
+
+template <class T>
+struct recycle_traits<T, std::void_t<
+	decltype(std::declval<T&>().clear()),
+	std::enable_if_t<std::is_convertible_v<decltype(std::declval<const T&>().empty()), bool>>
+>> {
+	static constexpr bool can_recycle = true;
+
+	static void clear(T& value) noexcept(noexcept(value.clear())) {
+		value.clear();
+		assert(value.empty());
+	}
+};
+
+/*
+ * An optional 'T' for per-request scratch space that keeps its payload alive
+ * when emptied, so that the memory the payload owns is reused rather than
+ * freed and allocated again.
+ *
+ * 'reset()' calls 'recycle_traits<T>::clear()' and marks this empty; the
+ * cleared object stays behind.  Re-engaging then reuses it: 'emplace()' with
+ * no arguments engages the cleared object as is, and 'assign(u)' (or
+ * 'emplace(u)', or '= u') assigns 'u' to it.  Other 'emplace()' calls, and
+ * every call for types that cannot be recycled, destroy and construct as
+ * Optional<T> does.  'release()' destroys the kept object.
+ *
+ * It is meant to stay in place inside the structure that owns it, so it can be
+ * neither copied nor moved.
+ */
+template <class T>
+class RecyclingOptional {
+	static_assert(std::is_object_v<T> && !std::is_array_v<T>,
+		"RecyclingOptional<T> requires a non-array object type.");
+	static_assert(std::is_nothrow_destructible_v<T>,
+		"RecyclingOptional<T> requires a nothrow destructible T.");
+
+	using traits_type = recycle_traits<T>;
+	using wrapper_type = detail::ValueWrapper<T>;
+
+public:
+	using value_type = T;
+
+	RecyclingOptional() noexcept:
+		storage_(detail::empty_tag)
+	{
+
+	}
+
+	RecyclingOptional(nullopt_t) noexcept:
+		RecyclingOptional()
+	{
+
+	}
+
+	template <class ... Args>
+	explicit RecyclingOptional(in_place_t, Args&& ... args):
+		RecyclingOptional()
+	{
+		construct(std::forward<Args>(args)...);
+	}
+
+	RecyclingOptional(const RecyclingOptional&) = delete;
+	RecyclingOptional& operator=(const RecyclingOptional&) = delete;
+
+	~RecyclingOptional() {
+		release();
+	}
+
+	bool has_value() const noexcept {
+		return engaged_;
+	}
+
+	explicit operator bool() const noexcept {
+		return engaged_;
+	}
+
+	// Whether a 'T' is alive in the storage, engaged or not.
+	bool holds_storage() const noexcept {
+		return alive_;
+	}
+
+	T& operator*() & noexcept { return value_ref(); }
+	const T& operator*() const & noexcept { return value_ref(); }
+
+	T* operator->() noexcept { return std::addressof(value_ref()); }
+	const T* operator->() const noexcept { return std::addressof(value_ref()); }
+
+	T& value() & {
+		if(!engaged_) {
+			throw BadOptionalAccess();
+		}
+		return value_ref();
+	}
+
+	const T& value() const & {
+		if(!engaged_) {
+			throw BadOptionalAccess();
+		}
+		return value_ref();
+	}
+
+	// A view of the value, as an Optional<T&>.
+	Optional<T&> get() noexcept {
+		if(engaged_) {
+			return Optional<T&>(value_ref());
+		}
+		return nullopt;
+	}
+
+	Optional<const T&> get() const noexcept {
+		if(engaged_) {
+			return Optional<const T&>(value_ref());
+		}
+		return nullopt;
+	}
+
+	// Empties this, keeping a cleared 'T' alive when 'T' can be recycled.
+	void reset() noexcept(nothrow_recyclable()) {
+		if(engaged_) {
+			engaged_ = false;
+			recycle();
+		}
+	}
+
+	RecyclingOptional& operator=(nullopt_t) noexcept(nothrow_recyclable()) {
+		reset();
+		return *this;
+	}
+
+	// Destroys the payload, engaged or kept, freeing what it owns.
+	void release() noexcept {
+		if(alive_) {
+			engaged_ = false;
+			alive_ = false;
+			destroy();
+		}
+	}
+
+	/*
+	 * Engages this with a value equal to 'u'.  A kept 'T' is assigned to,
+	 * reusing its capacity; if the assignment throws, this is left empty.
+	 */
+	template <
+		class U,
+		std::enable_if_t<
+			std::is_constructible_v<T, U&&> && std::is_assignable_v<T&, U&&>,
+			bool
+		> = false
+	>
+	T& assign(U&& u) {
+		if(alive_) {
+			engaged_ = false;
+			value_ref() = std::forward<U>(u);
+			engaged_ = true;
+			return value_ref();
+		}
+		return construct(std::forward<U>(u));
+	}
+
+	template <
+		class U,
+		std::enable_if_t<
+			!std::is_same_v<detail::remove_cvref_t<U>, RecyclingOptional>
+			&& !std::is_same_v<detail::remove_cvref_t<U>, nullopt_t>
+			&& std::is_constructible_v<T, U&&>
+			&& std::is_assignable_v<T&, U&&>,
+			bool
+		> = false
+	>
+	RecyclingOptional& operator=(U&& u) {
+		assign(std::forward<U>(u));
+		return *this;
+	}
+
+	/*
+	 * Engages this with a 'T' constructed from 'args...'.  With no arguments a
+	 * kept (cleared) 'T' is engaged as it is, and with one assignable argument
+	 * this is 'assign(arg)'; otherwise any kept 'T' is destroyed and a new one
+	 * constructed.
+	 */
+	template <
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, Args&&...>,
+			bool
+		> = false
+	>
+	T& emplace(Args&& ... args) {
+		if constexpr(sizeof...(Args) == 0) {
+			if(alive_) {
+				if(engaged_) {
+					engaged_ = false;
+					recycle();
+				}
+				if(alive_) {
+					engaged_ = true;
+					return value_ref();
+				}
+			}
+		} else if constexpr(sizeof...(Args) == 1 && (std::is_assignable_v<T&, Args&&> && ...)) {
+			return assign(std::forward<Args>(args)...);
+		}
+		release();
+		return construct(std::forward<Args>(args)...);
+	}
+
+private:
+	static constexpr bool nothrow_recyclable() noexcept {
+		if constexpr(traits_type::can_recycle) {
+			return noexcept(traits_type::clear(std::declval<T&>()));
+		} else {
+			return true;
+		}
+	}
+
+	T& value_ref() noexcept {
+		return std::launder(std::addressof(storage_.storage_.value))->value();
+	}
+
+	const T& value_ref() const noexcept {
+		return std::launder(std::addressof(storage_.storage_.value))->value();
+	}
+
+	// Clears the (disengaged) kept 'T', or destroys it if it cannot be
+	// recycled.
+	void recycle() noexcept(nothrow_recyclable()) {
+		if constexpr(traits_type::can_recycle) {
+			traits_type::clear(value_ref());
+		} else {
+			alive_ = false;
+			destroy();
+		}
+	}
+
+	// Constructs an engaged 'T' in empty storage.
+	template <class ... Args>
+	T& construct(Args&& ... args) {
+		::new (static_cast<void*>(std::addressof(storage_.storage_.value)))
+			wrapper_type(tim::in_place, std::forward<Args>(args)...);
+		alive_ = true;
+		engaged_ = true;
+		return value_ref();
+	}
+
+	void destroy() noexcept {
+		if constexpr(!std::is_trivially_destructible_v<T>) {
+			std::destroy_at(std::addressof(storage_.storage_.value));
+		}
+	}
+
+	detail::OptionalUnion<T> storage_;
+	bool alive_ = false;
+	bool engaged_ = false;
+};
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_RECYCLINGOPTIONAL_HPP */
@@ -0,0 +1,143 @@
+#ifndef TIM_OPTIONAL_SHAREDMEMORYOPTIONAL_HPP
+#define TIM_OPTIONAL_SHAREDMEMORYOPTIONAL_HPP
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+namespace tim {
+
+inline namespace optional {
+
+/*
+ * An Optional<T> for trivially copyable 'T' meant to be placed in memory
+ * shared between processes (a POSIX 'shm_open'/'mmap' region, say), through
+ * which one writer publishes snapshots to any number of readers.
+ *
+ * The object is standard-layout and holds no pointers, so every process may
+ * map it at a different address.  Create it once with placement new in the
+ * region; other processes use the mapped bytes through a pointer cast.  Only
+ * address-free (always lock-free) atomics are used.
+ *
+ * Snapshots are double-buffered.  'publish()' writes the buffer that readers
+ * are not using, then release-stores the incremented generation, which
+ * selects that buffer.  Readers therefore never wait for a write in progress,
+ * and a writer that dies halfway leaves the previous snapshot intact.  A
+ * reader retries only if a publish completes while it is copying.  The
+ * generation also lets pollers tell a republished equal value from an
+ * unchanged one.
+ *
+ * Concurrent 'publish()'/'retract()' calls must be serialized by the caller.
+ */
+template <class T>
+class alignas(64) SharedMemoryOptional {
+	static_assert(std::is_same_v<std::remove_cv_t<T>, T> && std::is_object_v<T>,
+		"SharedMemoryOptional<T> requires a cv-unqualified object type.");
+	static_assert(std::is_trivially_copyable_v<T>,
+		"SharedMemoryOptional<T> requires a trivially copyable T.");
+	static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+		"SharedMemoryOptional<T> requires address-free 64-bit atomics.");
+
+	using word_type = std::uint64_t;
+
+	static constexpr std::size_t word_count = (sizeof(T) + sizeof(word_type) - 1) / sizeof(word_type);
+
+	struct alignas(64) Buffer {
+		std::atomic<word_type> present{0};
+		std::atomic<word_type> words[word_count] = {};
+	};
+
+public:
+	using value_type = T;
+
+	SharedMemoryOptional() noexcept = default;
+
+	SharedMemoryOptional(const SharedMemoryOptional&) = delete;
+	SharedMemoryOptional& operator=(const SharedMemoryOptional&) = delete;
+
+	// The number of 'publish()' and 'retract()' calls so far.
+	std::uint64_t generation() const noexcept {
+		return generation_.load(std::memory_order_acquire);
+	}
+
+	// The latest snapshot.
+	Optional<T> try_read() const noexcept {
+		std::uint64_t generation;
+		return try_read(generation);
+	}
+
+	// The latest snapshot, and in 'generation' the publication it came from.
+	Optional<T> try_read(std::uint64_t& generation) const noexcept {
+		word_type words[word_count];
+		for(;;) {
+			std::uint64_t before = generation_.load(std::memory_order_acquire);
+			const Buffer& buffer = buffers_[before & 1u];
+			bool present = buffer.present.load(std::memory_order_relaxed) != 0u;
+			if(present) {
+				for(std::size_t i = 0; i < word_count; ++i) {
+					words[i] = buffer.words[i].load(std::memory_order_relaxed);
+				}
+			}
+			// Order the copy before the re-check of the generation.
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(generation_.load(std::memory_order_relaxed) != before) {
+				continue;
+			}
+			generation = before;
+			if(!present) {
+				return nullopt;
+			}
+			alignas(T) unsigned char storage[sizeof(T)];
+			std::memcpy(storage, words, sizeof(T));
+			return Optional<T>(*std::launder(reinterpret_cast<const T*>(storage)));
+		}
+	}
+
+	void publish(const T& value) noexcept {
+		write(std::addressof(value));
+	}
+
+	void publish(const Optional<T>& value) noexcept {
+		write(value.has_value() ? std::addressof(*value) : nullptr);
+	}
+
+	// Publishes the empty state.
+	void retract() noexcept {
+		write(nullptr);
+	}
+
+private:
+	void write(const T* value) noexcept {
+		word_type words[word_count] = {};
+		if(value) {
+			std::memcpy(words, value, sizeof(T));
+		}
+		std::uint64_t generation = generation_.load(std::memory_order_relaxed);
+		Buffer& buffer = buffers_[(generation + 1u) & 1u];
+		// A reader that sees any of the stores below also sees 'generation'
+		// (or later) on its re-check, and so discards its copy if it was
+		// reading this buffer for an older generation.
+		std::atomic_thread_fence(std::memory_order_release);
+		buffer.present.store(value != nullptr, std::memory_order_relaxed);
+		if(value) {
+			for(std::size_t i = 0; i < word_count; ++i) {
+				buffer.words[i].store(words[i], std::memory_order_relaxed);
+			}
+		}
+		generation_.store(generation + 1u, std::memory_order_release);
+	}
+
+	alignas(64) std::atomic<std::uint64_t> generation_{0};
+	Buffer buffers_[2];
+};
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_SHAREDMEMORYOPTIONAL_HPP */
@@ -0,0 +1,201 @@
+#ifndef TIM_OPTIONAL_SHAREDOPTIONAL_HPP
+#define TIM_OPTIONAL_SHAREDOPTIONAL_HPP
+
+#include "tim/optional/Optional.hpp"
+#include "tim/optional/detail/Futex.hpp"
+#include <type_traits>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <thread>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+namespace tim {
+
+inline namespace optional {
+
+/*
+ * A read-mostly Optional<T> for trivially copyable 'T' too large for
+ * AtomicOptional, guarded by a sequence lock.
+ *
+ * 'load()' copies the value out and then checks that no write overlapped the
+ * copy, retrying if one did, so readers never block and never write to shared
+ * memory.  Writers ('store', 'emplace', 'reset') are serialized by the
+ * sequence word itself and make it odd for the duration of a write.
+ *
+ * The payload is kept in relaxed atomic words rather than plain bytes, so that
+ * the racing copy in 'load()' is well defined (and invisible to TSan); torn
+ * copies are detected and thrown away by the sequence check.
+ */
+template <class T>
+class alignas(64) SharedOptional {
+	static_assert(std::is_same_v<std::remove_cv_t<T>, T> && std::is_object_v<T>,
+		"SharedOptional<T> requires a cv-unqualified object type.");
+	static_assert(std::is_trivially_copyable_v<T>,
+		"SharedOptional<T> requires a trivially copyable T.");
+
+	using word_type = std::uint64_t;
+
+	static constexpr std::size_t word_count = (sizeof(T) + sizeof(word_type) - 1) / sizeof(word_type);
+
+public:
+	using value_type = T;
+
+	SharedOptional() noexcept = default;
+
+	SharedOptional(nullopt_t) noexcept:
+		SharedOptional()
+	{
+
+	}
+
+	SharedOptional(const Optional<T>& value) noexcept {
+		store(value);
+	}
+
+	SharedOptional(const SharedOptional&) = delete;
+	SharedOptional& operator=(const SharedOptional&) = delete;
+
+	Optional<T> operator=(const Optional<T>& value) noexcept {
+		store(value);
+		return value;
+	}
+
+	Optional<T> operator=(nullopt_t) noexcept {
+		reset();
+		return nullopt;
+	}
+
+	// A consistent snapshot of the current value.
+	Optional<T> load() const noexcept {
+		word_type words[word_count];
+		for(int round = 0;;) {
+			std::uint64_t before = sequence_.load(std::memory_order_acquire);
+			if(before & 1u) {
+				back_off(round++);
+				continue;
+			}
+			bool present = present_.load(std::memory_order_relaxed);
+			if(present) {
+				for(std::size_t i = 0; i < word_count; ++i) {
+					words[i] = words_[i].load(std::memory_order_relaxed);
+				}
+			}
+			// Order the copy before the re-check of the sequence.
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(sequence_.load(std::memory_order_relaxed) != before) {
+				continue;
+			}
+			if(!present) {
+				return nullopt;
+			}
+			alignas(T) unsigned char storage[sizeof(T)];
+			std::memcpy(storage, words, sizeof(T));
+			return Optional<T>(*std::launder(reinterpret_cast<const T*>(storage)));
+		}
+	}
+
+	operator Optional<T>() const noexcept {
+		return load();
+	}
+
+	bool has_value() const noexcept {
+		for(int round = 0;;) {
+			std::uint64_t before = sequence_.load(std::memory_order_acquire);
+			if(before & 1u) {
+				back_off(round++);
+				continue;
+			}
+			bool present = present_.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(sequence_.load(std::memory_order_relaxed) == before) {
+				return present;
+			}
+		}
+	}
+
+	void store(const Optional<T>& value) noexcept {
+		if(value.has_value()) {
+			write(std::addressof(*value));
+		} else {
+			write(nullptr);
+		}
+	}
+
+	void reset() noexcept {
+		write(nullptr);
+	}
+
+	// Constructs a 'T' from 'args...' and publishes it.  'T' is built before the
+	// write begins, so a throwing constructor leaves the value unchanged.
+	template <
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, Args&&...>,
+			bool
+		> = false
+	>
+	void emplace(Args&& ... args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>) {
+		T value(std::forward<Args>(args)...);
+		write(std::addressof(value));
+	}
+
+private:
+	static constexpr int spin_limit = 64;
+
+	// Waits out another thread's write.  Spins only where that can help, then
+	// yields: on a single hardware thread the writer cannot finish until this
+	// thread gives up the CPU.
+	static void back_off(int round) noexcept {
+		if(round < (detail::spinning_helps() ? spin_limit : 0)) {
+			detail::cpu_relax();
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+	// Writes '*value', or the empty state if 'value' is null.
+	void write(const T* value) noexcept {
+		word_type words[word_count] = {};
+		if(value) {
+			std::memcpy(words, value, sizeof(T));
+		}
+		std::uint64_t sequence = lock();
+		present_.store(value != nullptr, std::memory_order_relaxed);
+		if(value) {
+			for(std::size_t i = 0; i < word_count; ++i) {
+				words_[i].store(words[i], std::memory_order_relaxed);
+			}
+		}
+		sequence_.store(sequence + 2u, std::memory_order_release);
+	}
+
+	// Makes the sequence odd and returns its previous (even) value.
+	std::uint64_t lock() noexcept {
+		std::uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+		for(int round = 0;; ++round) {
+			if(!(sequence & 1u) && sequence_.compare_exchange_weak(
+				sequence, sequence + 1u, std::memory_order_acquire, std::memory_order_relaxed
+			)) {
+				break;
+			}
+			back_off(round);
+			sequence = sequence_.load(std::memory_order_relaxed);
+		}
+		// Keep the payload stores after the odd sequence becomes visible.
+		std::atomic_thread_fence(std::memory_order_release);
+		return sequence;
+	}
+
+	std::atomic<std::uint64_t> sequence_{0};
+	std::atomic<bool> present_{false};
+	std::atomic<word_type> words_[word_count] = {};
+};
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_SHAREDOPTIONAL_HPP */
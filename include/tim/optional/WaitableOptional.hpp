@@ -0,0 +1,210 @@
+#ifndef TIM_OPTIONAL_WAITABLEOPTIONAL_HPP
+#define TIM_OPTIONAL_WAITABLEOPTIONAL_HPP
+
+#include "tim/optional/Optional.hpp"
+#include "tim/optional/detail/Futex.hpp"
+#include <type_traits>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#include <cassert>
+#include <cstdint>
+
+namespace tim {
+
+inline namespace optional {
+
+/*
+ * A one-shot, allocation-free replacement for a std::promise/std::future pair:
+ * an inline Optional<T> plus a state word.  One thread 'set()'s the value and
+ * any number of threads 'wait()' for it; waiters spin briefly, yield, and then
+ * sleep on the state word, and 'set()' only makes a system call if someone is
+ * asleep.
+ *
+ * 'reset()' empties it again for the next round, so that it can be pooled.
+ * 'set()' and 'reset()' must not race with each other, and 'reset()' must not
+ * race with waiters or with readers of the value.
+ */
+template <class T>
+class WaitableOptional {
+	static_assert(std::is_object_v<T> && !std::is_array_v<T>,
+		"WaitableOptional<T> requires a non-array object type.");
+	static_assert(std::is_nothrow_destructible_v<T>,
+		"WaitableOptional<T> requires a nothrow destructible T.");
+
+	using wrapper_type = detail::ValueWrapper<T>;
+
+public:
+	using value_type = T;
+
+	WaitableOptional() noexcept:
+		storage_(detail::empty_tag)
+	{
+
+	}
+
+	WaitableOptional(const WaitableOptional&) = delete;
+	WaitableOptional& operator=(const WaitableOptional&) = delete;
+
+	~WaitableOptional() {
+		if(state_.load(std::memory_order_acquire) == ready) {
+			destroy();
+		}
+	}
+
+	/*
+	 * Constructs the value from 'args...' and wakes every waiter.  Must not be
+	 * called again before 'reset()'.  If the constructor throws, this stays
+	 * empty and the waiters keep waiting.
+	 */
+	template <
+		class ... Args,
+		std::enable_if_t<
+			std::is_constructible_v<T, Args&&...>,
+			bool
+		> = false
+	>
+	T& set(Args&& ... args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>) {
+		assert(state_.load(std::memory_order_relaxed) != ready);
+		::new (static_cast<void*>(std::addressof(storage_.storage_.value)))
+			wrapper_type(tim::in_place, std::forward<Args>(args)...);
+		if(state_.exchange(ready, std::memory_order_release) == empty_with_waiters) {
+			detail::futex_wake_all(state_);
+		}
+		return value();
+	}
+
+	bool has_value() const noexcept {
+		return state_.load(std::memory_order_acquire) == ready;
+	}
+
+	// The value if it has been set, without waiting.
+	Optional<T&> try_get() noexcept {
+		if(has_value()) {
+			return Optional<T&>(value());
+		}
+		return nullopt;
+	}
+
+	Optional<const T&> try_get() const noexcept {
+		if(has_value()) {
+			return Optional<const T&>(value());
+		}
+		return nullopt;
+	}
+
+	// Blocks until the value is set.
+	T& wait() noexcept {
+		wait_until_ready();
+		return value();
+	}
+
+	const T& wait() const noexcept {
+		wait_until_ready();
+		return value();
+	}
+
+	// Blocks until the value is set or 'timeout' has passed.
+	template <class Rep, class Period>
+	Optional<T&> wait_for(const std::chrono::duration<Rep, Period>& timeout) noexcept {
+		if(wait_until_ready(std::chrono::steady_clock::now() + timeout)) {
+			return Optional<T&>(value());
+		}
+		return nullopt;
+	}
+
+	template <class Rep, class Period>
+	Optional<const T&> wait_for(const std::chrono::duration<Rep, Period>& timeout) const noexcept {
+		if(wait_until_ready(std::chrono::steady_clock::now() + timeout)) {
+			return Optional<const T&>(value());
+		}
+		return nullopt;
+	}
+
+	// Destroys the value, if any, so that this can be 'set()' again.
+	void reset() noexcept {
+		if(state_.load(std::memory_order_acquire) == ready) {
+			destroy();
+		}
+		state_.store(empty, std::memory_order_relaxed);
+	}
+
+private:
+	enum : std::uint32_t {
+		empty = 0,
+		// 'empty', and at least one thread is (or is about to be) asleep.
+		empty_with_waiters = 1,
+		ready = 2
+	};
+
+	// Waiters spin (on machines where the setter can run meanwhile), then
+	// yield a few times, then sleep.
+	static constexpr int spin_limit = 64;
+	static constexpr int yield_limit = 4;
+
+	T& value() noexcept {
+		return std::launder(std::addressof(storage_.storage_.value))->value();
+	}
+
+	const T& value() const noexcept {
+		return std::launder(std::addressof(storage_.storage_.value))->value();
+	}
+
+	void destroy() noexcept {
+		if constexpr(!std::is_trivially_destructible_v<T>) {
+			std::destroy_at(std::addressof(storage_.storage_.value));
+		}
+	}
+
+	// Marks that a waiter is about to sleep.  Returns false if the value
+	// arrived first.
+	bool announce_waiter() const noexcept {
+		std::uint32_t state = empty;
+		return state_.compare_exchange_strong(state, empty_with_waiters, std::memory_order_relaxed)
+			|| state == empty_with_waiters;
+	}
+
+	void wait_until_ready() const noexcept {
+		const int spins = detail::spinning_helps() ? spin_limit : 0;
+		for(int round = 0; !has_value(); ++round) {
+			if(round < spins) {
+				detail::cpu_relax();
+			} else if(round < spins + yield_limit) {
+				std::this_thread::yield();
+			} else if(announce_waiter()) {
+				detail::futex_wait(state_, empty_with_waiters);
+			}
+		}
+	}
+
+	bool wait_until_ready(std::chrono::steady_clock::time_point deadline) const noexcept {
+		const int spins = detail::spinning_helps() ? spin_limit : 0;
+		for(int round = 0; !has_value(); ++round) {
+			auto now = std::chrono::steady_clock::now();
+			if(now >= deadline) {
+				return false;
+			}
+			if(round < spins) {
+				detail::cpu_relax();
+			} else if(round < spins + yield_limit) {
+				std::this_thread::yield();
+			} else if(announce_waiter()) {
+				detail::futex_wait_for(state_, empty_with_waiters, deadline - now);
+			}
+		}
+		return true;
+	}
+
+	// 'wait()' is const, and announcing a waiter writes the state.
+	mutable std::atomic<std::uint32_t> state_{empty};
+	detail::OptionalUnion<T> storage_;
+};
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_WAITABLEOPTIONAL_HPP */
@@ -0,0 +1,283 @@
+#ifndef TIM_OPTIONAL_WORKSTEALINGPOOL_HPP
+#define TIM_OPTIONAL_WORKSTEALINGPOOL_HPP
+
+#include <type_traits>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace tim {
+
+inline namespace optional {
+
+/*
+ * A small fork-join pool for the parallel algorithms in OptionalAlgorithms.hpp.
+ *
+ * 'parallel_for(chunks, f)' deals the chunk indices out to the participants
+ * (the worker threads plus the calling thread) as contiguous runs.  Each
+ * participant works through its own run from the front; one that runs dry
+ * steals the back half of another's remaining run.  Runs are just index
+ * ranges, so dealing and stealing never allocate.
+ */
+class WorkStealingPool {
+public:
+	// 'threads' counts the calling thread, so 'WorkStealingPool(1)' starts no
+	// workers and runs everything inline.
+	explicit WorkStealingPool(unsigned threads = default_thread_count()):
+		count_(std::max(threads, 1u)),
+		queues_(new Queue[count_])
+	{
+		threads_.reserve(count_ - 1u);
+		for(unsigned self = 1; self < count_; ++self) {
+			threads_.emplace_back([this, self]() { worker_main(self); });
+		}
+	}
+
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	~WorkStealingPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		wake_.notify_all();
+		for(auto& t: threads_) {
+			t.join();
+		}
+	}
+
+	unsigned thread_count() const noexcept {
+		return count_;
+	}
+
+	/*
+	 * Calls 'f(chunk)' once for each 'chunk' in [0, chunks) and returns when all
+	 * calls have finished.  If any call throws, chunks not yet started are
+	 * skipped and the first exception is rethrown here.  Calls from inside a
+	 * running chunk (of any pool) run inline rather than deadlocking.
+	 */
+	template <class F>
+	void parallel_for(std::size_t chunks, F&& f) {
+		using function_type = std::remove_reference_t<F>;
+		run(
+			chunks,
+			[](void* context, std::size_t chunk) { (*static_cast<function_type*>(context))(chunk); },
+			const_cast<void*>(static_cast<const void*>(std::addressof(f)))
+		);
+	}
+
+	static unsigned default_thread_count() noexcept {
+		return std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	// The pool used by 'execution::par'; one thread per hardware thread.
+	static WorkStealingPool& default_pool() {
+		static WorkStealingPool pool;
+		return pool;
+	}
+
+private:
+	using Invoke = void (*)(void*, std::size_t);
+
+	// Padded so that participants polling different queues do not false-share.
+	struct alignas(64) Queue {
+		std::mutex mutex;
+		std::size_t begin = 0;
+		std::size_t end = 0;
+	};
+
+	static WorkStealingPool*& current() noexcept {
+		thread_local WorkStealingPool* pool = nullptr;
+		return pool;
+	}
+
+	void run(std::size_t chunks, Invoke invoke, void* context) {
+		if(chunks == 0) {
+			return;
+		}
+		if(count_ == 1 || chunks == 1 || current()) {
+			for(std::size_t chunk = 0; chunk < chunks; ++chunk) {
+				invoke(context, chunk);
+			}
+			return;
+		}
+		std::lock_guard<std::mutex> job(job_mutex_);
+		for(unsigned p = 0; p < count_; ++p) {
+			std::lock_guard<std::mutex> lock(queues_[p].mutex);
+			queues_[p].begin = chunks * p / count_;
+			queues_[p].end = chunks * (p + 1u) / count_;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			invoke_ = invoke;
+			context_ = context;
+			error_ = nullptr;
+			failed_.store(false, std::memory_order_relaxed);
+			accepting_ = true;
+			++generation_;
+		}
+		wake_.notify_all();
+		current() = this;
+		drain(0);
+		current() = nullptr;
+		std::exception_ptr error;
+		{
+			// Workers that have not joined yet find 'accepting_' cleared and go
+			// back to sleep, so nothing can touch 'context' after this.
+			std::unique_lock<std::mutex> lock(mutex_);
+			idle_.wait(lock, [this]() { return active_ == 0; });
+			accepting_ = false;
+			error = std::exchange(error_, nullptr);
+		}
+		if(error) {
+			std::rethrow_exception(error);
+		}
+	}
+
+	void worker_main(unsigned self) {
+		current() = this;
+		std::uint64_t seen = 0;
+		std::unique_lock<std::mutex> lock(mutex_);
+		for(;;) {
+			wake_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+			if(stop_) {
+				return;
+			}
+			seen = generation_;
+			if(!accepting_) {
+				continue;
+			}
+			++active_;
+			lock.unlock();
+			drain(self);
+			lock.lock();
+			if(--active_ == 0) {
+				idle_.notify_all();
+			}
+		}
+	}
+
+	void drain(unsigned self) {
+		std::size_t chunk = 0;
+		while(take(self, chunk) || steal(self, chunk)) {
+			if(failed_.load(std::memory_order_relaxed)) {
+				continue;
+			}
+			try {
+				invoke_(context_, chunk);
+			} catch(...) {
+				std::lock_guard<std::mutex> lock(mutex_);
+				if(!error_) {
+					error_ = std::current_exception();
+				}
+				failed_.store(true, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	bool take(unsigned self, std::size_t& chunk) {
+		Queue& q = queues_[self];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		if(q.begin == q.end) {
+			return false;
+		}
+		chunk = q.begin++;
+		return true;
+	}
+
+	bool steal(unsigned self, std::size_t& chunk) {
+		for(unsigned d = 1; d < count_; ++d) {
+			Queue& victim = queues_[(self + d) % count_];
+			std::size_t first = 0;
+			std::size_t last = 0;
+			{
+				std::lock_guard<std::mutex> lock(victim.mutex);
+				std::size_t available = victim.end - victim.begin;
+				if(available == 0) {
+					continue;
+				}
+				last = victim.end;
+				first = last - (available + 1u) / 2u;
+				victim.end = first;
+			}
+			chunk = first;
+			Queue& own = queues_[self];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			own.begin = first + 1u;
+			own.end = last;
+			return true;
+		}
+		return false;
+	}
+
+	unsigned count_;
+	std::unique_ptr<Queue[]> queues_;
+	std::vector<std::thread> threads_;
+	std::mutex job_mutex_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable idle_;
+	std::uint64_t generation_ = 0;
+	unsigned active_ = 0;
+	bool accepting_ = false;
+	bool stop_ = false;
+	Invoke invoke_ = nullptr;
+	void* context_ = nullptr;
+	std::atomic<bool> failed_{false};
+	std::exception_ptr error_;
+};
+
+namespace execution {
+
+struct sequenced_policy {};
+
+// Runs on 'WorkStealingPool::default_pool()', or on the pool given to 'on()'.
+class parallel_policy {
+public:
+	constexpr parallel_policy() noexcept = default;
+
+	constexpr parallel_policy on(WorkStealingPool& pool) const noexcept {
+		parallel_policy policy;
+		policy.pool_ = &pool;
+		return policy;
+	}
+
+	WorkStealingPool& pool() const {
+		return pool_ ? *pool_ : WorkStealingPool::default_pool();
+	}
+
+private:
+	WorkStealingPool* pool_ = nullptr;
+};
+
+inline constexpr sequenced_policy seq{};
+inline constexpr parallel_policy par{};
+
+template <class T>
+struct is_execution_policy: std::false_type {};
+
+template <>
+struct is_execution_policy<sequenced_policy>: std::true_type {};
+
+template <>
+struct is_execution_policy<parallel_policy>: std::true_type {};
+
+template <class T>
+inline constexpr bool is_execution_policy_v = is_execution_policy<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+} /* namespace execution */
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_WORKSTEALINGPOOL_HPP */
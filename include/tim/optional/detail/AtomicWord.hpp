@@ -0,0 +1,209 @@
+#ifndef TIM_OPTIONAL_DETAIL_ATOMICWORD_HPP
+#define TIM_OPTIONAL_DETAIL_ATOMICWORD_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+# define TIM_OPTIONAL_HAS_CMPXCHG16B 1
+#endif
+
+namespace tim {
+
+inline namespace optional {
+
+namespace detail {
+
+/*
+ * 8- and 16-byte words with the subset of the std::atomic interface that the
+ * concurrent optionals need.  The 16-byte word uses 'lock cmpxchg16b' directly
+ * on x86-64: std::atomic<__int128> goes through libatomic there and does not
+ * report itself lock-free.  Elsewhere it falls back to std::atomic.
+ */
+template <std::size_t Size>
+class AtomicWord;
+
+// The failure order that goes with a single-order compare-exchange.
+constexpr std::memory_order failure_order(std::memory_order order) noexcept {
+	switch(order) {
+	case std::memory_order_acq_rel:
+		return std::memory_order_acquire;
+	case std::memory_order_release:
+		return std::memory_order_relaxed;
+	default:
+		return order;
+	}
+}
+
+template <>
+class AtomicWord<8> {
+public:
+	using word_type = std::uint64_t;
+
+	static constexpr bool is_always_lock_free = std::atomic<word_type>::is_always_lock_free;
+
+	constexpr AtomicWord() noexcept = default;
+
+	constexpr explicit AtomicWord(word_type w) noexcept:
+		word_(w)
+	{
+
+	}
+
+	bool is_lock_free() const noexcept {
+		return word_.is_lock_free();
+	}
+
+	word_type load(std::memory_order order) const noexcept {
+		return word_.load(order);
+	}
+
+	void store(word_type w, std::memory_order order) noexcept {
+		word_.store(w, order);
+	}
+
+	word_type exchange(word_type w, std::memory_order order) noexcept {
+		return word_.exchange(w, order);
+	}
+
+	bool compare_exchange_weak(word_type& expected, word_type desired, std::memory_order success, std::memory_order failure) noexcept {
+		return word_.compare_exchange_weak(expected, desired, success, failure);
+	}
+
+	bool compare_exchange_strong(word_type& expected, word_type desired, std::memory_order success, std::memory_order failure) noexcept {
+		return word_.compare_exchange_strong(expected, desired, success, failure);
+	}
+
+private:
+	std::atomic<word_type> word_{0};
+};
+
+#if defined(TIM_OPTIONAL_HAS_CMPXCHG16B)
+
+template <>
+class AtomicWord<16> {
+public:
+	__extension__ typedef unsigned __int128 word_type;
+
+	// 'lock cmpxchg16b' is a full barrier, so every operation is seq_cst and
+	// the order arguments are ignored.
+	static constexpr bool is_always_lock_free = true;
+
+	constexpr AtomicWord() noexcept = default;
+
+	constexpr explicit AtomicWord(word_type w) noexcept:
+		word_(w)
+	{
+
+	}
+
+	bool is_lock_free() const noexcept {
+		return true;
+	}
+
+	// There is no plain 16-byte atomic load, so compare against a guess and
+	// let the failed exchange report the current value.  (A matching guess
+	// rewrites the same value, which is why 'word_' is mutable.)
+	word_type load(std::memory_order) const noexcept {
+		word_type expected = 0;
+		cas(expected, 0);
+		return expected;
+	}
+
+	void store(word_type w, std::memory_order order) noexcept {
+		exchange(w, order);
+	}
+
+	word_type exchange(word_type w, std::memory_order) noexcept {
+		word_type expected = 0;
+		while(!cas(expected, w)) {
+
+		}
+		return expected;
+	}
+
+	bool compare_exchange_weak(word_type& expected, word_type desired, std::memory_order, std::memory_order) noexcept {
+		return cas(expected, desired);
+	}
+
+	bool compare_exchange_strong(word_type& expected, word_type desired, std::memory_order, std::memory_order) noexcept {
+		return cas(expected, desired);
+	}
+
+private:
+	bool cas(word_type& expected, word_type desired) const noexcept {
+		bool ok;
+		std::uint64_t lo = static_cast<std::uint64_t>(expected);
+		std::uint64_t hi = static_cast<std::uint64_t>(expected >> 64);
+		__asm__ __volatile__(
+			"lock cmpxchg16b %1"
+			: "=@ccz"(ok), "+m"(word_), "+a"(lo), "+d"(hi)
+			: "b"(static_cast<std::uint64_t>(desired)), "c"(static_cast<std::uint64_t>(desired >> 64))
+			: "memory"
+		);
+		expected = (static_cast<word_type>(hi) << 64) | lo;
+		return ok;
+	}
+
+	alignas(16) mutable word_type word_ = 0;
+};
+
+#else
+
+struct alignas(16) Word16 {
+	unsigned char bytes[16];
+};
+
+template <>
+class AtomicWord<16> {
+public:
+	using word_type = Word16;
+
+	static constexpr bool is_always_lock_free = std::atomic<word_type>::is_always_lock_free;
+
+	constexpr AtomicWord() noexcept = default;
+
+	constexpr explicit AtomicWord(word_type w) noexcept:
+		word_(w)
+	{
+
+	}
+
+	bool is_lock_free() const noexcept {
+		return word_.is_lock_free();
+	}
+
+	word_type load(std::memory_order order) const noexcept {
+		return word_.load(order);
+	}
+
+	void store(word_type w, std::memory_order order) noexcept {
+		word_.store(w, order);
+	}
+
+	word_type exchange(word_type w, std::memory_order order) noexcept {
+		return word_.exchange(w, order);
+	}
+
+	bool compare_exchange_weak(word_type& expected, word_type desired, std::memory_order success, std::memory_order failure) noexcept {
+		return word_.compare_exchange_weak(expected, desired, success, failure);
+	}
+
+	bool compare_exchange_strong(word_type& expected, word_type desired, std::memory_order success, std::memory_order failure) noexcept {
+		return word_.compare_exchange_strong(expected, desired, success, failure);
+	}
+
+private:
+	std::atomic<word_type> word_{word_type{}};
+};
+
+#endif /* defined(TIM_OPTIONAL_HAS_CMPXCHG16B) */
+
+} /* namespace detail */
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_DETAIL_ATOMICWORD_HPP */
@@ -0,0 +1,69 @@
+#ifndef TIM_OPTIONAL_DETAIL_BITOPS_HPP
+#define TIM_OPTIONAL_DETAIL_BITOPS_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace tim {
+
+inline namespace optional {
+
+namespace detail {
+
+/*
+ * Word-level helpers shared by the bitmap-backed containers.  Presence bitmaps
+ * are arrays of 64-bit words; bit 'i % 64' of word 'i / 64' describes slot 'i'.
+ */
+
+inline constexpr std::size_t bitmap_word_bits = 64;
+
+constexpr std::size_t bitmap_word_count(std::size_t bits) noexcept {
+	return (bits + (bitmap_word_bits - 1)) / bitmap_word_bits;
+}
+
+constexpr std::size_t bitmap_word_index(std::size_t bit) noexcept {
+	return bit / bitmap_word_bits;
+}
+
+constexpr std::uint64_t bitmap_bit_mask(std::size_t bit) noexcept {
+	return std::uint64_t(1) << (bit % bitmap_word_bits);
+}
+
+// Mask selecting the low 'n' bits of a word, for 0 <= n <= 64.
+constexpr std::uint64_t bitmap_low_mask(std::size_t n) noexcept {
+	return n >= bitmap_word_bits ? ~std::uint64_t(0) : (std::uint64_t(1) << n) - 1u;
+}
+
+// Index of the lowest set bit.  'w' must be nonzero.  The builtins fold in
+// constant expressions; MSVC's intrinsics do not, so it gets the loops.
+constexpr int countr_zero(std::uint64_t w) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(w);
+#else
+	int n = 0;
+	for(; !(w & 1u); w >>= 1) {
+		++n;
+	}
+	return n;
+#endif
+}
+
+constexpr int popcount(std::uint64_t w) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(w);
+#else
+	int n = 0;
+	for(; w; w &= w - 1u) {
+		++n;
+	}
+	return n;
+#endif
+}
+
+} /* namespace detail */
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_DETAIL_BITOPS_HPP */
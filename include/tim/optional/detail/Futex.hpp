@@ -0,0 +1,172 @@
+#ifndef TIM_OPTIONAL_DETAIL_FUTEX_HPP
+#define TIM_OPTIONAL_DETAIL_FUTEX_HPP
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__linux__)
+# include <linux/futex.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+# include <climits>
+# include <ctime>
+# define TIM_OPTIONAL_HAS_FUTEX 1
+#else
+# include <condition_variable>
+# include <mutex>
+#endif
+
+namespace tim {
+
+inline namespace optional {
+
+namespace detail {
+
+/*
+ * Blocking on a 32-bit atomic without any per-object state: a futex on Linux,
+ * and elsewhere a fixed table of mutex/condition variable pairs shared by
+ * address.  'futex_wait(word, expected)' returns once 'word' may no longer
+ * hold 'expected' (or spuriously); callers re-check in a loop.
+ * 'futex_wait_for' also gives up after roughly 'timeout'.
+ */
+
+// Hint to the CPU that this is a spin-wait loop.
+inline void cpu_relax() noexcept {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+// Whether spinning can pay off: on a single hardware thread, the thread being
+// waited for cannot make progress until the spinner gives up the CPU.
+inline bool spinning_helps() noexcept {
+	static const bool multicore = std::thread::hardware_concurrency() > 1u;
+	return multicore;
+}
+
+#if defined(TIM_OPTIONAL_HAS_FUTEX)
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t)
+	&& std::atomic<std::uint32_t>::is_always_lock_free,
+	"futex words must be plain 32-bit atomics.");
+
+inline void futex_wait(const std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept {
+	::syscall(
+		SYS_futex,
+		reinterpret_cast<const std::uint32_t*>(&word),
+		FUTEX_WAIT_PRIVATE,
+		expected,
+		nullptr,
+		nullptr,
+		0
+	);
+}
+
+inline void futex_wait_for(
+	const std::atomic<std::uint32_t>& word,
+	std::uint32_t expected,
+	std::chrono::nanoseconds timeout
+) noexcept {
+	if(timeout <= std::chrono::nanoseconds::zero()) {
+		return;
+	}
+	auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+	struct timespec relative;
+	relative.tv_sec = static_cast<std::time_t>(seconds.count());
+	relative.tv_nsec = static_cast<long>((timeout - seconds).count());
+	::syscall(
+		SYS_futex,
+		reinterpret_cast<const std::uint32_t*>(&word),
+		FUTEX_WAIT_PRIVATE,
+		expected,
+		&relative,
+		nullptr,
+		0
+	);
+}
+
+inline void futex_wake(std::atomic<std::uint32_t>& word, int count) noexcept {
+	::syscall(
+		SYS_futex,
+		reinterpret_cast<std::uint32_t*>(&word),
+		FUTEX_WAKE_PRIVATE,
+		count,
+		nullptr,
+		nullptr,
+		0
+	);
+}
+
+inline void futex_wake_one(std::atomic<std::uint32_t>& word) noexcept {
+	futex_wake(word, 1);
+}
+
+inline void futex_wake_all(std::atomic<std::uint32_t>& word) noexcept {
+	futex_wake(word, INT_MAX);
+}
+
+#else
+
+struct alignas(64) ParkingBucket {
+	std::mutex mutex;
+	std::condition_variable cv;
+};
+
+inline ParkingBucket& parking_bucket(const void* address) noexcept {
+	static ParkingBucket buckets[64];
+	auto bits = reinterpret_cast<std::uintptr_t>(address);
+	return buckets[(bits >> 4) % 64u];
+}
+
+inline void futex_wait(const std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept {
+	ParkingBucket& bucket = parking_bucket(&word);
+	std::unique_lock<std::mutex> lock(bucket.mutex);
+	// Wakers take the bucket lock after changing 'word', so checking under it
+	// cannot miss a wake.
+	if(word.load(std::memory_order_acquire) == expected) {
+		bucket.cv.wait(lock);
+	}
+}
+
+inline void futex_wait_for(
+	const std::atomic<std::uint32_t>& word,
+	std::uint32_t expected,
+	std::chrono::nanoseconds timeout
+) noexcept {
+	if(timeout <= std::chrono::nanoseconds::zero()) {
+		return;
+	}
+	ParkingBucket& bucket = parking_bucket(&word);
+	std::unique_lock<std::mutex> lock(bucket.mutex);
+	if(word.load(std::memory_order_acquire) == expected) {
+		bucket.cv.wait_for(lock, timeout);
+	}
+}
+
+// Buckets are shared, so every wake is a broadcast.
+inline void futex_wake_all(std::atomic<std::uint32_t>& word) noexcept {
+	ParkingBucket& bucket = parking_bucket(&word);
+	{
+		std::lock_guard<std::mutex> lock(bucket.mutex);
+	}
+	bucket.cv.notify_all();
+}
+
+inline void futex_wake_one(std::atomic<std::uint32_t>& word) noexcept {
+	futex_wake_all(word);
+}
+
+#endif /* defined(TIM_OPTIONAL_HAS_FUTEX) */
+
+} /* namespace detail */
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_DETAIL_FUTEX_HPP */
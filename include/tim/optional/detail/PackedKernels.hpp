@@ -0,0 +1,700 @@
+#ifndef TIM_OPTIONAL_DETAIL_PACKEDKERNELS_HPP
+#define TIM_OPTIONAL_DETAIL_PACKEDKERNELS_HPP
+
+#include "tim/optional/Optional.hpp"
+#include "tim/optional/detail/BitOps.hpp"
+#include <type_traits>
+#include <memory>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(TIM_OPTIONAL_DISABLE_SIMD) \
+	&& (defined(__GNUC__) || defined(__clang__)) \
+	&& defined(__x86_64__)
+# define TIM_OPTIONAL_HAS_X86_KERNELS 1
+# include <immintrin.h>
+# define TIM_OPTIONAL_TARGET_AVX2 __attribute__((target("avx2")))
+# define TIM_OPTIONAL_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512vl")))
+#else
+# define TIM_OPTIONAL_HAS_X86_KERNELS 0
+#endif
+
+namespace tim {
+
+inline namespace optional {
+
+namespace detail {
+
+/*
+ * Vector kernels for the bulk algorithms in OptionalAlgorithms.hpp.
+ *
+ * They apply to "packed" optionals: a trivially copyable 4- or 8-byte 'T'
+ * at offset zero, followed by the presence flag at offset 'sizeof(T)', with
+ * 'Optional<T>' padded out to exactly twice the size of 'T'.  That is what
+ * the flag layout produces for 'int', 'float', 'std::int64_t', 'double' and
+ * friends (no tail padding to reuse), so a block of 'Optional<T>'s is an
+ * array of (value, flag) lane pairs and the flag byte can be tested in place.
+ *
+ * Each kernel handles whole blocks only and reports how far it got; the
+ * caller finishes the tail with the scalar loop.  Presence masks use the
+ * bitmap convention of BitOps.hpp.
+ */
+
+template <class T>
+inline constexpr bool optional_is_packed_v = std::conjunction_v<
+	std::bool_constant<optional_layout_v<T> == OptionalLayout::Flag>,
+	std::is_trivially_copyable<T>,
+	std::bool_constant<sizeof(T) == 4 || sizeof(T) == 8>,
+	std::bool_constant<alignof(T) == sizeof(T)>,
+	std::bool_constant<sizeof(Optional<T>) == 2 * sizeof(T)>
+>;
+
+enum class SimdIsa {
+	Scalar,
+	Avx2,
+	Avx512
+};
+
+inline bool simd_isa_supported(SimdIsa isa) noexcept {
+#if TIM_OPTIONAL_HAS_X86_KERNELS
+	switch(isa) {
+	case SimdIsa::Scalar:
+		return true;
+	case SimdIsa::Avx2:
+		return __builtin_cpu_supports("avx2");
+	case SimdIsa::Avx512:
+		return __builtin_cpu_supports("avx2")
+			&& __builtin_cpu_supports("avx512f")
+			&& __builtin_cpu_supports("avx512vl");
+	}
+	return false;
+#else
+	return isa == SimdIsa::Scalar;
+#endif
+}
+
+// The widest instruction set the running CPU supports, probed once.
+inline SimdIsa simd_isa() noexcept {
+	static const SimdIsa isa = (
+		simd_isa_supported(SimdIsa::Avx512) ? SimdIsa::Avx512
+		: simd_isa_supported(SimdIsa::Avx2) ? SimdIsa::Avx2
+		: SimdIsa::Scalar
+	);
+	return isa;
+}
+
+struct KernelProgress {
+	std::size_t in;
+	std::size_t out;
+};
+
+// Reads the 'width' presence bits starting at bit 'i'.  Blocks never straddle
+// a word: 'i' is a multiple of 'width', which divides 64.
+inline unsigned bitmap_block(const std::uint64_t* mask, std::size_t i, unsigned width) noexcept {
+	return static_cast<unsigned>(
+		(mask[bitmap_word_index(i)] >> (i % bitmap_word_bits)) & bitmap_low_mask(width)
+	);
+}
+
+inline void bitmap_store_block(std::uint64_t* mask, std::size_t i, unsigned bits) noexcept {
+	if(mask) {
+		mask[bitmap_word_index(i)] |= std::uint64_t(bits) << (i % bitmap_word_bits);
+	}
+}
+
+#if TIM_OPTIONAL_HAS_X86_KERNELS
+
+/*
+ * AVX2 has no compress or expand instruction, so those kernels shuffle with a
+ * lane permutation looked up by block mask.  Entries are dword indices for
+ * 'vpermd'; the 4-lane tables move qwords as dword pairs.
+ */
+struct alignas(32) LanePermutations8 {
+	std::uint32_t lanes[256][8];
+};
+
+struct alignas(32) LanePermutations4 {
+	std::uint32_t lanes[16][8];
+};
+
+// Entry 'm' gathers the lanes selected by 'm' to the front.
+constexpr LanePermutations8 make_compress_permutations8() noexcept {
+	LanePermutations8 table{};
+	for(unsigned m = 0; m < 256; ++m) {
+		unsigned k = 0;
+		for(unsigned j = 0; j < 8; ++j) {
+			if(m & (1u << j)) {
+				table.lanes[m][k++] = j;
+			}
+		}
+	}
+	return table;
+}
+
+// Entry 'm' spreads the front lanes out to the lanes selected by 'm'.
+constexpr LanePermutations8 make_expand_permutations8() noexcept {
+	LanePermutations8 table{};
+	for(unsigned m = 0; m < 256; ++m) {
+		unsigned k = 0;
+		for(unsigned j = 0; j < 8; ++j) {
+			table.lanes[m][j] = k;
+			k += (m >> j) & 1u;
+		}
+	}
+	return table;
+}
+
+constexpr LanePermutations4 make_compress_permutations4() noexcept {
+	LanePermutations4 table{};
+	for(unsigned m = 0; m < 16; ++m) {
+		unsigned k = 0;
+		for(unsigned j = 0; j < 4; ++j) {
+			if(m & (1u << j)) {
+				table.lanes[m][2 * k] = 2 * j;
+				table.lanes[m][2 * k + 1] = 2 * j + 1;
+				++k;
+			}
+		}
+	}
+	return table;
+}
+
+constexpr LanePermutations4 make_expand_permutations4() noexcept {
+	LanePermutations4 table{};
+	for(unsigned m = 0; m < 16; ++m) {
+		unsigned k = 0;
+		for(unsigned j = 0; j < 4; ++j) {
+			table.lanes[m][2 * j] = 2 * k;
+			table.lanes[m][2 * j + 1] = 2 * k + 1;
+			k += (m >> j) & 1u;
+		}
+	}
+	return table;
+}
+
+inline constexpr LanePermutations8 compress_permutations8 = make_compress_permutations8();
+inline constexpr LanePermutations8 expand_permutations8 = make_expand_permutations8();
+inline constexpr LanePermutations4 compress_permutations4 = make_compress_permutations4();
+inline constexpr LanePermutations4 expand_permutations4 = make_expand_permutations4();
+
+/* --- 4-byte payloads: each Optional<T> is one qword, flag in byte 4. --- */
+
+TIM_OPTIONAL_TARGET_AVX2
+inline KernelProgress compact32_avx2(
+	const unsigned char* in, std::size_t n, std::uint32_t* out, std::uint64_t* mask
+) noexcept {
+	const __m256i flag = _mm256_set1_epi64x(0xFFll << 32);
+	const __m256i values = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i zero = _mm256_setzero_si256();
+	std::size_t i = 0;
+	std::size_t k = 0;
+	for(; i + 8 <= n; i += 8) {
+		__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 8 * i));
+		__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 8 * i + 32));
+		unsigned empty = static_cast<unsigned>(
+			_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(a, flag), zero)))
+			| (_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(b, flag), zero))) << 4)
+		);
+		unsigned m = ~empty & 0xFFu;
+		__m256i v = _mm256_permute2x128_si256(
+			_mm256_permutevar8x32_epi32(a, values),
+			_mm256_permutevar8x32_epi32(b, values),
+			0x20
+		);
+		v = _mm256_permutevar8x32_epi32(
+			v, _mm256_load_si256(reinterpret_cast<const __m256i*>(compress_permutations8.lanes[m]))
+		);
+		int count = popcount(m);
+		_mm256_maskstore_epi32(
+			reinterpret_cast<int*>(out + k), _mm256_cmpgt_epi32(_mm256_set1_epi32(count), lanes), v
+		);
+		k += static_cast<std::size_t>(count);
+		bitmap_store_block(mask, i, m);
+	}
+	return KernelProgress{i, k};
+}
+
+TIM_OPTIONAL_TARGET_AVX2
+inline KernelProgress expand32_avx2(
+	const std::uint32_t* dense, const std::uint64_t* mask, std::size_t n, unsigned char* out
+) noexcept {
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+	const __m256i flag = _mm256_set1_epi64x(1ll << 32);
+	std::size_t i = 0;
+	std::size_t k = 0;
+	for(; i + 8 <= n; i += 8) {
+		unsigned m = bitmap_block(mask, i, 8);
+		int count = popcount(m);
+		__m256i v = _mm256_maskload_epi32(
+			reinterpret_cast<const int*>(dense + k), _mm256_cmpgt_epi32(_mm256_set1_epi32(count), lanes)
+		);
+		v = _mm256_permutevar8x32_epi32(
+			v, _mm256_load_si256(reinterpret_cast<const __m256i*>(expand_permutations8.lanes[m]))
+		);
+		__m256i present = _mm256_cmpeq_epi32(
+			_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(m)), bits), bits
+		);
+		v = _mm256_and_si256(v, present);
+		__m256i lo = _mm256_or_si256(
+			_mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)),
+			_mm256_and_si256(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(present)), flag)
+		);
+		__m256i hi = _mm256_or_si256(
+			_mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)),
+			_mm256_and_si256(_mm256_cvtepi32_epi64(_mm256_extracti128_si256(present, 1)), flag)
+		);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 8 * i), lo);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 8 * i + 32), hi);
+		k += static_cast<std::size_t>(count);
+	}
+	return KernelProgress{i, k};
+}
+
+// The compress-store forms of vpcompress are microcoded on some cores, so the
+// AVX-512 kernels compress in a register and follow with a masked store.
+TIM_OPTIONAL_TARGET_AVX512
+inline KernelProgress compact32_avx512(
+	const unsigned char* in, std::size_t n, std::uint32_t* out, std::uint64_t* mask
+) noexcept {
+	const __m512i flag = _mm512_set1_epi64(0xFFll << 32);
+	std::size_t i = 0;
+	std::size_t k = 0;
+	for(; i + 16 <= n; i += 16) {
+		__m512i a = _mm512_loadu_si512(in + 8 * i);
+		__m512i b = _mm512_loadu_si512(in + 8 * i + 64);
+		unsigned m = unsigned(_mm512_test_epi64_mask(a, flag))
+			| (unsigned(_mm512_test_epi64_mask(b, flag)) << 8);
+		__m512i v = _mm512_inserti64x4(
+			_mm512_castsi256_si512(_mm512_cvtepi64_epi32(a)), _mm512_cvtepi64_epi32(b), 1
+		);
+		int count = popcount(m);
+		_mm512_mask_storeu_epi32(
+			out + k,
+			static_cast<__mmask16>(bitmap_low_mask(static_cast<std::size_t>(count))),
+			_mm512_maskz_compress_epi32(static_cast<__mmask16>(m), v)
+		);
+		k += static_cast<std::size_t>(count);
+		bitmap_store_block(mask, i, m);
+	}
+	return KernelProgress{i, k};
+}
+
+TIM_OPTIONAL_TARGET_AVX512
+inline KernelProgress expand32_avx512(
+	const std::uint32_t* dense, const std::uint64_t* mask, std::size_t n, unsigned char* out
+) noexcept {
+	const __m512i flag = _mm512_set1_epi64(1ll << 32);
+	std::size_t i = 0;
+	std::size_t k = 0;
+	for(; i + 16 <= n; i += 16) {
+		unsigned m = bitmap_block(mask, i, 16);
+		int count = popcount(m);
+		__m512i v = _mm512_maskz_expand_epi32(
+			static_cast<__mmask16>(m),
+			_mm512_maskz_loadu_epi32(static_cast<__mmask16>(bitmap_low_mask(static_cast<std::size_t>(count))), dense + k)
+		);
+		__m512i lo = _mm512_cvtepu32_epi64(_mm512_castsi512_si256(v));
+		__m512i hi = _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(v, 1));
+		lo = _mm512_mask_or_epi64(lo, static_cast<__mmask8>(m), lo, flag);
+		hi = _mm512_mask_or_epi64(hi, static_cast<__mmask8>(m >> 8), hi, flag);
+		_mm512_storeu_si512(out + 8 * i, lo);
+		_mm512_storeu_si512(out + 8 * i + 64, hi);
+		k += static_cast<std::size_t>(count);
+	}
+	return KernelProgress{i, k};
+}
+
+/* --- 8-byte payloads: each Optional<T> is two qwords, flag in byte 8. --- */
+
+TIM_OPTIONAL_TARGET_AVX2
+inline KernelProgress compact64_avx2(
+	const unsigned char* in, std::size_t n, std::uint64_t* out, std::uint64_t* mask
+) noexcept {
+	const __m256i flag = _mm256_set1_epi64x(0xFF);
+	const __m256i lanes = _mm256_setr_epi64x(0, 1, 2, 3);
+	const __m256i zero = _mm256_setzero_si256();
+	std::size_t i = 0;
+	std::size_t k = 0;
+	for(; i + 4 <= n; i += 4) {
+		__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 16 * i));
+		__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 16 * i + 32));
+		// unpack{lo,hi} interleave within 128-bit halves; 0xD8 puts them back in order.
+		__m256i v = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(a, b), 0xD8);
+		__m256i f = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(a, b), 0xD8);
+		unsigned m = ~static_cast<unsigned>(
+			_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(f, flag), zero)))
+		) & 0xFu;
+		v = _mm256_permutevar8x32_epi32(
+			v, _mm256_load_si256(reinterpret_cast<const __m256i*>(compress_permutations4.lanes[m]))
+		);
+		int count = popcount(m);
+		_mm256_maskstore_epi64(
+			reinterpret_cast<long long*>(out + k), _mm256_cmpgt_epi64(_mm256_set1_epi64x(count), lanes), v
+		);
+		k += static_cast<std::size_t>(count);
+		bitmap_store_block(mask, i, m);
+	}
+	return KernelProgress{i, k};
+}
+
+TIM_OPTIONAL_TARGET_AVX2
+inline KernelProgress expand64_avx2(
+	const std::uint64_t* dense, const std::uint64_t* mask, std::size_t n, unsigned char* out
+) noexcept {
+	const __m256i lanes = _mm256_setr_epi64x(0, 1, 2, 3);
+	const __m256i bits = _mm256_setr_epi64x(1, 2, 4, 8);
+	const __m256i one = _mm256_set1_epi64x(1);
+	std::size_t i = 0;
+	std::size_t k = 0;
+	for(; i + 4 <= n; i += 4) {
+		unsigned m = bitmap_block(mask, i, 4);
+		int count = popcount(m);
+		__m256i v = _mm256_maskload_epi64(
+			reinterpret_cast<const long long*>(dense + k), _mm256_cmpgt_epi64(_mm256_set1_epi64x(count), lanes)
+		);
+		v = _mm256_permutevar8x32_epi32(
+			v, _mm256_load_si256(reinterpret_cast<const __m256i*>(expand_permutations4.lanes[m]))
+		);
+		__m256i present = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(m), bits), bits);
+		v = _mm256_and_si256(v, present);
+		__m256i f = _mm256_and_si256(present, one);
+		__m256i lo = _mm256_unpacklo_epi64(v, f);
+		__m256i hi = _mm256_unpackhi_epi64(v, f);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 16 * i), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 16 * i + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+		k += static_cast<std::size_t>(count);
+	}
+	return KernelProgress{i, k};
+}
+
+TIM_OPTIONAL_TARGET_AVX512
+inline KernelProgress compact64_avx512(
+	const unsigned char* in, std::size_t n, std::uint64_t* out, std::uint64_t* mask
+) noexcept {
+	const __m512i flag = _mm512_set1_epi64(0xFF);
+	const __m512i values = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+	const __m512i flags = _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15);
+	std::size_t i = 0;
+	std::size_t k = 0;
+	for(; i + 8 <= n; i += 8) {
+		__m512i a = _mm512_loadu_si512(in + 16 * i);
+		__m512i b = _mm512_loadu_si512(in + 16 * i + 64);
+		unsigned m = _mm512_test_epi64_mask(_mm512_permutex2var_epi64(a, flags, b), flag);
+		int count = popcount(m);
+		_mm512_mask_storeu_epi64(
+			out + k,
+			static_cast<__mmask8>(bitmap_low_mask(static_cast<std::size_t>(count))),
+			_mm512_maskz_compress_epi64(static_cast<__mmask8>(m), _mm512_permutex2var_epi64(a, values, b))
+		);
+		k += static_cast<std::size_t>(count);
+		bitmap_store_block(mask, i, m);
+	}
+	return KernelProgress{i, k};
+}
+
+TIM_OPTIONAL_TARGET_AVX512
+inline KernelProgress expand64_avx512(
+	const std::uint64_t* dense, const std::uint64_t* mask, std::size_t n, unsigned char* out
+) noexcept {
+	const __m512i one = _mm512_set1_epi64(1);
+	const __m512i lo_lanes = _mm512_setr_epi64(0, 8, 1, 9, 2, 10, 3, 11);
+	const __m512i hi_lanes = _mm512_setr_epi64(4, 12, 5, 13, 6, 14, 7, 15);
+	std::size_t i = 0;
+	std::size_t k = 0;
+	for(; i + 8 <= n; i += 8) {
+		unsigned m = bitmap_block(mask, i, 8);
+		int count = popcount(m);
+		__m512i v = _mm512_maskz_expand_epi64(
+			static_cast<__mmask8>(m),
+			_mm512_maskz_loadu_epi64(static_cast<__mmask8>(bitmap_low_mask(static_cast<std::size_t>(count))), dense + k)
+		);
+		__m512i f = _mm512_maskz_mov_epi64(static_cast<__mmask8>(m), one);
+		_mm512_storeu_si512(out + 16 * i, _mm512_permutex2var_epi64(v, lo_lanes, f));
+		_mm512_storeu_si512(out + 16 * i + 64, _mm512_permutex2var_epi64(v, hi_lanes, f));
+		k += static_cast<std::size_t>(count);
+	}
+	return KernelProgress{i, k};
+}
+
+/*
+ * fill_missing: 'out[i] = in[i].value_or(fallback)', or in place, engaging
+ * every empty optional with 'fallback'.  The flags come from the same
+ * contiguous loads as the values; the in-place kernels store only the lanes
+ * of empty elements.
+ */
+
+TIM_OPTIONAL_TARGET_AVX2
+inline std::size_t fill32_avx2(
+	const unsigned char* in, std::size_t n, std::uint32_t fallback, std::uint32_t* out
+) noexcept {
+	const __m256i flag = _mm256_set1_epi64x(0xFFll << 32);
+	const __m256i values = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i fill = _mm256_set1_epi32(static_cast<int>(fallback));
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8) {
+		__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 8 * i));
+		__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 8 * i + 32));
+		__m256i empty = _mm256_permute2x128_si256(
+			_mm256_permutevar8x32_epi32(_mm256_cmpeq_epi64(_mm256_and_si256(a, flag), zero), values),
+			_mm256_permutevar8x32_epi32(_mm256_cmpeq_epi64(_mm256_and_si256(b, flag), zero), values),
+			0x20
+		);
+		__m256i v = _mm256_permute2x128_si256(
+			_mm256_permutevar8x32_epi32(a, values),
+			_mm256_permutevar8x32_epi32(b, values),
+			0x20
+		);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_blendv_epi8(v, fill, empty));
+	}
+	return i;
+}
+
+TIM_OPTIONAL_TARGET_AVX2
+inline std::size_t fill32_in_place_avx2(unsigned char* data, std::size_t n, std::uint32_t fallback) noexcept {
+	const __m256i flag = _mm256_set1_epi64x(0xFFll << 32);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i fill = _mm256_set1_epi64x(static_cast<long long>(fallback | (std::uint64_t(1) << 32)));
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		auto* p = reinterpret_cast<long long*>(data + 8 * i);
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+		_mm256_maskstore_epi64(p, _mm256_cmpeq_epi64(_mm256_and_si256(v, flag), zero), fill);
+	}
+	return i;
+}
+
+TIM_OPTIONAL_TARGET_AVX512
+inline std::size_t fill32_avx512(
+	const unsigned char* in, std::size_t n, std::uint32_t fallback, std::uint32_t* out
+) noexcept {
+	const __m512i flag = _mm512_set1_epi64(0xFFll << 32);
+	const __m512i fill = _mm512_set1_epi32(static_cast<int>(fallback));
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16) {
+		__m512i a = _mm512_loadu_si512(in + 8 * i);
+		__m512i b = _mm512_loadu_si512(in + 8 * i + 64);
+		unsigned m = unsigned(_mm512_test_epi64_mask(a, flag))
+			| (unsigned(_mm512_test_epi64_mask(b, flag)) << 8);
+		__m512i v = _mm512_inserti64x4(
+			_mm512_castsi256_si512(_mm512_cvtepi64_epi32(a)), _mm512_cvtepi64_epi32(b), 1
+		);
+		_mm512_storeu_si512(out + i, _mm512_mask_blend_epi32(static_cast<__mmask16>(m), fill, v));
+	}
+	return i;
+}
+
+TIM_OPTIONAL_TARGET_AVX512
+inline std::size_t fill32_in_place_avx512(unsigned char* data, std::size_t n, std::uint32_t fallback) noexcept {
+	const __m512i flag = _mm512_set1_epi64(0xFFll << 32);
+	const __m512i fill = _mm512_set1_epi64(static_cast<long long>(fallback | (std::uint64_t(1) << 32)));
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8) {
+		unsigned char* p = data + 8 * i;
+		_mm512_mask_storeu_epi64(p, _mm512_testn_epi64_mask(_mm512_loadu_si512(p), flag), fill);
+	}
+	return i;
+}
+
+TIM_OPTIONAL_TARGET_AVX2
+inline std::size_t fill64_avx2(
+	const unsigned char* in, std::size_t n, std::uint64_t fallback, std::uint64_t* out
+) noexcept {
+	const __m256i flag = _mm256_set1_epi64x(0xFF);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i fill = _mm256_set1_epi64x(static_cast<long long>(fallback));
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 16 * i));
+		__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 16 * i + 32));
+		__m256i v = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(a, b), 0xD8);
+		__m256i f = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(a, b), 0xD8);
+		__m256i empty = _mm256_cmpeq_epi64(_mm256_and_si256(f, flag), zero);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_blendv_epi8(v, fill, empty));
+	}
+	return i;
+}
+
+TIM_OPTIONAL_TARGET_AVX2
+inline std::size_t fill64_in_place_avx2(unsigned char* data, std::size_t n, std::uint64_t fallback) noexcept {
+	const __m256i flag = _mm256_set1_epi64x(0xFF);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i fill = _mm256_setr_epi64x(static_cast<long long>(fallback), 1, static_cast<long long>(fallback), 1);
+	std::size_t i = 0;
+	for(; i + 2 <= n; i += 2) {
+		auto* p = reinterpret_cast<long long*>(data + 16 * i);
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+		// Copy each element's flag qword over its value qword, then test both.
+		__m256i f = _mm256_shuffle_epi32(v, 0xEE);
+		_mm256_maskstore_epi64(p, _mm256_cmpeq_epi64(_mm256_and_si256(f, flag), zero), fill);
+	}
+	return i;
+}
+
+TIM_OPTIONAL_TARGET_AVX512
+inline std::size_t fill64_avx512(
+	const unsigned char* in, std::size_t n, std::uint64_t fallback, std::uint64_t* out
+) noexcept {
+	const __m512i flag = _mm512_set1_epi64(0xFF);
+	const __m512i fill = _mm512_set1_epi64(static_cast<long long>(fallback));
+	const __m512i values = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+	const __m512i flags = _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15);
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8) {
+		__m512i a = _mm512_loadu_si512(in + 16 * i);
+		__m512i b = _mm512_loadu_si512(in + 16 * i + 64);
+		__mmask8 m = _mm512_test_epi64_mask(_mm512_permutex2var_epi64(a, flags, b), flag);
+		_mm512_storeu_si512(out + i, _mm512_mask_blend_epi64(m, fill, _mm512_permutex2var_epi64(a, values, b)));
+	}
+	return i;
+}
+
+TIM_OPTIONAL_TARGET_AVX512
+inline std::size_t fill64_in_place_avx512(unsigned char* data, std::size_t n, std::uint64_t fallback) noexcept {
+	const __m512i flag = _mm512_set_epi64(0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0);
+	const __m512i fill = _mm512_set_epi64(
+		1, static_cast<long long>(fallback), 1, static_cast<long long>(fallback),
+		1, static_cast<long long>(fallback), 1, static_cast<long long>(fallback)
+	);
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		unsigned char* p = data + 16 * i;
+		// Present bits land on the odd (flag) lanes; widen each to its pair.
+		unsigned present = _mm512_test_epi64_mask(_mm512_loadu_si512(p), flag);
+		present |= present >> 1;
+		_mm512_mask_storeu_epi64(p, static_cast<__mmask8>(~present), fill);
+	}
+	return i;
+}
+
+#endif /* TIM_OPTIONAL_HAS_X86_KERNELS */
+
+template <class T>
+using packed_lane_t = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+
+// Runs the block kernel for 'isa' over a packed range.  Scalar does nothing.
+template <class T>
+KernelProgress compact_packed_blocks(
+	SimdIsa isa, const Optional<T>* in, std::size_t n, T* out, std::uint64_t* mask
+) noexcept {
+	static_assert(optional_is_packed_v<T>);
+#if TIM_OPTIONAL_HAS_X86_KERNELS
+	const auto* bytes = reinterpret_cast<const unsigned char*>(in);
+	auto* lanes = reinterpret_cast<packed_lane_t<T>*>(out);
+	if constexpr(sizeof(T) == 4) {
+		switch(isa) {
+		case SimdIsa::Avx512: return compact32_avx512(bytes, n, lanes, mask);
+		case SimdIsa::Avx2: return compact32_avx2(bytes, n, lanes, mask);
+		case SimdIsa::Scalar: break;
+		}
+	} else {
+		switch(isa) {
+		case SimdIsa::Avx512: return compact64_avx512(bytes, n, lanes, mask);
+		case SimdIsa::Avx2: return compact64_avx2(bytes, n, lanes, mask);
+		case SimdIsa::Scalar: break;
+		}
+	}
+#else
+	(void)isa, (void)in, (void)n, (void)out, (void)mask;
+#endif
+	return KernelProgress{0, 0};
+}
+
+template <class T>
+KernelProgress expand_packed_blocks(
+	SimdIsa isa, const T* dense, const std::uint64_t* mask, std::size_t n, Optional<T>* out
+) noexcept {
+	static_assert(optional_is_packed_v<T>);
+#if TIM_OPTIONAL_HAS_X86_KERNELS
+	const auto* lanes = reinterpret_cast<const packed_lane_t<T>*>(dense);
+	auto* bytes = reinterpret_cast<unsigned char*>(out);
+	if constexpr(sizeof(T) == 4) {
+		switch(isa) {
+		case SimdIsa::Avx512: return expand32_avx512(lanes, mask, n, bytes);
+		case SimdIsa::Avx2: return expand32_avx2(lanes, mask, n, bytes);
+		case SimdIsa::Scalar: break;
+		}
+	} else {
+		switch(isa) {
+		case SimdIsa::Avx512: return expand64_avx512(lanes, mask, n, bytes);
+		case SimdIsa::Avx2: return expand64_avx2(lanes, mask, n, bytes);
+		case SimdIsa::Scalar: break;
+		}
+	}
+#else
+	(void)isa, (void)dense, (void)mask, (void)n, (void)out;
+#endif
+	return KernelProgress{0, 0};
+}
+
+template <class T>
+packed_lane_t<T> packed_lane_bits(const T& value) noexcept {
+	packed_lane_t<T> bits;
+	std::memcpy(&bits, std::addressof(value), sizeof(T));
+	return bits;
+}
+
+// Both return the number of leading elements handled.
+template <class T>
+std::size_t fill_packed_blocks(
+	SimdIsa isa, const Optional<T>* in, std::size_t n, const T& fallback, T* out
+) noexcept {
+	static_assert(optional_is_packed_v<T>);
+#if TIM_OPTIONAL_HAS_X86_KERNELS
+	const auto* bytes = reinterpret_cast<const unsigned char*>(in);
+	auto* lanes = reinterpret_cast<packed_lane_t<T>*>(out);
+	auto fill = packed_lane_bits(fallback);
+	if constexpr(sizeof(T) == 4) {
+		switch(isa) {
+		case SimdIsa::Avx512: return fill32_avx512(bytes, n, fill, lanes);
+		case SimdIsa::Avx2: return fill32_avx2(bytes, n, fill, lanes);
+		case SimdIsa::Scalar: break;
+		}
+	} else {
+		switch(isa) {
+		case SimdIsa::Avx512: return fill64_avx512(bytes, n, fill, lanes);
+		case SimdIsa::Avx2: return fill64_avx2(bytes, n, fill, lanes);
+		case SimdIsa::Scalar: break;
+		}
+	}
+#else
+	(void)isa, (void)in, (void)n, (void)fallback, (void)out;
+#endif
+	return 0;
+}
+
+template <class T>
+std::size_t fill_packed_blocks_in_place(SimdIsa isa, Optional<T>* data, std::size_t n, const T& fallback) noexcept {
+	static_assert(optional_is_packed_v<T>);
+#if TIM_OPTIONAL_HAS_X86_KERNELS
+	auto* bytes = reinterpret_cast<unsigned char*>(data);
+	auto fill = packed_lane_bits(fallback);
+	if constexpr(sizeof(T) == 4) {
+		switch(isa) {
+		case SimdIsa::Avx512: return fill32_in_place_avx512(bytes, n, fill);
+		case SimdIsa::Avx2: return fill32_in_place_avx2(bytes, n, fill);
+		case SimdIsa::Scalar: break;
+		}
+	} else {
+		switch(isa) {
+		case SimdIsa::Avx512: return fill64_in_place_avx512(bytes, n, fill);
+		case SimdIsa::Avx2: return fill64_in_place_avx2(bytes, n, fill);
+		case SimdIsa::Scalar: break;
+		}
+	}
+#else
+	(void)isa, (void)data, (void)n, (void)fallback;
+#endif
+	return 0;
+}
+
+} /* namespace detail */
+
+} /* inline namespace optional */
+
+} /* namespace tim */
+
+#endif /* TIM_OPTIONAL_DETAIL_PACKEDKERNELS_HPP */
@@ -0,0 +1,170 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <OptionalAlgorithms>
+
+// template <class InputIt, class OutputIt>
+//   OutputIt compact(InputIt first, InputIt last, OutputIt out);
+// template <class T>
+//   const T* expand(const T* dense, const uint64_t* mask, Optional<T>* first, Optional<T>* last);
+
+#include "tim/optional/OptionalAlgorithms.hpp"
+#include <type_traits>
+#include <stdexcept>
+#include <list>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::nullopt;
+using tim::detail::SimdIsa;
+
+static_assert(tim::detail::optional_is_packed_v<int>, "");
+static_assert(tim::detail::optional_is_packed_v<float>, "");
+static_assert(tim::detail::optional_is_packed_v<std::int64_t>, "");
+static_assert(tim::detail::optional_is_packed_v<double>, "");
+static_assert(!tim::detail::optional_is_packed_v<char>, "");
+static_assert(!tim::detail::optional_is_packed_v<int*>, "");
+static_assert(!tim::detail::optional_is_packed_v<std::string>, "");
+
+constexpr SimdIsa isas[] = {SimdIsa::Scalar, SimdIsa::Avx2, SimdIsa::Avx512};
+
+// Deterministic presence patterns: all, none, alternating and pseudo-random.
+bool engaged(unsigned pattern, std::size_t i)
+{
+    switch (pattern) {
+    case 0: return true;
+    case 1: return false;
+    case 2: return i % 2 == 0;
+    default: return ((i * 2654435761u) >> (pattern + 3)) & 1u;
+    }
+}
+
+template <class T>
+void test_round_trip(SimdIsa isa)
+{
+    for (std::size_t n : {0u, 1u, 3u, 4u, 7u, 8u, 15u, 16u, 17u, 63u, 64u, 65u, 200u, 1031u}) {
+        for (unsigned pattern = 0; pattern < 6; ++pattern) {
+            std::vector<Optional<T>> in(n);
+            std::vector<T> expected;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (engaged(pattern, i)) {
+                    in[i] = static_cast<T>(i * 3 + 1);
+                    expected.push_back(static_cast<T>(i * 3 + 1));
+                }
+            }
+            // Sentinels catch writes past the compacted values.
+            std::vector<T> out(n + 1, static_cast<T>(-7));
+            std::vector<std::uint64_t> mask(tim::detail::bitmap_word_count(n) + 1, ~std::uint64_t(0));
+            std::size_t count = tim::detail::compact_with(isa, in.data(), n, out.data(), mask.data());
+            assert(count == expected.size());
+            for (std::size_t k = 0; k < count; ++k)
+                assert(out[k] == expected[k]);
+            assert(out[count] == static_cast<T>(-7));
+            for (std::size_t i = 0; i < n; ++i)
+                assert(((mask[i / 64] >> (i % 64)) & 1u) == (engaged(pattern, i) ? 1u : 0u));
+            assert(mask.back() == ~std::uint64_t(0));
+
+            std::vector<Optional<T>> back(n + 1, Optional<T>(static_cast<T>(-7)));
+            std::size_t read = tim::detail::expand_with(isa, out.data(), mask.data(), n, back.data());
+            assert(read == count);
+            for (std::size_t i = 0; i < n; ++i)
+                assert(back[i] == in[i]);
+            assert(back[n] == static_cast<T>(-7));
+        }
+    }
+}
+
+void test_kernels()
+{
+    for (SimdIsa isa : isas) {
+        if (!tim::detail::simd_isa_supported(isa))
+            continue;
+        test_round_trip<int>(isa);
+        test_round_trip<unsigned>(isa);
+        test_round_trip<float>(isa);
+        test_round_trip<std::int64_t>(isa);
+        test_round_trip<double>(isa);
+        test_round_trip<char>(isa);
+        test_round_trip<short>(isa);
+    }
+}
+
+void test_public_api()
+{
+    {
+        const Optional<int> in[] = {1, nullopt, 3, nullopt, nullopt, 6};
+        int out[6] = {};
+        int* end = tim::compact(std::begin(in), std::end(in), out);
+        assert(end == out + 3);
+        assert(out[0] == 1 && out[1] == 3 && out[2] == 6);
+
+        std::uint64_t mask = 0;
+        end = tim::compact(std::begin(in), std::end(in), out, &mask);
+        assert(end == out + 3 && mask == 0x25u);
+
+        Optional<int> back[6];
+        const int* last = tim::expand(out, &mask, std::begin(back), std::end(back));
+        assert(last == out + 3);
+        for (int i = 0; i < 6; ++i)
+            assert(back[i] == in[i]);
+    }
+    {
+        std::vector<Optional<std::string>> in{std::string("a"), nullopt, std::string("c")};
+        std::vector<std::string> out{"x"};
+        tim::compact(in, out);
+        assert((out == std::vector<std::string>{"x", "a", "c"}));
+
+        std::list<Optional<double>> list{1.5, nullopt, 2.5};
+        std::vector<double> values;
+        tim::compact(list, values);
+        assert((values == std::vector<double>{1.5, 2.5}));
+    }
+    {
+        int x = 1, y = 2;
+        std::vector<Optional<int*>> in{&x, nullopt, &y};
+        std::vector<int*> out;
+        tim::compact(in, out);
+        assert(out.size() == 2 && out[0] == &x && out[1] == &y);
+    }
+    {
+        std::vector<double> dense{1.0, 2.0};
+        std::vector<std::uint64_t> mask{0x9u};
+        std::vector<Optional<double>> out(4, 5.0);
+        tim::expand(dense, mask, out);
+        assert(out[0] == 1.0 && !out[1] && !out[2] && out[3] == 2.0);
+
+#ifndef TEST_HAS_NO_EXCEPTIONS
+        std::vector<std::uint64_t> too_many{0xFu};
+        try {
+            tim::expand(dense, too_many, out);
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+        std::vector<std::uint64_t> too_short;
+        try {
+            tim::expand(dense, too_short, out);
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+#endif
+    }
+}
+
+int main(int, char**)
+{
+    test_kernels();
+    test_public_api();
+
+  return 0;
+}
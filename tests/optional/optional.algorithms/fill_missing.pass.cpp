@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <OptionalAlgorithms>
+
+// template <class InputIt, class U, class OutputIt>
+//   OutputIt fill_missing(InputIt first, InputIt last, const U& fallback, OutputIt out);
+// template <class ForwardIt, class U>
+//   void fill_missing(ForwardIt first, ForwardIt last, const U& fallback);
+
+#include "tim/optional/OptionalAlgorithms.hpp"
+#include <type_traits>
+#include <stdexcept>
+#include <list>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::nullopt;
+using tim::detail::SimdIsa;
+
+constexpr SimdIsa isas[] = {SimdIsa::Scalar, SimdIsa::Avx2, SimdIsa::Avx512};
+
+bool engaged(unsigned pattern, std::size_t i)
+{
+    switch (pattern) {
+    case 0: return true;
+    case 1: return false;
+    case 2: return i % 2 == 0;
+    default: return ((i * 2654435761u) >> (pattern + 3)) & 1u;
+    }
+}
+
+template <class T>
+void test_kernels(SimdIsa isa)
+{
+    const T fallback = static_cast<T>(-5);
+    for (std::size_t n : {0u, 1u, 2u, 3u, 4u, 7u, 8u, 9u, 15u, 16u, 17u, 100u, 1031u}) {
+        for (unsigned pattern = 0; pattern < 6; ++pattern) {
+            std::vector<Optional<T>> in(n + 1);
+            for (std::size_t i = 0; i < n; ++i) {
+                if (engaged(pattern, i))
+                    in[i] = static_cast<T>(i + 1);
+            }
+            in[n] = static_cast<T>(99);
+
+            std::vector<T> out(n + 1, static_cast<T>(42));
+            tim::detail::fill_missing_with(isa, in.data(), n, fallback, out.data());
+            for (std::size_t i = 0; i < n; ++i)
+                assert(out[i] == (engaged(pattern, i) ? static_cast<T>(i + 1) : fallback));
+            assert(out[n] == static_cast<T>(42));
+
+            // The element past the end is left alone, including its flag.
+            in[n] = nullopt;
+            tim::detail::fill_missing_in_place_with(isa, in.data(), n, fallback);
+            for (std::size_t i = 0; i < n; ++i) {
+                assert(in[i].has_value());
+                assert(*in[i] == (engaged(pattern, i) ? static_cast<T>(i + 1) : fallback));
+            }
+            assert(!in[n]);
+        }
+    }
+}
+
+void test_public_api()
+{
+    {
+        const Optional<double> in[] = {1.5, nullopt, 2.5, nullopt};
+        double out[4] = {};
+        double* end = tim::fill_missing(std::begin(in), std::end(in), 0.0, out);
+        assert(end == out + 4);
+        assert(out[0] == 1.5 && out[1] == 0.0 && out[2] == 2.5 && out[3] == 0.0);
+    }
+    {
+        std::vector<Optional<int>> in{1, nullopt, 3};
+        std::vector<int> out(3);
+        tim::fill_missing(in, -1, out);
+        assert((out == std::vector<int>{1, -1, 3}));
+
+        tim::fill_missing(in, 7);
+        assert(in[0] == 1 && in[1] == 7 && in[2] == 3);
+
+#ifndef TEST_HAS_NO_EXCEPTIONS
+        std::vector<int> too_short(2);
+        try {
+            tim::fill_missing(in, 0, too_short);
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+#endif
+    }
+    {
+        std::list<Optional<std::string>> in{std::string("a"), nullopt};
+        std::vector<std::string> out(2);
+        tim::fill_missing(in, "none", out);
+        assert(out[0] == "a" && out[1] == "none");
+
+        tim::fill_missing(in.begin(), in.end(), std::string("z"));
+        assert(*in.back() == "z");
+    }
+}
+
+int main(int, char**)
+{
+    for (SimdIsa isa : isas) {
+        if (!tim::detail::simd_isa_supported(isa))
+            continue;
+        test_kernels<int>(isa);
+        test_kernels<float>(isa);
+        test_kernels<std::int64_t>(isa);
+        test_kernels<double>(isa);
+        test_kernels<short>(isa);
+    }
+    test_public_api();
+
+  return 0;
+}
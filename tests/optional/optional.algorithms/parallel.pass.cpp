@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <OptionalAlgorithms>
+
+// template <class Policy, class It, class F>
+//   void for_each_present(Policy&& policy, It first, It last, F f);
+// template <class Policy, class It>
+//   size_t count_present(Policy&& policy, It first, It last);
+// template <class Policy, class InputIt, class OutputIt, class F>
+//   OutputIt transform_present(Policy&& policy, InputIt first, InputIt last, OutputIt out, F f);
+
+#include "tim/optional/OptionalAlgorithms.hpp"
+#include <type_traits>
+#include <atomic>
+#include <list>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::nullopt;
+using tim::WorkStealingPool;
+namespace execution = tim::execution;
+
+static_assert(execution::is_execution_policy_v<const execution::parallel_policy&>, "");
+static_assert(!execution::is_execution_policy_v<int*>, "");
+
+void test_pool()
+{
+    for (unsigned threads : {1u, 2u, 3u, 8u}) {
+        WorkStealingPool pool(threads);
+        assert(pool.thread_count() == threads);
+        for (std::size_t chunks : {0u, 1u, 5u, 1000u}) {
+            std::vector<std::atomic<int>> hits(chunks);
+            for (int round = 0; round < 3; ++round) {
+                pool.parallel_for(chunks, [&](std::size_t c) { hits[c].fetch_add(1); });
+            }
+            for (auto& h : hits)
+                assert(h.load() == 3);
+        }
+        // Nested calls run inline instead of deadlocking.
+        std::atomic<int> inner{0};
+        pool.parallel_for(4, [&](std::size_t) {
+            pool.parallel_for(3, [&](std::size_t) { inner.fetch_add(1); });
+        });
+        assert(inner.load() == 12);
+#ifndef TEST_HAS_NO_EXCEPTIONS
+        try {
+            pool.parallel_for(64, [](std::size_t c) {
+                if (c == 17)
+                    throw std::runtime_error("chunk");
+            });
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        // The pool is still usable afterwards.
+        std::atomic<int> after{0};
+        pool.parallel_for(10, [&](std::size_t) { after.fetch_add(1); });
+        assert(after.load() == 10);
+#endif
+    }
+}
+
+void test_chunk_plan()
+{
+    alignas(64) static unsigned char buffer[64 * 1024];
+    for (std::size_t element_size : {1u, 8u, 16u, 24u, 40u, 128u}) {
+        for (std::size_t offset : {0u, 8u, 24u}) {
+            const unsigned char* base = buffer + offset;
+            for (std::size_t n : {0u, 1u, 1000u, 5000u, 100000u}) {
+                auto plan = tim::detail::plan_chunks(base, element_size, n, 4);
+                assert(plan.begin(0) == 0 && plan.end(plan.chunks - 1) == n);
+                for (std::size_t c = 0; c + 1 < plan.chunks; ++c) {
+                    assert(plan.begin(c) < plan.end(c));
+                    std::size_t boundary = plan.end(c);
+                    if (offset % std::gcd(element_size, std::size_t(64)) == 0)
+                        assert(reinterpret_cast<std::uintptr_t>(base + boundary * element_size) % 64 == 0);
+                }
+            }
+        }
+    }
+}
+
+void test_algorithms()
+{
+    const std::size_t n = 100003;
+    std::vector<Optional<int>> in(n);
+    std::size_t expected_count = 0;
+    long long expected_sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i % 3 != 0) {
+            in[i] = static_cast<int>(i);
+            ++expected_count;
+            expected_sum += static_cast<long long>(i);
+        }
+    }
+    for (unsigned threads : {1u, 2u, 5u}) {
+        WorkStealingPool pool(threads);
+        auto par = execution::par.on(pool);
+
+        assert(tim::count_present(par, in) == expected_count);
+        assert(tim::count_present(execution::seq, in.begin(), in.end()) == expected_count);
+
+        std::atomic<long long> sum{0};
+        tim::for_each_present(par, in, [&](int v) { sum.fetch_add(v, std::memory_order_relaxed); });
+        assert(sum.load() == expected_sum);
+
+        std::atomic<bool> indices_match{true};
+        tim::for_each_present(par, in.begin(), in.end(), [&](std::size_t i, int v) {
+            if (static_cast<std::size_t>(v) != i)
+                indices_match.store(false);
+        });
+        assert(indices_match.load());
+
+        std::vector<Optional<long long>> out(n, 7LL);
+        auto end = tim::transform_present(par, in.data(), in.data() + n, out.data(), [](int v) { return 2LL * v; });
+        assert(end == out.data() + n);
+        for (std::size_t i = 0; i < n; ++i)
+            assert(in[i] ? (out[i] && *out[i] == 2LL * *in[i]) : !out[i]);
+
+        // Mutating through for_each_present writes disjoint elements only.
+        std::vector<Optional<int>> copy = in;
+        tim::for_each_present(par, copy, [](int& v) { v += 1; });
+        for (std::size_t i = 0; i < n; ++i)
+            assert(in[i] ? *copy[i] == *in[i] + 1 : !copy[i]);
+    }
+    {
+        std::list<Optional<std::string>> list{std::string("a"), nullopt, std::string("c")};
+        assert(tim::count_present(execution::par, list) == 2);
+        std::vector<Optional<std::size_t>> sizes(3);
+        tim::transform_present(execution::par, list, sizes, [](const std::string& s) { return s.size(); });
+        assert(sizes[0] == 1u && !sizes[1] && sizes[2] == 1u);
+        std::string joined;
+        tim::for_each_present(execution::par, list, [&](const std::string& s) { joined += s; });
+        assert(joined == "ac");
+#ifndef TEST_HAS_NO_EXCEPTIONS
+        std::vector<Optional<std::size_t>> too_short(2);
+        try {
+            tim::transform_present(execution::seq, list, too_short, [](const std::string& s) { return s.size(); });
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+#endif
+    }
+}
+
+int main(int, char**)
+{
+    test_pool();
+    test_chunk_plan();
+    test_algorithms();
+
+  return 0;
+}
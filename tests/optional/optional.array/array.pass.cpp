@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <OptionalArray>
+
+// template <class T, size_t N> struct OptionalArray;
+
+#include "tim/optional/OptionalArray.hpp"
+#include <type_traits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::OptionalArray;
+using tim::nullopt;
+using tim::BadOptionalAccess;
+
+struct Counted
+{
+    static int alive;
+    int i_;
+    Counted(int i) : i_(i) { ++alive; }
+    Counted(const Counted& other) : i_(other.i_) { ++alive; }
+    Counted& operator=(const Counted&) = default;
+    ~Counted() { --alive; }
+};
+
+int Counted::alive = 0;
+
+static_assert(sizeof(OptionalArray<int, 16>) == 16 * sizeof(int) + sizeof(std::uint64_t), "");
+static_assert(sizeof(OptionalArray<char, 64>) == 64 + sizeof(std::uint64_t), "");
+static_assert(std::is_trivially_copyable<OptionalArray<int, 8>>::value, "");
+static_assert(std::is_trivially_destructible<OptionalArray<int, 8>>::value, "");
+static_assert(!std::is_trivially_copyable<OptionalArray<std::string, 8>>::value, "");
+static_assert(std::is_copy_constructible<OptionalArray<std::string, 8>>::value, "");
+static_assert(std::is_copy_assignable<OptionalArray<std::string, 8>>::value, "");
+static_assert(!std::is_copy_constructible<OptionalArray<std::unique_ptr<int>, 8>>::value, "");
+static_assert(!std::is_copy_assignable<OptionalArray<std::unique_ptr<int>, 8>>::value, "");
+static_assert(std::is_move_constructible<OptionalArray<std::unique_ptr<int>, 8>>::value, "");
+static_assert(std::is_move_assignable<OptionalArray<std::unique_ptr<int>, 8>>::value, "");
+static_assert(std::is_nothrow_move_constructible<OptionalArray<std::unique_ptr<int>, 8>>::value, "");
+
+constexpr bool test_constexpr()
+{
+    constexpr OptionalArray<int, 8> a;
+    static_assert(a.empty() && a.count() == 0 && a.find_first_empty() == 0, "");
+    static_assert(a.find_first_present() == 8, "");
+
+    constexpr OptionalArray<int, 5> b{1, nullopt, Optional<int>(3), Optional<int>(), 5};
+    static_assert(b.mask() == 0x15, "");
+    static_assert(b.count() == 3 && !b.full(), "");
+    static_assert(b.has_value(0) && !b.has_value(1) && b.has_value(4), "");
+    static_assert(*b[2] == 3 && !b[3] && b.value(4) == 5, "");
+    static_assert(b.find_first_empty() == 1 && b.find_first_present() == 0, "");
+
+    constexpr OptionalArray<int, 2> full{1, 2};
+    static_assert(full.full() && full.find_first_empty() == 2, "");
+
+    constexpr OptionalArray<long, 64> wide{nullopt, nullopt, 7L};
+    static_assert(wide.count() == 1 && wide.find_first_present() == 2, "");
+
+    constexpr OptionalArray<int, 5> c = b;
+    int sum = 0;
+    c.for_each_present([&](int v) { sum += v; });
+    std::size_t index_sum = 0;
+    c.for_each_present([&](std::size_t i, const int&) { index_sum += i; });
+    return sum == 9 && index_sum == 6;
+}
+
+void test_mutation()
+{
+    OptionalArray<int, 64> a;
+    for (std::size_t i = 0; i < 64; i += 2)
+        a.emplace(i, static_cast<int>(i));
+    assert(a.count() == 32 && a.find_first_empty() == 1);
+    a.emplace(1, 100);
+    assert(a.find_first_empty() == 3);
+    a.reset(0);
+    a.reset(1);
+    assert(a.find_first_empty() == 0 && a.find_first_present() == 2);
+    *a[2] = 20;
+    assert(a.value(2) == 20);
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    try {
+        (void)a.value(1);
+        assert(false);
+    } catch (const BadOptionalAccess&) {
+    }
+#endif
+    std::vector<std::size_t> seen;
+    a.for_each_present([&](std::size_t i, int& v) { seen.push_back(i); v += 1; });
+    assert(seen.size() == 31 && seen.front() == 2 && seen.back() == 62);
+    assert(*a[62] == 63);
+    a.clear();
+    assert(a.empty());
+}
+
+void test_lifetimes()
+{
+    {
+        OptionalArray<Counted, 10> a{Counted(1), nullopt, Counted(3)};
+        assert(Counted::alive == 2);
+        a.emplace(5, 5);
+        a.emplace(5, 6);
+        assert(Counted::alive == 3 && a[5]->i_ == 6);
+        OptionalArray<Counted, 10> b(a);
+        assert(Counted::alive == 6);
+        b.reset(0);
+        b.emplace(1, 10);
+        a = b;
+        assert(Counted::alive == 6);
+        assert(!a[0] && a[1]->i_ == 10 && a[2]->i_ == 3 && a[5]->i_ == 6);
+        b.clear();
+        assert(Counted::alive == 3);
+    }
+    assert(Counted::alive == 0);
+    {
+        OptionalArray<std::unique_ptr<int>, 4> a;
+        a.emplace(1, new int(1));
+        a.emplace(3, new int(3));
+        OptionalArray<std::unique_ptr<int>, 4> b(std::move(a));
+        assert(b.count() == 2 && **b[3] == 3);
+        OptionalArray<std::unique_ptr<int>, 4> c;
+        c.emplace(0, new int(0));
+        swap(b, c);
+        assert(c.count() == 2 && b.count() == 1 && **b[0] == 0 && **c[1] == 1);
+        b = std::move(c);
+        assert(!b[0] && **b[1] == 1);
+    }
+    {
+        OptionalArray<std::string, 3> a{std::string("a"), nullopt, std::string("c")};
+        OptionalArray<std::string, 3> b{nullopt, std::string("y")};
+        a.swap(b);
+        assert(!a[0] && *a[1] == "y" && !a[2]);
+        assert(*b[0] == "a" && !b[1] && *b[2] == "c");
+    }
+}
+
+int main(int, char**)
+{
+    static_assert(test_constexpr(), "");
+    test_mutation();
+    test_lifetimes();
+
+  return 0;
+}
@@ -0,0 +1,208 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <AtomicOptional>
+
+// template <class T> class AtomicOptional;
+
+#include "tim/optional/AtomicOptional.hpp"
+#include <type_traits>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::AtomicOptional;
+using tim::nullopt;
+
+struct Padded
+{
+    char c;
+    int i;
+    friend bool operator==(const Padded& l, const Padded& r) { return l.c == r.c && l.i == r.i; }
+};
+
+// Three fields that writers keep consistent, so that readers can detect tearing.
+struct Triple
+{
+    std::uint32_t a;
+    std::uint32_t b;
+    std::uint32_t c;
+    static Triple make(std::uint32_t a) { return Triple{a, ~a, a * 3u}; }
+    bool consistent() const { return b == ~a && c == a * 3u; }
+    friend bool operator==(const Triple& l, const Triple& r) { return l.a == r.a && l.b == r.b && l.c == r.c; }
+};
+
+static_assert(sizeof(AtomicOptional<int>) == 8, "");
+static_assert(sizeof(AtomicOptional<double>) == 16, "");
+static_assert(sizeof(AtomicOptional<Triple>) == 16, "");
+#if defined(TIM_OPTIONAL_HAS_CMPXCHG16B)
+static_assert(AtomicOptional<int>::is_always_lock_free, "");
+static_assert(AtomicOptional<double>::is_always_lock_free, "");
+static_assert(AtomicOptional<Triple>::is_always_lock_free, "");
+#endif
+static_assert(!std::is_copy_constructible_v<AtomicOptional<int>>, "");
+static_assert(std::is_nothrow_default_constructible_v<AtomicOptional<int>>, "");
+
+template <class T>
+void test_basic(T a, T b)
+{
+    AtomicOptional<T> x;
+    assert(!x.load().has_value());
+    x.store(a);
+    assert(x.load() == a);
+
+    assert(x.exchange(b) == a);
+    assert(x.load() == b);
+    assert(x.exchange(nullopt) == b);
+    assert(!x.load());
+
+    // Empty -> engaged.
+    Optional<T> expected;
+    assert(x.compare_exchange_strong(expected, a));
+    assert(x.load() == a);
+    // A failed exchange reports the current value.
+    expected = b;
+    assert(!x.compare_exchange_strong(expected, nullopt));
+    assert(expected == a);
+    // Engaged -> empty.
+    assert(x.compare_exchange_strong(expected, nullopt));
+    assert(!x.load());
+    expected = a;
+    assert(!x.compare_exchange_strong(expected, b));
+    assert(!expected);
+    // Engaged -> engaged, with the weak form.
+    x.store(a);
+    expected = a;
+    while(!x.compare_exchange_weak(expected, b, std::memory_order_acq_rel)) {
+        assert(expected == a);
+    }
+    assert(x.load(std::memory_order_acquire) == b);
+
+    assert(!x.emplace_if_empty(a));
+    assert(x.take() == b);
+    assert(!x.take());
+    assert(x.emplace_if_empty(a));
+    assert(static_cast<Optional<T>>(x) == a);
+    x = nullopt;
+    assert(!x.load());
+    AtomicOptional<T> y(b);
+    assert(y.load() == b);
+}
+
+// Producers hand out distinct tokens through one slot, consumers take them:
+// each token must arrive exactly once.
+template <class T>
+void test_handoff()
+{
+    const unsigned producers = 2;
+    const unsigned consumers = 2;
+    const std::uint32_t per_producer = 20000;
+    AtomicOptional<T> slot;
+    std::vector<std::atomic<int>> seen(producers * per_producer);
+    std::atomic<std::uint32_t> taken{0};
+    std::vector<std::thread> threads;
+    for(unsigned p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            for(std::uint32_t i = 0; i < per_producer; ++i) {
+                T token = static_cast<T>(p * per_producer + i);
+                while(!slot.emplace_if_empty(token)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for(unsigned c = 0; c < consumers; ++c) {
+        threads.emplace_back([&]() {
+            while(taken.load() < producers * per_producer) {
+                if(Optional<T> v = slot.take()) {
+                    seen[static_cast<std::size_t>(*v)].fetch_add(1);
+                    taken.fetch_add(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for(auto& t : threads) {
+        t.join();
+    }
+    for(auto& s : seen) {
+        assert(s.load() == 1);
+    }
+    assert(!slot.load());
+}
+
+// Writers store and compare-exchange consistent Triples while readers check
+// that they never observe a mix of two of them.
+void test_no_tearing()
+{
+    AtomicOptional<Triple> x(Triple::make(0));
+    std::atomic<bool> done{false};
+    const std::uint32_t increments = 20000;
+    std::vector<std::thread> threads;
+    for(unsigned w = 0; w < 2; ++w) {
+        threads.emplace_back([&]() {
+            for(std::uint32_t i = 0; i < increments; ++i) {
+                Optional<Triple> cur = x.load();
+                Optional<Triple> next;
+                do {
+                    next = cur ? Triple::make(cur->a + 1u) : Triple::make(1u);
+                } while(!x.compare_exchange_weak(cur, next));
+                if(i % 64 == 0) {
+                    // Briefly empty the slot; the other writer restarts from it.
+                    Optional<Triple> got = x.take();
+                    if(got) {
+                        assert(got->consistent());
+                        x.store(got);
+                    }
+                }
+            }
+        });
+    }
+    for(unsigned r = 0; r < 2; ++r) {
+        threads.emplace_back([&]() {
+            while(!done.load()) {
+                Optional<Triple> v = x.load();
+                assert(!v || v->consistent());
+            }
+        });
+    }
+    threads[0].join();
+    threads[1].join();
+    done.store(true);
+    threads[2].join();
+    threads[3].join();
+    Optional<Triple> last = x.load();
+    assert(last && last->consistent());
+}
+
+int main(int, char**)
+{
+    test_basic<int>(1, 2);
+    test_basic<std::uint16_t>(7, 9);
+    test_basic<double>(1.5, -2.5);
+    test_basic<Triple>(Triple{1, 2, 3}, Triple{4, 5, 6});
+    {
+        // Padding never makes equal values compare unequal.
+        AtomicOptional<Padded> x(Padded{'a', 1});
+        Optional<Padded> expected(Padded{'a', 1});
+        assert(x.compare_exchange_strong(expected, Padded{'b', 2}));
+        assert((x.load() == Padded{'b', 2}));
+    }
+    test_handoff<std::uint32_t>();
+    test_handoff<std::uint64_t>();
+    test_no_tearing();
+
+  return 0;
+}
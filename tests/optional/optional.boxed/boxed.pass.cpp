@@ -0,0 +1,278 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <BoxedOptional>
+
+// template <class T, class Allocator = PoolAllocator<T>> class BoxedOptional;
+// template <class T> class PoolAllocator;
+
+#include "tim/optional/BoxedOptional.hpp"
+#include <type_traits>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+
+using tim::BoxedOptional;
+using tim::Optional;
+using tim::PoolAllocator;
+
+struct LargeRecord
+{
+    static int alive;
+    int id_;
+    char bytes_[396];
+    explicit LargeRecord(int id) : id_(id), bytes_() { ++alive; }
+    LargeRecord(const LargeRecord& other) : id_(other.id_), bytes_() { ++alive; }
+    LargeRecord& operator=(const LargeRecord& other) { id_ = other.id_; return *this; }
+    ~LargeRecord() { --alive; }
+};
+
+int LargeRecord::alive = 0;
+
+// A stateful allocator that counts what it hands out.
+template <class T>
+struct CountingAllocator
+{
+    using value_type = T;
+    int* live_;
+    explicit CountingAllocator(int* live) : live_(live) {}
+    template <class U>
+    CountingAllocator(const CountingAllocator<U>& other) : live_(other.live_) {}
+    T* allocate(std::size_t n) { ++*live_; return std::allocator<T>().allocate(n); }
+    void deallocate(T* p, std::size_t n) { --*live_; std::allocator<T>().deallocate(p, n); }
+    friend bool operator==(const CountingAllocator& l, const CountingAllocator& r) { return l.live_ == r.live_; }
+    friend bool operator!=(const CountingAllocator& l, const CountingAllocator& r) { return l.live_ != r.live_; }
+};
+
+void test_footprint()
+{
+    static_assert(sizeof(BoxedOptional<LargeRecord>) == sizeof(void*), "");
+    static_assert(sizeof(BoxedOptional<std::string>) == sizeof(void*), "");
+    static_assert(sizeof(Optional<LargeRecord>) > 400, "");
+    static_assert(PoolAllocator<LargeRecord>::pooled, "");
+    static_assert(PoolAllocator<LargeRecord>::block_size == 400, "");
+    static_assert(PoolAllocator<char>::block_size == 32, "");
+    static_assert(std::is_nothrow_move_constructible_v<BoxedOptional<LargeRecord>>, "");
+    static_assert(std::is_nothrow_move_assignable_v<BoxedOptional<LargeRecord>>, "");
+}
+
+void test_basics()
+{
+    {
+        BoxedOptional<LargeRecord> b;
+        assert(!b && !b.has_value() && b == tim::nullopt);
+        assert(!b.get() && !b.unbox());
+        LargeRecord& r = b.emplace(1);
+        assert(b && r.id_ == 1 && b->id_ == 1 && (*b).id_ == 1);
+        assert(LargeRecord::alive == 1);
+        // Re-engaging reuses the block.
+        LargeRecord& r2 = b.emplace(2);
+        assert(&r2 == &r && b->id_ == 2 && LargeRecord::alive == 1);
+        b = LargeRecord(3);
+        assert(&*b == &r && b->id_ == 3 && LargeRecord::alive == 1);
+        // Moves hand over the block.
+        BoxedOptional<LargeRecord> c(std::move(b));
+        assert(!b && &*c == &r);
+        b = std::move(c);
+        assert(!c && &*b == &r);
+        BoxedOptional<LargeRecord> d(b);
+        assert(d && d->id_ == 3 && &*d != &r && LargeRecord::alive == 2);
+        d = tim::nullopt;
+        assert(!d && LargeRecord::alive == 1);
+        d = b;
+        assert(d->id_ == 3);
+        swap(b, d);
+        assert(&*d == &r);
+        d.reset();
+        b = c;
+        assert(!b && LargeRecord::alive == 0);
+    }
+    {
+        BoxedOptional<std::string> s("boxed");
+        assert(*s == "boxed" && s.value() == "boxed");
+        assert(s.value_or("other") == "boxed");
+        assert(BoxedOptional<std::string>().value_or("other") == "other");
+        Optional<std::string> inline_copy = s.unbox();
+        assert(inline_copy && *inline_copy == "boxed");
+        BoxedOptional<std::string> from_inline(inline_copy);
+        assert(*from_inline == "boxed");
+        from_inline = Optional<std::string>();
+        assert(!from_inline);
+        from_inline = Optional<std::string>("x");
+        assert(*from_inline == "x");
+        BoxedOptional<std::string> list(tim::in_place, {'a', 'b'});
+        assert(*list == "ab");
+        list.emplace(3u, 'c');
+        assert(*list == "ccc");
+        std::string moved = *std::move(list);
+        assert(moved == "ccc");
+
+        assert(s.transform([](const std::string& v) { return v.size(); }) == Optional<std::size_t>(5u));
+        assert(s.and_then([](const std::string& v) { return Optional<char>(v[0]); }) == Optional<char>('b'));
+        assert(!BoxedOptional<std::string>().transform([](const std::string& v) { return v.size(); }));
+        assert(s.filter([](const std::string& v) { return v.size() > 10u; }) == tim::nullopt);
+        assert(*s.filter([](const std::string& v) { return v.size() == 5u; }) == "boxed");
+        assert(*BoxedOptional<std::string>().or_else([]() { return BoxedOptional<std::string>("else"); }) == "else");
+        assert(s.value_or_else([]() { return std::string("else"); }) == "boxed");
+    }
+}
+
+void test_comparisons_and_hash()
+{
+    BoxedOptional<int> empty;
+    BoxedOptional<int> one(1);
+    BoxedOptional<long> two(2L);
+    assert(one == one && one != two && one < two && two > one && one <= one && two >= one);
+    assert(empty < one && empty == tim::nullopt && tim::nullopt < one && one > tim::nullopt);
+    assert(empty <= tim::nullopt && tim::nullopt >= empty && !(one < tim::nullopt));
+    assert(one == 1 && 1 == one && one != 2 && one < 2 && 2 > one && one <= 1 && 1 >= one);
+    assert(empty != 1 && empty < 1);
+    assert(one == Optional<int>(1) && Optional<int>(2) > one && empty == Optional<int>());
+    assert(one != Optional<int>());
+
+    assert(std::hash<BoxedOptional<int>>{}(one) == std::hash<Optional<int>>{}(Optional<int>(1)));
+    assert(std::hash<BoxedOptional<int>>{}(empty) == std::hash<Optional<int>>{}(Optional<int>()));
+    BoxedOptional<std::string> s("key");
+    assert(std::hash<BoxedOptional<std::string>>{}(s) == std::hash<Optional<std::string>>{}(Optional<std::string>("key")));
+    static_assert(!std::is_default_constructible_v<std::hash<BoxedOptional<LargeRecord>>>, "");
+}
+
+void test_custom_allocator()
+{
+    int live = 0;
+    using Alloc = CountingAllocator<LargeRecord>;
+    {
+        BoxedOptional<LargeRecord, Alloc> b{Alloc(&live)};
+        static_assert(sizeof(b) == 2 * sizeof(void*), "");
+        assert(live == 0);
+        b.emplace(1);
+        assert(live == 1 && b.get_allocator().live_ == &live);
+        BoxedOptional<LargeRecord, Alloc> c(b);
+        assert(live == 2);
+        c.reset();
+        assert(live == 1);
+        // Unequal allocators: the payload is moved, not the block.
+        int other_live = 0;
+        BoxedOptional<LargeRecord, Alloc> d{Alloc(&other_live)};
+        d = std::move(b);
+        assert(d->id_ == 1 && other_live == 1 && live == 1);
+    }
+    assert(live == 0 && LargeRecord::alive == 0);
+}
+
+// Dynamically initialized before the thread's pool cache, so destroyed
+// after it.
+struct LateBox
+{
+    BoxedOptional<LargeRecord> box_;
+    LateBox() { assert(!box_); }
+};
+
+BoxedOptional<LargeRecord>& late_box()
+{
+    thread_local LateBox late;
+    return late.box_;
+}
+
+void test_pool()
+{
+    PoolAllocator<LargeRecord> alloc;
+    LargeRecord* p = alloc.allocate(1);
+    alloc.deallocate(p, 1);
+    assert(alloc.allocate(1) == p);
+    alloc.deallocate(p, 1);
+    // Types of the same size class share blocks.
+    PoolAllocator<char[392]> same_class;
+    assert(static_cast<void*>(same_class.allocate(1)) == static_cast<void*>(p));
+    same_class.deallocate(reinterpret_cast<char(*)[392]>(p), 1);
+    // Arrays come from operator new.
+    LargeRecord* array = alloc.allocate(3);
+    alloc.deallocate(array, 3);
+    assert(alloc == PoolAllocator<int>());
+
+    // Boxes built on one thread can be freed on another.
+    std::vector<BoxedOptional<LargeRecord>> boxes(1000);
+    std::thread producer([&]() {
+        for(int i = 0; i < 1000; ++i)
+            boxes[i].emplace(i);
+    });
+    producer.join();
+    assert(LargeRecord::alive == 1000);
+    for(int i = 0; i < 1000; ++i)
+        assert(boxes[i]->id_ == i);
+    boxes.clear();
+    assert(LargeRecord::alive == 0);
+
+    // A block freed after its thread's cache is gone goes to the stash, and
+    // is the next list handed out.
+    void* late = nullptr;
+    std::thread exiting([&]() { late = &late_box().emplace(7); });
+    exiting.join();
+    assert(LargeRecord::alive == 0);
+    void* reused = nullptr;
+    std::thread next([&]() {
+        LargeRecord* q = alloc.allocate(1);
+        reused = q;
+        alloc.deallocate(q, 1);
+    });
+    next.join();
+    assert(reused == late);
+}
+
+#ifndef TEST_HAS_NO_EXCEPTIONS
+struct ThrowsOnNegative
+{
+    int i_;
+    explicit ThrowsOnNegative(int i) : i_(i) { if(i < 0) throw i; }
+};
+
+void test_exceptions()
+{
+    BoxedOptional<int> empty;
+    try {
+        (void)empty.value();
+        assert(false);
+    } catch(const tim::BadOptionalAccess&) {
+    }
+    BoxedOptional<ThrowsOnNegative> b(tim::in_place, 1);
+    try {
+        b.emplace(-1);
+        assert(false);
+    } catch(int i) {
+        assert(i == -1);
+    }
+    assert(!b);
+    try {
+        BoxedOptional<ThrowsOnNegative> c(tim::in_place, -2);
+        assert(false);
+    } catch(int i) {
+        assert(i == -2);
+    }
+    b.emplace(4);
+    assert(b->i_ == 4);
+}
+#endif
+
+int main(int, char**)
+{
+    test_footprint();
+    test_basics();
+    test_comparisons_and_hash();
+    test_custom_allocator();
+    test_pool();
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    test_exceptions();
+#endif
+
+  return 0;
+}
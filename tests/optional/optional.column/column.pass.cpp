@@ -0,0 +1,266 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <OptionalColumn>
+
+// template <class T> struct OptionalColumn;
+
+#include "tim/optional/OptionalColumn.hpp"
+#include <type_traits>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::OptionalColumn;
+using tim::nullopt;
+using tim::BadOptionalAccess;
+
+
+bool aligned(const void* p)
+{
+    return reinterpret_cast<std::uintptr_t>(p) % 64 == 0;
+}
+
+// A foreign producer: owns a heap block with both buffers.
+struct Producer
+{
+    static int released;
+    alignas(64) std::uint8_t validity[64];
+    alignas(64) std::int32_t values[32];
+    const void* buffers[2];
+
+    static void release(ArrowArray* array)
+    {
+        delete static_cast<Producer*>(array->private_data);
+        array->release = nullptr;
+        ++released;
+    }
+
+    // Slots 0..length-1 hold 'i * 10' and are null when 'i % 3 == 1'.
+    static ArrowArray make(std::int64_t length, std::int64_t offset, bool with_bitmap)
+    {
+        Producer* p = new Producer();
+        for (int i = 0; i < 32; ++i)
+        {
+            p->values[i] = i * 10;
+            if (i % 3 != 1)
+                p->validity[i / 8] |= static_cast<std::uint8_t>(1u << (i % 8));
+        }
+        p->buffers[0] = with_bitmap ? p->validity : nullptr;
+        p->buffers[1] = p->values;
+        return ArrowArray{length, -1, offset, 2, 0, p->buffers, nullptr, nullptr, &Producer::release, p};
+    }
+};
+
+int Producer::released = 0;
+
+void test_layout()
+{
+    OptionalColumn<std::int32_t> c{1, nullopt, 3};
+    assert(c.size() == 3 && c.null_count() == 1 && c.count() == 2);
+    assert(aligned(c.values()) && aligned(c.validity()));
+    assert(c.validity()[0] == 0x05);
+    assert(c.values()[0] == 1 && c.values()[2] == 3);
+    assert(*c[0] == 1 && !c[1] && c.value(2) == 3);
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    try {
+        (void)c.value(1);
+        assert(false);
+    } catch (const BadOptionalAccess&) {
+    }
+#endif
+    c.emplace(1, 2);
+    c.reset(0);
+    assert(c.validity()[0] == 0x06 && c.null_count() == 1);
+    for (int i = 0; i < 100; ++i)
+        c.push_back(i % 2 ? Optional<std::int32_t>(i) : Optional<std::int32_t>());
+    assert(c.size() == 103 && c.null_count() == 51);
+    assert(aligned(c.values()) && aligned(c.validity()));
+    c.resize(10);
+    assert(c.null_count() == 5);
+    c.resize(12);
+    assert(c.null_count() == 7 && !c[11]);
+    OptionalColumn<std::int32_t> d(c);
+    assert(d.size() == 12 && d.null_count() == 7 && *d[1] == 2 && !d[0]);
+    c.clear();
+    assert(c.empty() && c.null_count() == 0 && d.size() == 12);
+}
+
+void test_schema()
+{
+    assert(std::strcmp(OptionalColumn<std::int8_t>::arrow_format(), "c") == 0);
+    assert(std::strcmp(OptionalColumn<std::uint16_t>::arrow_format(), "S") == 0);
+    assert(std::strcmp(OptionalColumn<std::int32_t>::arrow_format(), "i") == 0);
+    assert(std::strcmp(OptionalColumn<std::uint64_t>::arrow_format(), "L") == 0);
+    assert(std::strcmp(OptionalColumn<float>::arrow_format(), "f") == 0);
+    assert(std::strcmp(OptionalColumn<double>::arrow_format(), "g") == 0);
+    ArrowSchema schema;
+    OptionalColumn<double>::export_schema(&schema);
+    assert(std::strcmp(schema.format, "g") == 0);
+    assert(schema.flags == ARROW_FLAG_NULLABLE && schema.n_children == 0);
+    schema.release(&schema);
+    assert(schema.release == nullptr);
+}
+
+void test_export_import()
+{
+    ArrowSchema schema;
+    OptionalColumn<std::int32_t>::export_schema(&schema);
+    OptionalColumn<std::int32_t> c{1, nullopt, 3, 4};
+    const void* values = c.values();
+    const void* validity = c.validity();
+    ArrowArray array;
+    std::move(c).export_array(&array);
+    assert(c.empty() && c.values() == nullptr);
+    assert(array.length == 4 && array.null_count == 1 && array.offset == 0);
+    assert(array.n_buffers == 2 && array.n_children == 0);
+    assert(array.buffers[0] == validity && array.buffers[1] == values);
+
+    // Round trip: adopted in place, then handed on again.
+    OptionalColumn<std::int32_t> d = OptionalColumn<std::int32_t>::import_array(&array, &schema);
+    assert(array.release == nullptr);
+    assert(d.values() == values && d.validity() == validity);
+    assert(d.size() == 4 && d.null_count() == 1 && *d[3] == 4 && !d[1]);
+    // The first write copies the borrowed buffers.
+    d.emplace(1, 2);
+    assert(d.null_count() == 0 && *d[1] == 2 && *d[3] == 4);
+    assert(d.values() != values && aligned(d.values()) && aligned(d.validity()));
+    values = d.values();
+    std::move(d).export_array(&array);
+    assert(array.buffers[1] == values);
+    array.release(&array);
+    assert(array.release == nullptr);
+
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    {
+        ArrowSchema wrong;
+        OptionalColumn<std::int64_t>::export_schema(&wrong);
+        ArrowArray foreign = Producer::make(4, 0, true);
+        try {
+            (void)OptionalColumn<std::int32_t>::import_array(&foreign, &wrong);
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+        assert(foreign.release != nullptr);
+        foreign.release(&foreign);
+    }
+#endif
+    Producer::released = 0;
+    {
+        // Byte-aligned offset: both buffers borrowed.
+        ArrowArray foreign = Producer::make(16, 8, true);
+        auto col = OptionalColumn<std::int32_t>::import_array(&foreign, &schema);
+        assert(col.size() == 16);
+        assert(col.null_count() == 5);
+        assert(*col[0] == 80 && !col[2] && *col[15] == 230);
+        assert(Producer::released == 0);
+        col.push_back(1);
+        assert(Producer::released == 1);
+        assert(aligned(col.values()) && *col[16] == 1 && *col[0] == 80 && !col[2]);
+    }
+    {
+        // Unaligned offset: only the bitmap is copied.
+        ArrowArray foreign = Producer::make(10, 3, true);
+        const void* values = static_cast<const std::int32_t*>(foreign.buffers[1]) + 3;
+        auto col = OptionalColumn<std::int32_t>::import_array(&foreign, &schema);
+        assert(col.values() == values);
+        assert(col.null_count() == 3);
+        assert(*col[0] == 30 && !col[1] && *col[2] == 50 && !col[4]);
+    }
+    assert(Producer::released == 2);
+    {
+        // No bitmap: all valid until the first reset.
+        ArrowArray foreign = Producer::make(20, 0, false);
+        auto col = OptionalColumn<std::int32_t>::import_array(&foreign, &schema);
+        assert(col.validity() == nullptr && col.null_count() == 0 && *col[1] == 10);
+        const std::int32_t* borrowed = col.values();
+        col.reset(1);
+        assert(col.validity() != nullptr && col.null_count() == 1 && !col[1] && *col[19] == 190);
+        assert(col.values() != borrowed && Producer::released == 3);
+        OptionalColumn<std::int32_t> copy(col);
+        std::move(col).export_array(&foreign);
+        foreign.release(&foreign);
+        assert(copy.null_count() == 1 && *copy[19] == 190);
+    }
+    {
+        // Imported buffers are never written to, so read-only memory is fine:
+        // the first write goes to owned copies.
+        alignas(64) static const std::int32_t ro_values[4] = {1, 2, 3, 4};
+        alignas(64) static const std::uint8_t ro_validity[8] = {0x0B};
+        const void* ro_buffers[2] = {ro_validity, ro_values};
+        ArrowArray foreign{4, -1, 0, 2, 0, ro_buffers, nullptr, nullptr, [](ArrowArray* a) { a->release = nullptr; }, nullptr};
+        auto col = OptionalColumn<std::int32_t>::import_array(&foreign, &schema);
+        assert(col.values() == ro_values && col.null_count() == 1);
+        col.emplace(2, 7);
+        col.reset(0);
+        assert(col.values() != ro_values && col.validity() != ro_validity);
+        assert(!col[0] && *col[1] == 2 && *col[2] == 7 && *col[3] == 4 && col.null_count() == 1);
+        assert(ro_values[2] == 3 && ro_validity[0] == 0x0B);
+    }
+    {
+        // Shrinking an imported column leaves spare borrowed capacity, which
+        // appends must not write into either.
+        alignas(64) static const std::int32_t ro_values[4] = {1, 2, 3, 4};
+        alignas(64) static const std::uint8_t ro_validity[8] = {0x0B};
+        for (const void* bitmap : {static_cast<const void*>(nullptr), static_cast<const void*>(ro_validity)}) {
+            const void* ro_buffers[2] = {bitmap, ro_values};
+            ArrowArray foreign{4, -1, 0, 2, 0, ro_buffers, nullptr, nullptr, [](ArrowArray* a) { a->release = nullptr; }, nullptr};
+            auto col = OptionalColumn<std::int32_t>::import_array(&foreign, &schema);
+            col.pop_back();
+            col.emplace_back(99);
+            assert(col.values() != ro_values && col.validity() != ro_validity);
+            assert(col.size() == 4 && *col[3] == 99 && *col[0] == 1);
+            col.pop_back();
+            col.pop_back();
+            col.push_back(nullopt);
+            col.resize(4);
+            assert(col.size() == 4 && *col[1] == 2 && !col[2] && !col[3]);
+
+            foreign = ArrowArray{4, -1, 0, 2, 0, ro_buffers, nullptr, nullptr, [](ArrowArray* a) { a->release = nullptr; }, nullptr};
+            auto other = OptionalColumn<std::int32_t>::import_array(&foreign, &schema);
+            other.clear();
+            other.push_back(nullopt);
+            assert(other.values() != ro_values && other.size() == 1 && !other[0] && other.null_count() == 1);
+
+            foreign = ArrowArray{4, -1, 0, 2, 0, ro_buffers, nullptr, nullptr, [](ArrowArray* a) { a->release = nullptr; }, nullptr};
+            auto resized = OptionalColumn<std::int32_t>::import_array(&foreign, &schema);
+            resized.resize(1);
+            resized.resize(3);
+            assert(resized.values() != ro_values && resized.size() == 3 && *resized[0] == 1 && !resized[1] && !resized[2]);
+        }
+        assert(ro_values[3] == 4 && ro_validity[0] == 0x0B);
+    }
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    {
+        ArrowArray foreign = Producer::make(4, 0, true);
+        foreign.buffers[1] = nullptr;
+        try {
+            (void)OptionalColumn<std::int32_t>::import_array(&foreign, &schema);
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+        assert(foreign.release != nullptr);
+        foreign.release(&foreign);
+    }
+#endif
+    schema.release(&schema);
+}
+
+int main(int, char**)
+{
+    test_layout();
+    test_schema();
+    test_export_import();
+
+  return 0;
+}
@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <ConcurrentOptionalArray>
+
+// template <class T> class ConcurrentOptionalArray;
+
+#include "tim/optional/ConcurrentOptionalArray.hpp"
+#include <type_traits>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::ConcurrentOptionalArray;
+
+struct Counted
+{
+    static int alive;
+    int i_;
+    explicit Counted(int i) : i_(i) { ++alive; }
+    Counted(const Counted&) = delete;
+    ~Counted() { --alive; }
+};
+
+int Counted::alive = 0;
+
+void test_single_thread()
+{
+    {
+        ConcurrentOptionalArray<Counted> a(130);
+        assert(a.size() == 130);
+        assert(a.poll_filled() == 0 && !a.all_filled());
+        assert(!a[5] && !a.has_value(5));
+        assert(a.try_emplace(5, 50));
+        assert(!a.try_emplace(5, 51));
+        assert(a[5]->i_ == 50);
+        assert(a.try_emplace(129, 1290));
+        assert(a.try_emplace(64, 640));
+        assert(a.poll_filled() == 3);
+        assert(a.filled_word(0) == (std::uint64_t(1) << 5));
+        assert(a.filled_word(1) == 1u);
+        assert(a.filled_word(2) == 2u);
+        assert(Counted::alive == 3);
+
+        std::vector<std::size_t> seen;
+        a.for_each_filled([&](std::size_t i, Counted& c) {
+            assert(c.i_ == static_cast<int>(i) * 10);
+            seen.push_back(i);
+        });
+        assert((seen == std::vector<std::size_t>{5, 64, 129}));
+
+        const ConcurrentOptionalArray<Counted>& c = a;
+        static_assert(std::is_same_v<decltype(c[0]), Optional<const Counted&>>, "");
+        assert(c[64]->i_ == 640);
+    }
+    // Filled slots are destroyed with the array.
+    assert(Counted::alive == 0);
+
+    ConcurrentOptionalArray<std::string> empty(0);
+    assert(empty.all_filled());
+    empty.wait_all();
+
+    ConcurrentOptionalArray<std::string> strings(2);
+    assert(strings.try_emplace(0, 3u, 'x'));
+    assert(!strings.all_filled());
+    assert(strings.try_emplace(1, "y"));
+    assert(strings.all_filled());
+    strings.wait_all();
+    assert(*strings[0] == "xxx" && *strings[1] == "y");
+}
+
+void test_throwing_construct()
+{
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    struct MayThrow
+    {
+        int i_;
+        explicit MayThrow(int i) : i_(i) { if(i < 0) throw i; }
+    };
+    ConcurrentOptionalArray<MayThrow> a(1);
+    try {
+        a.try_emplace(0, -1);
+        assert(false);
+    } catch(int) {
+    }
+    // The slot was released for another attempt.
+    assert(!a.has_value(0) && a.poll_filled() == 0);
+    assert(a.try_emplace(0, 1));
+    assert(a.all_filled() && a[0]->i_ == 1);
+#endif
+}
+
+void test_threads()
+{
+    constexpr std::size_t count = 1000;
+    constexpr unsigned writers = 4;
+    ConcurrentOptionalArray<std::string> a(count);
+    std::atomic<std::size_t> won{0};
+    std::vector<std::thread> threads;
+    // Every writer tries every slot; exactly one wins each.
+    for(unsigned t = 0; t < writers; ++t) {
+        threads.emplace_back([&, t] {
+            for(std::size_t k = 0; k < count; ++k) {
+                std::size_t i = (k + t * 250) % count;
+                if(a.try_emplace(i, std::to_string(i)))
+                    won.fetch_add(1);
+            }
+        });
+    }
+    std::size_t last = 0;
+    while(!a.all_filled()) {
+        std::size_t n = a.poll_filled();
+        assert(n >= last && n <= count);
+        last = n;
+        const ConcurrentOptionalArray<std::string>& ca = a;
+        ca.for_each_filled([](std::size_t i, const std::string& s) {
+            assert(s == std::to_string(i));
+        });
+        std::this_thread::yield();
+    }
+    a.wait_all();
+    for(auto& t : threads)
+        t.join();
+    assert(won.load() == count);
+    assert(a.poll_filled() == count);
+    for(std::size_t i = 0; i < count; ++i)
+        assert(*a[i] == std::to_string(i));
+}
+
+void test_wait_all_blocks()
+{
+    ConcurrentOptionalArray<int> a(3);
+    std::atomic<bool> woke{false};
+    std::thread waiter([&] {
+        a.wait_all();
+        woke.store(true);
+    });
+    a.try_emplace(0, 0);
+    a.try_emplace(2, 2);
+    std::this_thread::yield();
+    assert(!woke.load());
+    a.try_emplace(1, 1);
+    waiter.join();
+    assert(woke.load());
+}
+
+int main(int, char**)
+{
+    test_single_thread();
+    test_throwing_construct();
+    test_threads();
+    test_wait_all_blocks();
+
+  return 0;
+}
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <Optional>
+
+// template <class F> constexpr auto and_then(F&& f) &;       // and &&, const&, const&&
+// template <class F> constexpr auto transform(F&& f) &;      // and &&, const&, const&&
+// template <class F> constexpr Optional or_else(F&& f) const&; // and &&
+// template <class P> constexpr Optional filter(P&& p) const&;  // and &&
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <string>
+#include <utility>
+#include <cassert>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::nullopt;
+
+struct Counted
+{
+    static int copies;
+    static int moves;
+    int i_;
+    constexpr explicit Counted(int i) : i_(i) {}
+    Counted(const Counted& other) : i_(other.i_) { ++copies; }
+    Counted(Counted&& other) : i_(other.i_) { ++moves; }
+    static void reset() { copies = 0; moves = 0; }
+};
+
+int Counted::copies = 0;
+int Counted::moves = 0;
+
+// Reports which overload of operator* the monadic functions passed along.
+struct Category
+{
+    int operator()(int&) const { return 1; }
+    int operator()(const int&) const { return 2; }
+    int operator()(int&&) const { return 3; }
+    int operator()(const int&&) const { return 4; }
+};
+
+struct CategoryOpt
+{
+    template <class T>
+    Optional<int> operator()(T&& v) const { return Category{}(std::forward<T>(v)); }
+};
+
+constexpr bool test_constexpr()
+{
+    constexpr Optional<int> a(2);
+    constexpr Optional<int> empty;
+    static_assert(*a.transform([](int v) { return v * 3; }) == 6, "");
+    static_assert(!empty.transform([](int v) { return v * 3; }), "");
+    static_assert(*a.and_then([](int v) { return Optional<long>(v + 1); }) == 3, "");
+    static_assert(!a.and_then([](int) { return Optional<long>(); }), "");
+    static_assert(*empty.or_else([] { return Optional<int>(9); }) == 9, "");
+    static_assert(*a.or_else([] { return Optional<int>(9); }) == 2, "");
+    static_assert(a.filter([](int v) { return v > 1; }) == 2, "");
+    static_assert(!a.filter([](int v) { return v > 2; }), "");
+    return true;
+}
+
+void test_ref_qualifiers()
+{
+    Optional<int> o(1);
+    const Optional<int>& co = o;
+    assert(*o.transform(Category{}) == 1);
+    assert(*co.transform(Category{}) == 2);
+    assert(*std::move(o).transform(Category{}) == 3);
+    assert(*std::move(co).transform(Category{}) == 4);
+    assert(*o.and_then(CategoryOpt{}) == 1);
+    assert(*co.and_then(CategoryOpt{}) == 2);
+    assert(*std::move(o).and_then(CategoryOpt{}) == 3);
+    assert(*std::move(co).and_then(CategoryOpt{}) == 4);
+}
+
+void test_result_types()
+{
+    Optional<std::string> s(std::string("abc"));
+    int x = 5;
+    Optional<int> o(1);
+
+    // Lvalue references stay references; void gives Optional<void>.
+    auto r = o.transform([&](int) -> int& { return x; });
+    static_assert(std::is_same_v<decltype(r), Optional<int&>>, "");
+    assert(&*r == &x);
+    auto v = o.transform([](int) {});
+    static_assert(std::is_same_v<decltype(v), Optional<void>>, "");
+    assert(v.has_value());
+    auto moved = std::move(s).transform([](std::string&& str) -> std::string&& { return std::move(str); });
+    static_assert(std::is_same_v<decltype(moved), Optional<std::string>>, "");
+    assert(*moved == "abc");
+
+    Optional<int&> ref(x);
+    auto doubled = ref.transform([](int& i) { return i * 2; });
+    static_assert(std::is_same_v<decltype(doubled), Optional<int>>, "");
+    assert(*doubled == 10);
+    assert(*ref.and_then([](int& i) { return Optional<int&>(i); }) == 5);
+    assert(&*ref.filter([](const int& i) { return i == 5; }) == &x);
+    assert(!Optional<int&>().or_else([] { return Optional<int&>(); }));
+    assert(!ref.filter([](const int& i) { return i != 5; }));
+}
+
+void test_no_extra_moves()
+{
+    Optional<int> o(4);
+    Counted::reset();
+    Optional<Counted> c = o.transform([](int v) { return Counted(v); });
+    assert(c->i_ == 4);
+    assert(Counted::copies == 0 && Counted::moves == 0);
+
+    Counted::reset();
+    Optional<Counted> d = std::move(c).filter([](const Counted& k) { return k.i_ == 4; });
+    assert(d && Counted::copies == 0 && Counted::moves == 1);
+
+    Counted::reset();
+    Optional<Counted> e = std::move(d).or_else([] { return Optional<Counted>(); });
+    assert(e && Counted::copies == 0 && Counted::moves == 1);
+
+    Counted::reset();
+    Optional<Counted> f = e.filter([](const Counted&) { return true; });
+    assert(f && Counted::copies == 1 && Counted::moves == 0);
+}
+
+int main(int, char**)
+{
+    static_assert(test_constexpr(), "");
+    test_ref_qualifiers();
+    test_result_types();
+    test_no_extra_moves();
+
+  return 0;
+}
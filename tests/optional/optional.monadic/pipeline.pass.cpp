@@ -0,0 +1,122 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <OptionalPipeline>
+
+// Optional<R> r = opt | tim::transform(f) | tim::and_then(g) | tim::filter(p) | tim::or_else(h);
+
+#include "tim/optional/OptionalPipeline.hpp"
+#include <type_traits>
+#include <string>
+#include <utility>
+#include <cassert>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::nullopt;
+
+struct Counted
+{
+    static int copies;
+    static int moves;
+    int i_;
+    constexpr explicit Counted(int i) : i_(i) {}
+    Counted(const Counted& other) : i_(other.i_) { ++copies; }
+    Counted(Counted&& other) : i_(other.i_) { ++moves; }
+    static void reset() { copies = 0; moves = 0; }
+};
+
+int Counted::copies = 0;
+int Counted::moves = 0;
+
+constexpr int twice(int v) { return 2 * v; }
+constexpr Optional<long> half(int v) { return v % 2 ? Optional<long>() : Optional<long>(v / 2); }
+
+constexpr bool test_constexpr()
+{
+    constexpr Optional<int> a(3);
+    constexpr Optional<int> empty;
+    constexpr Optional<long> r1 = a | tim::transform(twice) | tim::and_then(half);
+    static_assert(r1 == 3, "");
+    constexpr Optional<long> r2 = a | tim::and_then(half);
+    static_assert(!r2, "");
+    constexpr Optional<int> r3 = empty | tim::or_else([] { return Optional<int>(7); }) | tim::transform(twice);
+    static_assert(r3 == 14, "");
+    constexpr Optional<int> r4 = a | tim::filter([](int v) { return v > 5; }) | tim::or_else([] { return Optional<int>(1); });
+    static_assert(r4 == 1, "");
+    return true;
+}
+
+void test_chains()
+{
+    Optional<std::string> s(std::string("hello"));
+    Optional<std::size_t> n = s | tim::transform([](const std::string& str) { return str.size(); });
+    assert(n == 5u);
+
+    Optional<std::string> upper = std::move(s)
+        | tim::filter([](const std::string& str) { return !str.empty(); })
+        | tim::transform([](std::string&& str) { str[0] = 'H'; return std::move(str); });
+    assert(upper == std::string("Hello"));
+
+    int x = 1;
+    Optional<int&> ref = Optional<int>(0) | tim::transform([&](int) -> int& { return x; });
+    assert(&*ref == &x);
+
+    Optional<int> e;
+    int calls = 0;
+    Optional<int> r = e | tim::transform([&](int v) { ++calls; return v; })
+        | tim::and_then([&](int v) { ++calls; return Optional<int>(v); });
+    assert(!r && calls == 0);
+
+    // A stored chain refers to its source, so the source must outlive it.
+    Optional<int> four(4);
+    auto pending = four | tim::transform(twice);
+    static_assert(std::is_same_v<decltype(pending)::result_type, Optional<int>>, "");
+    assert(std::move(pending).eval() == 8);
+}
+
+// A chain of transforms runs on one presence test and constructs the result in
+// place.  The equivalent hand-written code moves the result into the Optional.
+void test_no_extra_moves()
+{
+    Optional<int> o(3);
+    auto make = [](int v) { return Counted(v); };
+    auto bump = [](Counted c) { return Counted(c.i_ + 1); };
+
+    Counted::reset();
+    Optional<Counted> fused = o | tim::transform(make) | tim::transform(bump);
+    assert(fused->i_ == 4);
+    assert(Counted::copies == 0 && Counted::moves == 0);
+
+    Counted::reset();
+    Optional<Counted> by_hand = o ? Optional<Counted>(bump(make(*o))) : Optional<Counted>(nullopt);
+    assert(by_hand->i_ == 4);
+    assert(Counted::copies == 0 && Counted::moves == 1);
+
+    // Member transform() also constructs in place.
+    Counted::reset();
+    Optional<Counted> member = o.transform(make);
+    assert(member->i_ == 3 && Counted::copies == 0 && Counted::moves == 0);
+
+    // and_then hands its Optional's value on without copying it.
+    Counted::reset();
+    Optional<int> last = o | tim::and_then([](int v) { return Optional<Counted>(tim::in_place, v); })
+        | tim::transform([](Counted&& c) { return c.i_; });
+    assert(last == 3 && Counted::copies == 0 && Counted::moves == 0);
+}
+
+int main(int, char**)
+{
+    static_assert(test_constexpr(), "");
+    test_chains();
+    test_no_extra_moves();
+
+  return 0;
+}
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <Optional>
+
+// template <class F, class... Args> T& Optional<T>::emplace_invoke(F&& f, Args&&... args);
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <cassert>
+
+#include "test_macros.h"
+#include "archetypes.h"
+
+using tim::Optional;
+
+struct Pinned
+{
+    int i_;
+    constexpr explicit Pinned(int i) : i_(i) {}
+    Pinned(const Pinned&) = delete;
+    Pinned& operator=(const Pinned&) = delete;
+};
+
+template <class T>
+void test_on_test_type()
+{
+    T::reset();
+    Optional<T> opt;
+    {
+        auto make = [] { return T(1); };
+        static_assert(std::is_same_v<T&, decltype(opt.emplace_invoke(make))>, "");
+        T& v = opt.emplace_invoke(make);
+        assert(&v == &*opt);
+        assert(v.value == 1);
+        assert(T::alive == 1);
+        assert(T::constructed == 1 && T::value_constructed == 1);
+    }
+    T::reset_constructors();
+    {
+        opt.emplace_invoke([](int a, int b) { return T(a, b); }, 0, 2);
+        assert(opt->value == 2);
+        assert(T::alive == 1);
+        assert(T::destroyed == 1);
+        assert(T::constructed == 1 && T::value_constructed == 1);
+        assert(T::move_constructed == 0 && T::assigned == 0);
+    }
+    opt.reset();
+    assert(T::alive == 0);
+}
+
+int main(int, char**)
+{
+    {
+        Optional<Pinned> opt;
+        opt.emplace_invoke([] { return Pinned(1); });
+        assert(opt->i_ == 1);
+        opt.emplace_invoke([] { return Pinned(2); });
+        assert(opt->i_ == 2);
+        auto nothrow_make = []() noexcept { return Pinned(3); };
+        auto make = [] { return Pinned(3); };
+        static_assert(noexcept(opt.emplace_invoke(nothrow_make)), "");
+        static_assert(!noexcept(opt.emplace_invoke(make)), "");
+    }
+    test_on_test_type<TestTypes::TestType>();
+    test_on_test_type<ExplicitTestTypes::TestType>();
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    {
+        Optional<int> opt(3);
+        try {
+            opt.emplace_invoke([]() -> int { throw 6; });
+            assert(false);
+        } catch(int i) {
+            assert(i == 6);
+        }
+        assert(!opt.has_value());
+    }
+#endif
+
+  return 0;
+}
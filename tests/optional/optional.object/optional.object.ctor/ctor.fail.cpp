@@ -24,7 +24,6 @@ struct NonDestructible { ~NonDestructible() = delete; };
 int main(int, char**)
 {
 	{
-	tim::Optional<char &> o1;	        // expected-error-re@Optional:* {{static_assert failed{{.*}} "instantiation of Optional with a reference type is ill-formed"}}
 	tim::Optional<NonDestructible> o2;  // expected-error-re@Optional:* {{static_assert failed{{.*}} "instantiation of Optional with a non-destructible type is ill-formed"}}	
 	tim::Optional<char[20]> o3;	        // expected-error-re@Optional:* {{static_assert failed{{.*}} "instantiation of Optional with an array type is ill-formed"}}	
 	}
@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <Optional>
+
+// template <class F, class... Args>
+//   constexpr explicit Optional(from_invoke_t, F&& f, Args&&... args);
+// template <class F, class... Args>
+//   constexpr Optional<R> make_optional(from_invoke_t, F&& f, Args&&... args);
+// template <class F, class... Args>
+//   constexpr Optional<R> some(from_invoke_t, F&& f, Args&&... args);
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <cassert>
+
+#include "test_macros.h"
+#include "archetypes.h"
+
+using tim::Optional;
+using tim::from_invoke;
+using tim::from_invoke_t;
+
+// Neither copyable nor movable: only guaranteed elision can put one in an Optional.
+struct Pinned
+{
+    int i_;
+    constexpr explicit Pinned(int i) : i_(i) {}
+    Pinned(const Pinned&) = delete;
+    Pinned& operator=(const Pinned&) = delete;
+};
+
+constexpr Pinned make_pinned(int i) { return Pinned(i); }
+
+struct Factory
+{
+    int base;
+    constexpr Pinned make(int i) const { return Pinned(base + i); }
+};
+
+// The flag lives in this type's tail padding, so the result is moved in.
+struct Padded
+{
+    int i_;
+    char c_;
+    constexpr Padded(int i, char c) : i_(i), c_(c) {}
+};
+
+template <class T>
+void test_counted()
+{
+    T::reset();
+    {
+        Optional<T> opt(from_invoke, [] { return T(42); });
+        assert(opt->value == 42);
+        assert(T::value_constructed == 1);
+        assert(T::copy_constructed == 0);
+        assert(T::move_constructed == 0);
+        assert(T::alive == 1);
+    }
+    assert(T::alive == 0);
+    T::reset_constructors();
+    {
+        Optional<T> opt = tim::make_optional<T>(from_invoke, [](int i) { return T(i); }, 3);
+        assert(opt->value == 3);
+        assert(T::constructed == 1 && T::value_constructed == 1);
+    }
+    T::reset_constructors();
+    {
+        auto opt = tim::some(from_invoke, [] { return T(7); });
+        static_assert(std::is_same_v<decltype(opt), Optional<T>>, "");
+        assert(opt->value == 7);
+        assert(T::constructed == 1 && T::value_constructed == 1);
+    }
+    T::reset_constructors();
+    {
+        // A transform builds its result the same way.
+        Optional<int> src(5);
+        Optional<T> opt = src.transform([](int i) { return T(i); });
+        assert(opt->value == 5);
+        assert(T::constructed == 1 && T::value_constructed == 1);
+    }
+    assert(T::alive == 0);
+}
+
+int main(int, char**)
+{
+    {
+        static_assert(std::is_constructible_v<Optional<Pinned>, from_invoke_t, Pinned (*)(int), int>, "");
+        static_assert(!std::is_constructible_v<Optional<Pinned>, from_invoke_t, Pinned (*)(int)>, "");
+        static_assert(!std::is_convertible_v<from_invoke_t, Optional<Pinned>>, "");
+        static_assert(std::is_nothrow_constructible_v<Optional<int>, from_invoke_t, int (*)() noexcept>, "");
+        static_assert(!std::is_nothrow_constructible_v<Optional<int>, from_invoke_t, int (*)()>, "");
+    }
+    {
+        constexpr Optional<Pinned> opt(from_invoke, make_pinned, 3);
+        static_assert(opt.has_value(), "");
+        static_assert(opt->i_ == 3, "");
+        constexpr auto made = tim::make_optional(from_invoke, make_pinned, 4);
+        static_assert(std::is_same_v<decltype(made), const Optional<Pinned>>, "");
+        static_assert(made->i_ == 4, "");
+    }
+    {
+        const Factory f{10};
+        Optional<Pinned> m(from_invoke, &Factory::make, f, 2);
+        assert(m->i_ == 12);
+    }
+    {
+        Optional<Padded> p(from_invoke, [] { return Padded(1, 'a'); });
+        assert(p.has_value() && p->i_ == 1 && p->c_ == 'a');
+        p.emplace_invoke([] { return Padded(2, 'b'); });
+        assert(p.has_value() && p->i_ == 2 && p->c_ == 'b');
+    }
+    {
+        // The result converts when it is not exactly 'T'.
+        Optional<long> opt(from_invoke, [](short s) { return s; }, short(9));
+        assert(opt == 9L);
+    }
+    test_counted<TestTypes::TestType>();
+    test_counted<ExplicitTestTypes::TestType>();
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    {
+        try {
+            Optional<int> opt(from_invoke, []() -> int { throw 6; });
+            assert(false);
+        } catch(int i) {
+            assert(i == 6);
+        }
+    }
+#endif
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <Optional>
+
+// template <class T> struct optional_niche_traits;
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <functional>
+#include <cstdint>
+#include <cassert>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::nullopt;
+using tim::in_place;
+
+struct Index {
+    std::int32_t i;
+    friend constexpr bool operator==(Index lhs, Index rhs) { return lhs.i == rhs.i; }
+    friend constexpr bool operator!=(Index lhs, Index rhs) { return lhs.i != rhs.i; }
+    friend constexpr bool operator<(Index lhs, Index rhs) { return lhs.i < rhs.i; }
+};
+
+enum class Color : unsigned char { Red, Green, Blue };
+
+template <>
+struct tim::optional_niche_traits<Index> {
+    static constexpr Index empty_value() noexcept { return Index{-1}; }
+    static constexpr bool is_empty(const Index& v) noexcept { return v.i == -1; }
+};
+
+template <>
+struct tim::optional_niche_traits<Color> {
+    static constexpr Color empty_value() noexcept { return static_cast<Color>(0xff); }
+    static constexpr bool is_empty(const Color& v) noexcept { return v == empty_value(); }
+};
+
+struct NotTrivial {
+    NotTrivial(int v) : i(v) {}
+    NotTrivial(const NotTrivial& other) : i(other.i) {}
+    int i;
+};
+
+template <>
+struct tim::optional_niche_traits<NotTrivial> {
+    static NotTrivial empty_value() noexcept { return NotTrivial(-1); }
+    static bool is_empty(const NotTrivial& v) noexcept { return v.i == -1; }
+};
+
+struct Incomplete;
+struct Base { virtual ~Base() = default; virtual void f() = 0; };
+
+static_assert(sizeof(Optional<Index>) == sizeof(Index), "");
+static_assert(sizeof(Optional<Color>) == sizeof(Color), "");
+static_assert(sizeof(Optional<int*>) == sizeof(int*), "");
+static_assert(sizeof(Optional<const char*>) == sizeof(const char*), "");
+static_assert(sizeof(Optional<int**>) == sizeof(int**), "");
+static_assert(sizeof(Optional<void*>) == sizeof(void*), "");
+static_assert(sizeof(Optional<const volatile void*>) == sizeof(void*), "");
+// No niche: not trivially copyable, pointers to class types, const-qualified.
+static_assert(sizeof(Optional<NotTrivial>) > sizeof(NotTrivial), "");
+static_assert(sizeof(Optional<Incomplete*>) > sizeof(Incomplete*), "");
+static_assert(sizeof(Optional<Base*>) > sizeof(Base*), "");
+static_assert(sizeof(Optional<int* const>) > sizeof(int*), "");
+static_assert(sizeof(Optional<int>) > sizeof(int), "");
+
+static_assert(std::is_trivially_copyable<Optional<Index>>::value, "");
+static_assert(std::is_trivially_destructible<Optional<int*>>::value, "");
+
+constexpr bool test_constexpr()
+{
+    {
+        constexpr Optional<Index> opt;
+        static_assert(!opt, "");
+        static_assert(opt == nullopt, "");
+    }
+    {
+        constexpr Optional<Index> opt(Index{3});
+        static_assert(opt.has_value(), "");
+        static_assert(opt->i == 3, "");
+        static_assert(opt == Index{3}, "");
+        static_assert(opt != nullopt, "");
+    }
+    {
+        Optional<Index> opt(Index{0});
+        assert(opt.has_value());
+        opt.reset();
+        assert(!opt.has_value());
+    }
+    {
+        constexpr Optional<int*> opt;
+        static_assert(!opt, "");
+        constexpr Optional<int*> null_opt(nullptr);
+        static_assert(null_opt.has_value(), "");
+        static_assert(*null_opt == nullptr, "");
+    }
+    return true;
+}
+
+int main(int, char**)
+{
+    static_assert(test_constexpr(), "");
+    {
+        Optional<Index> opt(Index{0});
+        opt = Index{5};
+        assert(opt->i == 5);
+        opt = nullopt;
+        assert(!opt.has_value());
+    }
+    {
+        Optional<Index> a(Index{1});
+        Optional<Index> b;
+        assert(b < a);
+        assert(a != b);
+        a.swap(b);
+        assert(!a);
+        assert(b == Index{1});
+        a.emplace(Index{2});
+        assert(a == Index{2});
+        assert(b < a);
+        Optional<Index> c(a);
+        assert(c == a);
+        c = b;
+        assert(c == Index{1});
+        c = Optional<Index>();
+        assert(!c);
+    }
+    {
+        Optional<Color> c;
+        assert(!c);
+        c = Color::Blue;
+        assert(c == Color::Blue);
+        c.reset();
+        assert(!c);
+    }
+    {
+        int x = 42;
+        Optional<int*> opt;
+        assert(!opt);
+        opt = &x;
+        assert(opt && **opt == 42);
+        opt = nullptr;
+        assert(opt.has_value() && *opt == nullptr);
+        opt = nullopt;
+        assert(!opt);
+        assert(std::hash<Optional<int*>>{}(opt) == 0);
+        opt = &x;
+        assert(std::hash<Optional<int*>>{}(opt) == std::hash<int*>{}(&x));
+    }
+    {
+        Optional<const void*> opt;
+        assert(!opt);
+        Optional<const void*> other(static_cast<const void*>(nullptr));
+        assert(other.has_value());
+        swap(opt, other);
+        assert(opt.has_value() && !other.has_value());
+    }
+    {
+        Optional<NotTrivial> opt(NotTrivial(-1));
+        assert(opt.has_value());
+    }
+
+  return 0;
+}
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <Optional>
+
+// template <class F> constexpr T Optional<T>::value_or_else(F&& f) const&;
+// template <class F> constexpr T Optional<T>::value_or_else(F&& f) &&;
+// template <class F> constexpr remove_cv_t<T> Optional<T&>::value_or_else(F&& f) const;
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <string>
+#include <utility>
+#include <cassert>
+
+#include "test_macros.h"
+#include "count_new.h"
+
+using tim::Optional;
+
+constexpr int seven() { return 7; }
+
+int main(int, char**)
+{
+    {
+        constexpr Optional<int> a(1);
+        constexpr Optional<int> b;
+        static_assert(a.value_or_else(seven) == 1, "");
+        static_assert(b.value_or_else(seven) == 7, "");
+    }
+    {
+        Optional<std::string> present(std::string(100, 'p'));
+        Optional<std::string> empty;
+        int calls = 0;
+        auto make = [&] { ++calls; return std::string(100, 'f'); };
+
+        globalMemCounter.reset();
+        std::string s = empty.value_or_else(make);
+        assert(globalMemCounter.checkNewCalledEq(1));
+        assert(calls == 1);
+        assert(s == std::string(100, 'f'));
+
+        // The fallback is not computed when a value is present.
+        globalMemCounter.reset();
+        std::string moved = std::move(present).value_or_else(make);
+        assert(globalMemCounter.checkNewCalledEq(0));
+        assert(calls == 1);
+        assert(moved == std::string(100, 'p'));
+    }
+    {
+        // A fallback returned by reference yields a reference: no copies either way.
+        const std::string fallback(100, 'f');
+        Optional<std::string> present(std::string(100, 'p'));
+        const Optional<std::string> empty;
+        auto get = [&]() -> const std::string& { return fallback; };
+        static_assert(std::is_same_v<decltype(present.value_or_else(get)), const std::string&>, "");
+        static_assert(std::is_same_v<decltype(std::move(present).value_or_else(get)), std::string>, "");
+
+        globalMemCounter.reset();
+        assert(&present.value_or_else(get) == &*present);
+        assert(&empty.value_or_else(get) == &fallback);
+        assert(globalMemCounter.checkNewCalledEq(0));
+    }
+    {
+        int x = 3;
+        Optional<int&> ref(x);
+        Optional<int&> none;
+        assert(ref.value_or_else(seven) == 3);
+        assert(none.value_or_else(seven) == 7);
+        static_assert(std::is_same_v<decltype(ref.value_or_else(seven)), int>, "");
+    }
+
+  return 0;
+}
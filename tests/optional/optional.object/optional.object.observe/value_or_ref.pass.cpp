@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <Optional>
+
+// constexpr const T& Optional<T>::value_or(const T& v) const&;
+// template <class U> constexpr T Optional<T>::value_or(U&& v) const&;
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <string>
+#include <utility>
+#include <cassert>
+
+#include "test_macros.h"
+#include "count_new.h"
+
+using tim::Optional;
+
+int main(int, char**)
+{
+    const std::string fallback(100, 'f');
+    std::string mutable_fallback(100, 'm');
+    Optional<std::string> present(std::string(100, 'p'));
+    const Optional<std::string> empty;
+    {
+        // Const lvalues of type T bind to the reference-returning overload.
+        static_assert(std::is_same_v<decltype(present.value_or(fallback)), const std::string&>, "");
+        static_assert(std::is_same_v<decltype(empty.value_or(fallback)), const std::string&>, "");
+        static_assert(noexcept(present.value_or(fallback)), "");
+        // Non-const lvalues keep returning a copy.
+        static_assert(std::is_same_v<decltype(present.value_or(mutable_fallback)), std::string>, "");
+        static_assert(std::is_same_v<decltype(empty.value_or(mutable_fallback)), std::string>, "");
+        // Anything else still returns by value, so a temporary fallback never dangles.
+        static_assert(std::is_same_v<decltype(present.value_or(std::string())), std::string>, "");
+        static_assert(std::is_same_v<decltype(present.value_or("abc")), std::string>, "");
+        static_assert(std::is_same_v<decltype(std::move(present).value_or(fallback)), std::string>, "");
+    }
+    {
+        globalMemCounter.reset();
+        const std::string& r = present.value_or(fallback);
+        assert(&r == &*present);
+        const std::string& s = empty.value_or(fallback);
+        assert(&s == &fallback);
+        assert(globalMemCounter.checkNewCalledEq(0));
+    }
+    {
+        // The copy is the caller's to modify, and does not alias the optional.
+        Optional<std::string> opt(std::string(100, 'o'));
+        std::string appended = empty.value_or(mutable_fallback).append("!");
+        assert(appended.size() == 101 && mutable_fallback.size() == 100);
+        const auto& r = opt.value_or(mutable_fallback);
+        assert(&r != &*opt);
+        opt.reset();
+        assert(r == std::string(100, 'o'));
+    }
+    {
+        globalMemCounter.reset();
+        std::string copy = present.value_or(std::string());
+        assert(globalMemCounter.checkNewCalledEq(1));
+        assert(copy == *present);
+    }
+    {
+        constexpr Optional<int> a(1);
+        constexpr Optional<int> b;
+        static_assert(a.value_or(b.value_or(2)) == 1, "");
+        constexpr int two = 2;
+        static_assert(b.value_or(two) == 2, "");
+    }
+
+  return 0;
+}
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <Optional>
+
+// With TIM_OPTIONAL_ENABLE_TRIVIAL_ABI, Optional<T> is returned and passed in
+// registers when 'T' is.  A value returned in registers is necessarily a
+// different object from the callee's local, so comparing addresses tells the
+// two calling conventions apart.
+
+#define TIM_OPTIONAL_ENABLE_TRIVIAL_ABI
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <utility>
+#include <cassert>
+
+#include "test_macros.h"
+
+using tim::Optional;
+
+#if TIM_OPTIONAL_HAS_TRIVIAL_ABI
+# define TEST_TRIVIAL_ABI [[clang::trivial_abi]]
+#else
+# define TEST_TRIVIAL_ABI
+#endif
+
+template <bool>
+struct Handle
+{
+    explicit Handle(int* released) : released_(released) {}
+    Handle(Handle&& other) noexcept : released_(std::exchange(other.released_, nullptr)) {}
+    Handle& operator=(Handle&& other) noexcept { std::swap(released_, other.released_); return *this; }
+    ~Handle() { if (released_) ++*released_; }
+    int* released_;
+};
+
+template <>
+struct TEST_TRIVIAL_ABI Handle<true>
+{
+    explicit Handle(int* released) : released_(released) {}
+    Handle(Handle&& other) noexcept : released_(std::exchange(other.released_, nullptr)) {}
+    Handle& operator=(Handle&& other) noexcept { std::swap(released_, other.released_); return *this; }
+    ~Handle() { if (released_) ++*released_; }
+    int* released_;
+};
+
+using SmallHandle = Handle<true>;
+using PlainHandle = Handle<false>;
+
+template <class T>
+TEST_NOINLINE Optional<T> make(int* released, void** local_addr)
+{
+    Optional<T> ret(tim::in_place, released);
+    *local_addr = &ret;
+    return ret;
+}
+
+template <class T>
+TEST_NOINLINE void consume(Optional<T> o, void** param_addr)
+{
+    *param_addr = &o;
+}
+
+template <class T>
+void test(bool in_registers)
+{
+    int released = 0;
+    {
+        void* local_addr = nullptr;
+        Optional<T> ret = make<T>(&released, &local_addr);
+        assert(ret.has_value());
+        assert(released == 0);
+        if (in_registers)
+            assert(static_cast<void*>(&ret) != local_addr);
+#if defined(__GNUC__)
+        else
+            assert(static_cast<void*>(&ret) == local_addr);
+#endif
+        void* param_addr = nullptr;
+        Optional<T> arg(std::move(ret));
+        consume<T>(std::move(arg), &param_addr);
+        assert(released == 1);
+        (void)param_addr;
+    }
+    assert(released == 1);
+    {
+        void* local_addr = nullptr;
+        Optional<T> ret = make<T>(&released, &local_addr);
+        ret.reset();
+        assert(released == 2);
+    }
+    assert(released == 2);
+}
+
+int main(int, char**)
+{
+    static_assert(sizeof(Optional<SmallHandle>) == sizeof(Optional<PlainHandle>), "");
+#if TIM_OPTIONAL_HAS_TRIVIAL_ABI
+    static_assert(tim::is_trivially_relocatable_v<SmallHandle>, "");
+    static_assert(tim::is_trivially_relocatable_v<Optional<SmallHandle>>, "");
+#endif
+    static_assert(!tim::is_trivially_relocatable_v<PlainHandle>, "");
+
+    test<SmallHandle>(TIM_OPTIONAL_HAS_TRIVIAL_ABI);
+    test<PlainHandle>(false);
+
+  return 0;
+}
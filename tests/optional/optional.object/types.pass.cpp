@@ -18,11 +18,72 @@
 
 #include "tim/optional/Optional.hpp"
 #include <type_traits>
+#include <cstdint>
+#include <cassert>
 
 #include "test_macros.h"
 
 using tim::Optional;
 
+struct Empty {};
+
+struct NonPod {
+    NonPod() {}
+    std::int64_t a;
+    std::int32_t b;
+};
+
+struct Pod {
+    std::int64_t a;
+    std::int32_t b;
+};
+
+struct alignas(64) Vec3 {
+    Vec3() {}
+    float xyz[3];
+};
+
+struct alignas(64) PodVec3 {
+    float xyz[3];
+};
+
+struct CountedEmpty {
+    CountedEmpty() {}
+    ~CountedEmpty() {}
+};
+
+// The flag never costs more than one alignment unit.
+template <class T>
+constexpr bool size_bounded()
+{
+    return sizeof(Optional<T>) <= sizeof(T) + alignof(T)
+        && alignof(Optional<T>) == alignof(T);
+}
+
+static_assert(size_bounded<char>(), "");
+static_assert(size_bounded<int>(), "");
+static_assert(size_bounded<double>(), "");
+static_assert(size_bounded<Pod>(), "");
+static_assert(size_bounded<NonPod>(), "");
+static_assert(size_bounded<PodVec3>(), "");
+static_assert(size_bounded<Vec3>(), "");
+static_assert(size_bounded<CountedEmpty>(), "");
+
+static_assert(sizeof(Optional<char>) == 2, "");
+static_assert(sizeof(Optional<Empty>) == 1, "");
+static_assert(sizeof(Optional<const Empty>) <= 2, "");
+static_assert(sizeof(Optional<CountedEmpty>) <= 2, "");
+
+#if defined(__has_cpp_attribute) && !defined(_MSC_VER)
+#if __has_cpp_attribute(no_unique_address)
+// Itanium ABI: the flag is placed in the tail padding of non-POD payloads.
+static_assert(sizeof(Optional<NonPod>) == sizeof(NonPod), "");
+static_assert(sizeof(Optional<Vec3>) == sizeof(Vec3), "");
+static_assert(sizeof(Optional<Pod>) == sizeof(Pod) + alignof(Pod), "");
+static_assert(sizeof(Optional<PodVec3>) == sizeof(PodVec3) + alignof(PodVec3), "");
+#endif
+#endif
+
 template <class Opt, class T>
 void
 test()
@@ -36,6 +97,26 @@ int main(int, char**)
     test<Optional<const int>, const int>();
     test<Optional<double>, double>();
     test<Optional<const double>, const double>();
+    test<Optional<Empty>, Empty>();
+
+    {
+        Optional<Empty> e;
+        assert(!e);
+        e.emplace();
+        assert(e.has_value());
+        e.reset();
+        assert(!e);
+    }
+    {
+        Optional<NonPod> o;
+        assert(!o);
+        o.emplace();
+        o->a = -1;
+        o->b = -1;
+        assert(o.has_value());
+        o.reset();
+        assert(!o);
+    }
 
   return 0;
 }
@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <OnceOptional>
+
+// template <class T> class OnceOptional;
+
+#include "tim/optional/OnceOptional.hpp"
+#include <type_traits>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+#include "count_new.h"
+
+using tim::Optional;
+using tim::OnceOptional;
+
+struct Pinned
+{
+    static int alive;
+    int i_;
+    explicit Pinned(int i) : i_(i) { ++alive; }
+    Pinned(const Pinned&) = delete;
+    ~Pinned() { --alive; }
+};
+
+int Pinned::alive = 0;
+
+// Usable as a constant-initialized global.
+OnceOptional<std::string> global_cache;
+
+void test_single_thread()
+{
+    {
+        OnceOptional<Pinned> once;
+        assert(!once.has_value());
+        assert(!once.get());
+        int calls = 0;
+        Pinned& p = once.get_or_init([&] { ++calls; return Pinned(4); });
+        assert(p.i_ == 4 && calls == 1);
+        Pinned& q = once.get_or_init([&] { ++calls; return Pinned(5); });
+        assert(&p == &q && calls == 1);
+        assert(once.has_value());
+        assert(&*once.get() == &p);
+        const OnceOptional<Pinned>& c = once;
+        static_assert(std::is_same_v<decltype(c.get()), Optional<const Pinned&>>, "");
+        assert(c.get()->i_ == 4);
+        assert(Pinned::alive == 1);
+    }
+    assert(Pinned::alive == 0);
+    {
+        globalMemCounter.reset();
+        std::string& s = global_cache.get_or_init([] { return std::string(100, 'x'); });
+        assert(globalMemCounter.checkNewCalledEq(1));
+        assert(s.size() == 100);
+    }
+}
+
+void test_exception_retry()
+{
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    OnceOptional<int> once;
+    try {
+        once.get_or_init([]() -> int { throw 1; });
+        assert(false);
+    } catch(int) {
+    }
+    assert(!once.has_value());
+    assert(once.get_or_init([] { return 2; }) == 2);
+
+    // The first initializer throws while others wait; exactly one of them
+    // then takes over.
+    OnceOptional<int> shared;
+    std::atomic<int> attempts{0};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 8; ++t) {
+        threads.emplace_back([&]() {
+            try {
+                int v = shared.get_or_init([&]() {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    if(attempts.fetch_add(1) == 0) {
+                        throw 1;
+                    }
+                    return 7;
+                });
+                assert(v == 7);
+            } catch(int) {
+                failures.fetch_add(1);
+            }
+        });
+    }
+    for(auto& t : threads) {
+        t.join();
+    }
+    assert(failures.load() == 1);
+    assert(attempts.load() == 2);
+    assert(*shared.get() == 7);
+#endif
+}
+
+void test_concurrent()
+{
+    for(int round = 0; round < 20; ++round) {
+        OnceOptional<std::vector<int>> once;
+        std::atomic<int> calls{0};
+        std::atomic<bool> go{false};
+        std::vector<const std::vector<int>*> seen(16);
+        std::vector<std::thread> threads;
+        for(int t = 0; t < 16; ++t) {
+            threads.emplace_back([&, t]() {
+                while(!go.load()) {
+                    std::this_thread::yield();
+                }
+                const std::vector<int>& v = once.get_or_init([&]() {
+                    calls.fetch_add(1);
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    return std::vector<int>(1000, 3);
+                });
+                assert(v.size() == 1000 && v[999] == 3);
+                seen[t] = &v;
+            });
+        }
+        go.store(true);
+        for(auto& t : threads) {
+            t.join();
+        }
+        assert(calls.load() == 1);
+        for(auto* p : seen) {
+            assert(p == &*once.get());
+        }
+    }
+}
+
+int main(int, char**)
+{
+    test_single_thread();
+    test_exception_retry();
+    test_concurrent();
+
+  return 0;
+}
@@ -0,0 +1,241 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <PersistentOptional>
+
+// template <class T> class PersistentOptional;
+// template <class T> class PersistentOptionalArray;
+
+#include "tim/optional/PersistentOptional.hpp"
+#include <type_traits>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::PersistentOptional;
+using tim::PersistentOptionalArray;
+
+// A last-processed offset, with fields derived from it so that a torn record
+// is detectable independently of the checksum.
+struct Offset
+{
+    std::uint64_t offset;
+    std::uint32_t partition;
+    std::uint32_t check;
+    std::uint64_t words[6];
+};
+
+Offset make_offset(std::uint64_t offset, std::uint32_t partition)
+{
+    Offset o{};
+    o.offset = offset;
+    o.partition = partition;
+    o.check = static_cast<std::uint32_t>(offset * 31 + partition);
+    for(std::uint64_t i = 0; i < 6; ++i)
+        o.words[i] = offset ^ (i << 40);
+    return o;
+}
+
+bool consistent(const Offset& o, std::uint32_t partition)
+{
+    if(o.partition != partition || o.check != static_cast<std::uint32_t>(o.offset * 31 + partition))
+        return false;
+    for(std::uint64_t i = 0; i < 6; ++i) {
+        if(o.words[i] != (o.offset ^ (i << 40)))
+            return false;
+    }
+    return true;
+}
+
+static_assert(std::is_standard_layout_v<PersistentOptional<Offset>>, "");
+
+struct MappedFile
+{
+    explicit MappedFile(std::size_t bytes) : size(bytes)
+    {
+        char name[] = "/tmp/persistent_optional_XXXXXX";
+        fd = ::mkstemp(name);
+        assert(fd >= 0);
+        ::unlink(name);
+        int resized = ::ftruncate(fd, static_cast<off_t>(size));
+        assert(resized == 0);
+        (void)resized;
+        data = map();
+    }
+
+    // A second, independent mapping of the same file, as a restarted process
+    // would see it.
+    void* map() const
+    {
+        void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        assert(p != MAP_FAILED);
+        return p;
+    }
+
+    ~MappedFile()
+    {
+        ::munmap(data, size);
+        ::close(fd);
+    }
+
+    std::size_t size;
+    int fd;
+    void* data;
+};
+
+void test_single_slot()
+{
+    MappedFile file(4096);
+    auto slots = PersistentOptionalArray<Offset>::from_region(file.data, file.size);
+    assert(slots.size() == 4096 / sizeof(PersistentOptional<Offset>));
+    // A zero-filled file is all empty slots.
+    assert(slots.recover() == 0);
+    PersistentOptional<Offset>& s = slots[0];
+    assert(!s.has_value() && !s.is_committed() && !s.load() && !s.recover());
+
+    s.store(make_offset(10, 0));
+    assert(s.has_value() && s.is_committed() && s.recover());
+    assert(s.load()->offset == 10);
+    s.store(Optional<Offset>(make_offset(11, 0)));
+    assert(slots.load(0)->offset == 11);
+    s.store(Optional<Offset>());
+    assert(!s.has_value() && !s.load());
+
+    // A committed flag over a corrupted payload is not a value, and recovery
+    // discards it.
+    s.store(make_offset(12, 0));
+    auto* bytes = static_cast<unsigned char*>(file.data);
+    bytes[sizeof(PersistentOptional<Offset>) - 1] ^= 0x40u;
+    assert(s.is_committed() && !s.has_value() && !s.load());
+    assert(!s.recover() && !s.is_committed());
+
+    // So is garbage in the flag.
+    slots[1].store(make_offset(13, 1));
+    std::memset(bytes + sizeof(PersistentOptional<Offset>), 0x5a, 8);
+    assert(!slots.load(1) && !slots[1].has_value());
+    assert(slots.recover() == 1);
+    assert(!slots[1].is_committed());
+}
+
+void test_commit()
+{
+    MappedFile file(4096);
+    auto slots = PersistentOptionalArray<Offset>::from_region(file.data, file.size);
+    std::vector<Optional<Offset>> values;
+    for(std::uint32_t i = 0; i < 8; ++i)
+        values.push_back(i % 3 == 0 ? Optional<Offset>() : Optional<Offset>(make_offset(100 + i, i + 2)));
+    slots.commit(2, values.data(), values.size());
+    slots.commit(0, nullptr, 0);
+    assert(!slots.load(0) && !slots.load(1) && !slots.load(10));
+    for(std::uint32_t i = 0; i < 8; ++i) {
+        Optional<Offset> v = slots.load(i + 2);
+        assert(v.has_value() == values[i].has_value());
+        assert(!v || consistent(*v, i + 2));
+        (void)v;
+    }
+    // Visible through another mapping of the file.
+    auto other = PersistentOptionalArray<Offset>::from_region(file.map(), file.size);
+    assert(other.load(3)->offset == 101);
+    ::munmap(&other[0], file.size);
+}
+
+// A forked writer commits batches and single slots until it is killed at a
+// random moment after its first commit; every slot recovered afterwards is
+// empty or whole.  SIGKILL leaves the page cache intact, so this covers the
+// order of the stores, not that of the flushes: losing unflushed pages takes
+// a power cut, which a test cannot simulate.
+void test_killed_writer()
+{
+    constexpr std::uint32_t count = 64;
+    MappedFile file(count * sizeof(PersistentOptional<Offset>));
+    std::mt19937 rng(12345);
+    std::uint64_t nonempty = 0;
+    for(int round = 0; round < 20; ++round) {
+        // The child reports its first completed commit through 'ready', so
+        // that the random delay is not used up by a slow start.
+        int ready[2];
+        int piped = ::pipe(ready);
+        assert(piped == 0);
+        (void)piped;
+        pid_t child = ::fork();
+        assert(child >= 0);
+        if(child == 0) {
+            ::close(ready[0]);
+            auto slots = PersistentOptionalArray<Offset>::from_region(file.data, file.size);
+            std::vector<Optional<Offset>> values(count);
+            for(std::uint64_t n = 1;; ++n) {
+                for(std::uint32_t i = 0; i < count; ++i) {
+                    if((n + i) % 7 == 0)
+                        values[i].reset();
+                    else
+                        values[i].emplace(make_offset(n * count + i, i));
+                }
+                slots.commit(0, values.data(), count);
+                std::uint32_t i = static_cast<std::uint32_t>(n % count);
+                slots[i].store(make_offset(n, i));
+                if(n == 1) {
+                    char byte = 1;
+                    ssize_t written = ::write(ready[1], &byte, 1);
+                    (void)written;
+                    ::close(ready[1]);
+                }
+            }
+        }
+        ::close(ready[1]);
+        char byte = 0;
+        ssize_t got = ::read(ready[0], &byte, 1);
+        assert(got == 1);
+        (void)got;
+        ::close(ready[0]);
+        std::this_thread::sleep_for(std::chrono::microseconds(200 + rng() % 3000));
+        ::kill(child, SIGKILL);
+        int status = 0;
+        pid_t waited = ::waitpid(child, &status, 0);
+        assert(waited == child);
+        (void)waited;
+        assert(WIFSIGNALED(status));
+
+        void* region = file.map();
+        auto slots = PersistentOptionalArray<Offset>::from_region(region, file.size);
+        slots.recover();
+        for(std::uint32_t i = 0; i < count; ++i) {
+            Optional<Offset> v = slots.load(i);
+            assert(v.has_value() == slots[i].has_value());
+            if(v) {
+                assert(consistent(*v, i));
+                ++nonempty;
+            }
+        }
+        ::munmap(region, file.size);
+    }
+    assert(nonempty > 0);
+}
+
+int main(int, char**)
+{
+    test_single_slot();
+    test_commit();
+    test_killed_writer();
+
+  return 0;
+}
@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <MPMCQueue>
+
+// template <class T> class MPMCQueue;
+
+#include "tim/optional/MPMCQueue.hpp"
+#include <type_traits>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::MPMCQueue;
+
+// Counts every construction, so that the path from slot to result can be
+// checked to be exactly one move.
+struct Tracked
+{
+    static int alive;
+    static int copies;
+    static int moves;
+    static int defaults;
+    int i_;
+    Tracked() : i_(0) { ++alive; ++defaults; }
+    explicit Tracked(int i) : i_(i) { ++alive; }
+    Tracked(const Tracked& o) : i_(o.i_) { ++alive; ++copies; }
+    Tracked(Tracked&& o) noexcept : i_(o.i_) { o.i_ = -1; ++alive; ++moves; }
+    Tracked& operator=(const Tracked&) { assert(false); return *this; }
+    Tracked& operator=(Tracked&&) { assert(false); return *this; }
+    ~Tracked() { --alive; }
+
+    static void reset() { copies = moves = defaults = 0; }
+};
+
+int Tracked::alive = 0;
+int Tracked::copies = 0;
+int Tracked::moves = 0;
+int Tracked::defaults = 0;
+
+void test_basic()
+{
+    MPMCQueue<int> q(5);
+    assert(q.capacity() == 8);
+    assert(MPMCQueue<int>(0).capacity() == 2);
+    assert(!q.try_pop());
+    for(int i = 0; i < 8; ++i)
+        assert(q.try_push(i));
+    assert(!q.try_push(8));
+    for(int i = 0; i < 8; ++i) {
+        Optional<int> v = q.try_pop();
+        assert(v && *v == i);
+    }
+    assert(!q.try_pop());
+    // Wrap around the ring a few times.
+    for(int i = 0; i < 100; ++i) {
+        assert(q.try_push(i));
+        assert(q.try_push(i + 1000));
+        assert(*q.try_pop() == i);
+        assert(*q.try_pop() == i + 1000);
+    }
+    static_assert(std::is_same_v<decltype(q.try_pop()), Optional<int>>, "");
+    static_assert(noexcept(q.try_pop()), "");
+}
+
+void test_single_move()
+{
+    {
+        MPMCQueue<Tracked> q(4);
+        assert(q.try_emplace(1));
+        assert(q.try_emplace(2));
+        assert(q.try_emplace(3));
+        Tracked::reset();
+        Optional<Tracked> v = q.try_pop();
+        assert(v && v->i_ == 1);
+        assert(Tracked::moves == 1 && Tracked::copies == 0 && Tracked::defaults == 0);
+
+        Tracked::reset();
+        Optional<Tracked> out;
+        assert(q.try_pop_into(out));
+        assert(out && out->i_ == 2);
+        assert(Tracked::moves == 1 && Tracked::copies == 0 && Tracked::defaults == 0);
+        // Over an engaged optional.
+        assert(q.try_pop_into(out));
+        assert(out->i_ == 3);
+        assert(!q.try_pop_into(out));
+        assert(out->i_ == 3);
+
+        Tracked t(4);
+        Tracked::reset();
+        assert(q.try_push(std::move(t)));
+        assert(Tracked::moves == 1);
+        assert(q.try_push(t));
+        assert(Tracked::copies == 1);
+        assert(Tracked::alive == 5);
+    }
+    // Values left in the queue are destroyed with it.
+    assert(Tracked::alive == 0);
+}
+
+void test_throwing_construct()
+{
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    // Throws from its constructor on request, but moves without throwing.
+    struct MayThrow
+    {
+        int i_;
+        explicit MayThrow(int i) : i_(i) { if(i < 0) throw i; }
+        MayThrow(MayThrow&&) noexcept = default;
+    };
+    MPMCQueue<MayThrow> q(2);
+    assert(q.try_emplace(1));
+    try {
+        q.try_emplace(-1);
+        assert(false);
+    } catch(int) {
+    }
+    // No slot was claimed by the failed emplace.
+    assert(q.try_emplace(2));
+    assert(q.try_pop()->i_ == 1);
+    assert(q.try_pop()->i_ == 2);
+    assert(!q.try_pop());
+#endif
+}
+
+void test_threads()
+{
+    constexpr int producers = 2;
+    constexpr int consumers = 2;
+    constexpr int per_producer = 20000;
+    MPMCQueue<std::unique_ptr<int>> q(64);
+    std::vector<std::atomic<int>> seen(producers * per_producer);
+    std::atomic<int> popped{0};
+    std::vector<std::thread> threads;
+    for(int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for(int i = 0; i < per_producer; ++i) {
+                auto v = std::make_unique<int>(p * per_producer + i);
+                while(!q.try_push(std::move(v)))
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for(int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            int last[producers] = {-1, -1};
+            while(popped.load() < producers * per_producer) {
+                Optional<std::unique_ptr<int>> v = q.try_pop();
+                if(!v) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                int n = **v;
+                // Each producer's values come out in the order they went in.
+                assert(n % per_producer > last[n / per_producer]);
+                last[n / per_producer] = n % per_producer;
+                seen[n].fetch_add(1);
+                popped.fetch_add(1);
+            }
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    for(auto& s : seen)
+        assert(s.load() == 1);
+    assert(!q.try_pop());
+}
+
+int main(int, char**)
+{
+    test_basic();
+    test_single_move();
+    test_throwing_construct();
+    test_threads();
+
+  return 0;
+}
@@ -0,0 +1,184 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <Reclaimer>
+
+// class Reclaimer;
+// template <class R> void Optional<T>::reset(defer_to_t<R>) noexcept;
+
+#include "tim/optional/Reclaimer.hpp"
+#include <type_traits>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::Reclaimer;
+using tim::defer_to;
+
+// Records how many are alive and which thread destroyed the last one.
+struct Counted
+{
+    static std::atomic<int> alive;
+    static std::atomic<std::thread::id> destroyed_on;
+    int i_;
+    explicit Counted(int i) : i_(i) { ++alive; }
+    Counted(const Counted& o) noexcept : i_(o.i_) { ++alive; }
+    ~Counted() { --alive; destroyed_on.store(std::this_thread::get_id()); }
+};
+
+std::atomic<int> Counted::alive{0};
+std::atomic<std::thread::id> Counted::destroyed_on{};
+
+// Too big for a queue entry.
+struct Big
+{
+    Counted c;
+    char bytes[64];
+};
+
+void test_deferred()
+{
+    Reclaimer r(16, std::chrono::hours(1));
+    Optional<std::vector<Counted>> opt(tim::in_place, 100, Counted(1));
+    assert(Counted::alive == 100);
+    static_assert(noexcept(opt.reset(defer_to(r))), "");
+    opt.reset(defer_to(r));
+    assert(!opt);
+    // Nothing has been destroyed yet.
+    assert(Counted::alive == 100);
+    r.flush();
+    assert(Counted::alive == 0);
+    assert(Counted::destroyed_on.load() != std::this_thread::get_id());
+    assert(r.reclaimed() == 1);
+
+    // Resetting an empty optional retires nothing.
+    opt.reset(defer_to(r));
+    opt.emplace(3, Counted(2));
+    opt.reset(defer_to(r));
+    r.flush();
+    assert(r.reclaimed() == 2 && Counted::alive == 0);
+
+    // Trivially destructible payloads are simply dropped.
+    Optional<int> i(3);
+    i.reset(defer_to(r));
+    assert(!i);
+}
+
+void test_inline_fallbacks()
+{
+    Reclaimer r(2, std::chrono::hours(1));
+    static_assert(Reclaimer::can_defer<std::string>(), "");
+    static_assert(!Reclaimer::can_defer<Big>(), "");
+
+    // Too big: destroyed inline.
+    Optional<Big> big(Big{Counted(1), {}});
+    assert(Counted::alive == 1);
+    big.reset(defer_to(r));
+    assert(!big && Counted::alive == 0);
+    assert(Counted::destroyed_on.load() == std::this_thread::get_id());
+
+    // A full queue: the third is destroyed inline.
+    std::vector<Optional<Counted>> v;
+    for(int i = 0; i < 3; ++i)
+        v.emplace_back(tim::in_place, i);
+    for(auto& o : v)
+        o.reset(defer_to(r));
+    assert(Counted::alive == 2);
+    r.flush();
+    assert(Counted::alive == 0 && r.reclaimed() == 2);
+}
+
+void test_destructor_drains()
+{
+    {
+        Reclaimer r(8, std::chrono::hours(1));
+        Optional<Counted> c(tim::in_place, 1);
+        c.reset(defer_to(r));
+        assert(Counted::alive == 1);
+    }
+    assert(Counted::alive == 0);
+}
+
+void test_threads()
+{
+    Reclaimer r(64, std::chrono::microseconds(100));
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for(int i = 0; i < 2000; ++i) {
+                Optional<std::unique_ptr<Counted>> p(std::make_unique<Counted>(i));
+                p.reset(defer_to(r));
+                assert(!p);
+            }
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    // Queues of exited threads are reused by new ones.
+    std::thread([&] {
+        Optional<std::unique_ptr<Counted>> p(std::make_unique<Counted>(0));
+        p.reset(defer_to(r));
+    }).join();
+    r.flush();
+    assert(Counted::alive == 0);
+}
+
+// Dynamically initialized before the thread's retire queues, so destroyed
+// after them.
+struct LateReset
+{
+    Reclaimer* r_ = nullptr;
+    Optional<Counted> c_;
+    LateReset() { assert(!c_); }
+    ~LateReset() { c_.reset(defer_to(*r_)); }
+};
+
+LateReset& late_reset()
+{
+    thread_local LateReset late;
+    return late;
+}
+
+void test_thread_exit()
+{
+    Reclaimer r(8, std::chrono::hours(1));
+    std::thread::id exiting_id;
+    std::thread exiting([&] {
+        exiting_id = std::this_thread::get_id();
+        LateReset& late = late_reset();
+        late.r_ = &r;
+        late.c_.emplace(1);
+        Optional<Counted> early(tim::in_place, 2);
+        early.reset(defer_to(r));
+    });
+    exiting.join();
+    // The late one is destroyed inline, on its own thread.
+    assert(Counted::alive == 1);
+    assert(Counted::destroyed_on.load() == exiting_id);
+    r.flush();
+    assert(Counted::alive == 0 && r.reclaimed() == 1);
+}
+
+int main(int, char**)
+{
+    test_deferred();
+    test_inline_fallbacks();
+    test_destructor_drains();
+    test_threads();
+    test_thread_exit();
+
+  return 0;
+}
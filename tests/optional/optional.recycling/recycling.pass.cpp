@@ -0,0 +1,221 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <RecyclingOptional>
+
+// template <class T> class RecyclingOptional;
+
+#include "tim/optional/RecyclingOptional.hpp"
+#include <type_traits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+#include "count_new.h"
+
+using tim::Optional;
+using tim::RecyclingOptional;
+
+// Long enough to defeat the small string optimization.
+const char* const request_text = "a request payload that is much longer than any small string buffer";
+
+struct Buffer
+{
+    static int alive;
+    static int cleared;
+    int size_ = 0;
+    Buffer() { ++alive; }
+    explicit Buffer(int size) : size_(size) { ++alive; }
+    Buffer(const Buffer& other) : size_(other.size_) { ++alive; }
+    Buffer& operator=(const Buffer&) = default;
+    ~Buffer() { --alive; }
+};
+
+int Buffer::alive = 0;
+int Buffer::cleared = 0;
+
+// A type without 'clear()', recycled through a specialization.
+namespace tim {
+template <>
+struct recycle_traits<Buffer> {
+    static constexpr bool can_recycle = true;
+    static void clear(Buffer& b) noexcept { b.size_ = 0; ++Buffer::cleared; }
+};
+}
+
+struct Plain
+{
+    static int alive;
+    int i_;
+    explicit Plain(int i) : i_(i) { ++alive; }
+    Plain(const Plain& other) : i_(other.i_) { ++alive; }
+    Plain& operator=(const Plain&) = default;
+    ~Plain() { --alive; }
+};
+
+int Plain::alive = 0;
+
+void test_basics()
+{
+    RecyclingOptional<std::string> r;
+    assert(!r.has_value() && !r && !r.holds_storage());
+    assert(!r.get());
+    r = std::string(request_text);
+    assert(r.has_value() && *r == request_text);
+    assert(r->size() == std::char_traits<char>::length(request_text));
+    assert(&*r.get() == &*r);
+    r.reset();
+    assert(!r.has_value() && r.holds_storage());
+    assert(!r.get());
+    std::string& s = r.emplace();
+    assert(r.has_value() && s.empty() && &s == &*r);
+    r = tim::nullopt;
+    assert(!r);
+    r.emplace(3u, 'x');
+    assert(*r == "xxx");
+    r.release();
+    assert(!r.has_value() && !r.holds_storage());
+
+    const RecyclingOptional<std::string> c(tim::in_place, "abc");
+    static_assert(std::is_same_v<decltype(*c), const std::string&>, "");
+    static_assert(std::is_same_v<decltype(c.get()), Optional<const std::string&>>, "");
+    assert(c.value() == "abc");
+    static_assert(!std::is_copy_constructible_v<RecyclingOptional<std::string>>, "");
+    static_assert(!std::is_move_assignable_v<RecyclingOptional<std::string>>, "");
+}
+
+void test_customized()
+{
+    {
+        RecyclingOptional<Buffer> r;
+        r.emplace(8);
+        assert(Buffer::alive == 1 && r->size_ == 8);
+        r.reset();
+        assert(Buffer::alive == 1 && Buffer::cleared == 1 && r->size_ == 0);
+        r.emplace();
+        assert(Buffer::alive == 1 && r.has_value());
+        r = Buffer(5);
+        assert(Buffer::alive == 1 && r->size_ == 5);
+    }
+    assert(Buffer::alive == 0);
+    {
+        // Without a way to clear it, 'reset()' destroys as Optional<T> does.
+        RecyclingOptional<Plain> r(tim::in_place, 1);
+        r.reset();
+        assert(Plain::alive == 0 && !r.holds_storage());
+        r = Plain(2);
+        assert(Plain::alive == 1 && r->i_ == 2);
+    }
+    assert(Plain::alive == 0);
+    {
+        // std::stringstream::clear() only resets the error state, so streams
+        // are not recycled by default.
+        static_assert(tim::recycle_traits<std::string>::can_recycle, "");
+        static_assert(tim::recycle_traits<std::vector<int>>::can_recycle, "");
+        static_assert(!tim::recycle_traits<std::stringstream>::can_recycle, "");
+        RecyclingOptional<std::stringstream> r(tim::in_place);
+        *r << "previous request";
+        r.reset();
+        assert(!r.holds_storage());
+        r.emplace();
+        assert(r->str().empty());
+    }
+}
+
+// One request: fill the scratch string and vector, use them, and empty them.
+template <class StringOpt, class VectorOpt>
+std::size_t handle_request(StringOpt& text, VectorOpt& numbers, int request)
+{
+    text = request_text;
+    auto& v = numbers.emplace();
+    for(int i = 0; i < 100; ++i)
+        v.push_back(request + i);
+    std::size_t result = text->size() + v.size();
+    text.reset();
+    numbers.reset();
+    return result;
+}
+
+void test_steady_state_allocations()
+{
+    const int requests = 16;
+    {
+        // Optional<T> frees and allocates again on every request.
+        Optional<std::string> text;
+        Optional<std::vector<int>> numbers;
+        globalMemCounter.reset();
+        for(int i = 0; i < requests; ++i)
+            assert(handle_request(text, numbers, i) == 166);
+        assert(globalMemCounter.checkNewCalledGreaterThan(2 * requests - 1));
+    }
+    {
+        RecyclingOptional<std::string> text;
+        RecyclingOptional<std::vector<int>> numbers;
+        globalMemCounter.reset();
+        // The first request allocates; the rest reuse what it allocated.
+        assert(handle_request(text, numbers, 0) == 166);
+        const int first_new = globalMemCounter.new_called;
+        const int first_delete = globalMemCounter.delete_called;
+        assert(first_new >= 2);
+        for(int i = 1; i < requests; ++i)
+            assert(handle_request(text, numbers, i) == 166);
+        assert(globalMemCounter.checkNewCalledEq(first_new));
+        assert(globalMemCounter.checkDeleteCalledEq(first_delete));
+        text.release();
+        numbers.release();
+        assert(!text.holds_storage() && !numbers.holds_storage());
+    }
+}
+
+#ifndef TEST_HAS_NO_EXCEPTIONS
+struct Fussy
+{
+    int i_ = 0;
+    Fussy() = default;
+    explicit Fussy(int i) : i_(i) {}
+    Fussy& operator=(int i) { if(i < 0) throw i; i_ = i; return *this; }
+    void clear() noexcept { i_ = 0; }
+    bool empty() const noexcept { return i_ == 0; }
+};
+
+void test_exceptions()
+{
+    RecyclingOptional<Fussy> r;
+    r.emplace();
+    r = 4;
+    try {
+        r = -1;
+        assert(false);
+    } catch(int i) {
+        assert(i == -1);
+    }
+    assert(!r.has_value() && r.holds_storage());
+    try {
+        r.value();
+        assert(false);
+    } catch(const tim::BadOptionalAccess&) {
+    }
+    r = 7;
+    assert(r.value().i_ == 7);
+}
+#endif
+
+int main(int, char**)
+{
+    test_basics();
+    test_customized();
+    test_steady_state_allocations();
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    test_exceptions();
+#endif
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <Optional>
+
+// template <class T> class Optional<T&>;
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <functional>
+#include <string>
+#include <cassert>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::nullopt;
+using tim::in_place;
+using tim::BadOptionalAccess;
+
+struct Base { int i = 1; };
+struct Derived : Base { int j = 2; };
+
+static_assert(sizeof(Optional<int&>) == sizeof(int*), "");
+static_assert(sizeof(Optional<std::string&>) == sizeof(std::string*), "");
+static_assert(std::is_trivially_copyable<Optional<int&>>::value, "");
+static_assert(std::is_trivially_destructible<Optional<std::string&>>::value, "");
+static_assert(std::is_same<Optional<int&>::value_type, int&>::value, "");
+
+// Binding to temporaries is rejected.
+static_assert(std::is_constructible<Optional<const int&>, int&>::value, "");
+static_assert(std::is_constructible<Optional<const int&>, const int&>::value, "");
+static_assert(!std::is_constructible<Optional<const int&>, int>::value, "");
+static_assert(!std::is_constructible<Optional<const int&>, int&&>::value, "");
+static_assert(!std::is_constructible<Optional<const long&>, int&>::value, "");
+static_assert(!std::is_constructible<Optional<int&>, const int&>::value, "");
+static_assert(!std::is_assignable<Optional<const int&>&, int>::value, "");
+static_assert(std::is_constructible<Optional<Base&>, Derived&>::value, "");
+static_assert(std::is_convertible<Optional<Derived&>, Optional<Base&>>::value, "");
+static_assert(!std::is_convertible<Optional<Base&>, Optional<Derived&>>::value, "");
+
+constexpr int global = 7;
+
+constexpr bool test_constexpr()
+{
+    constexpr Optional<const int&> empty;
+    static_assert(!empty, "");
+    constexpr Optional<const int&> opt(global);
+    static_assert(opt.has_value(), "");
+    static_assert(*opt == 7, "");
+    static_assert(opt == 7, "");
+    static_assert(opt != nullopt, "");
+    static_assert(empty < opt, "");
+    return true;
+}
+
+int main(int, char**)
+{
+    static_assert(test_constexpr(), "");
+    {
+        int x = 1;
+        int y = 2;
+        Optional<int&> a(x);
+        assert(a && &*a == &x);
+        *a = 3;
+        assert(x == 3);
+        a = y;
+        assert(&*a == &y);
+        assert(x == 3);
+        Optional<int&> b = a;
+        assert(&*b == &y);
+        b = nullopt;
+        assert(!b);
+        assert(a.value_or(42) == 2);
+        assert(b.value_or(42) == 42);
+        b.emplace(x);
+        assert(&*b == &x);
+        swap(a, b);
+        assert(&*a == &x && &*b == &y);
+        assert(&b.gut() == &y);
+        assert(!b);
+    }
+    {
+        int x = 1;
+        Optional<const int&> a(in_place, x);
+        Optional<const int&> b;
+        swap(a, b);
+        assert(!a && &*b == &x);
+        a.swap(b);
+        assert(&*a == &x && !b);
+    }
+    {
+        Derived d;
+        Optional<Derived&> od(d);
+        Optional<Base&> ob(od);
+        assert(&*ob == static_cast<Base*>(&d));
+        assert(ob->i == 1);
+    }
+    {
+        Optional<int&> empty;
+        try {
+            (void)empty.value();
+            assert(false);
+        } catch(const BadOptionalAccess&) {
+        }
+    }
+    {
+        int x = 4;
+        int y = 4;
+        int z = 5;
+        Optional<int&> a(x);
+        Optional<int&> b(y);
+        Optional<int&> c(z);
+        Optional<int&> e;
+        assert(a == b);
+        assert(a != c);
+        assert(a < c);
+        assert(e < a);
+        assert(a == Optional<int>(4));
+        assert(e == nullopt);
+        assert(a >= 4);
+        assert(std::hash<Optional<int&>>{}(a) == std::hash<int>{}(4));
+        assert(std::hash<Optional<int&>>{}(e) == 0);
+        Optional<int> copied(a);
+        assert(copied == 4);
+    }
+
+  return 0;
+}
@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <SharedOptional>
+
+// template <class T> class SharedOptional;
+
+#include "tim/optional/SharedOptional.hpp"
+#include <type_traits>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::SharedOptional;
+using tim::nullopt;
+
+// Every field derives from 'fields[0]', so a torn copy is detectable.
+template <std::size_t N>
+struct Block
+{
+    std::uint32_t fields[N];
+
+    static std::uint32_t field(std::uint32_t seed, std::size_t i)
+    {
+        return seed + static_cast<std::uint32_t>(i) * 2654435761u;
+    }
+
+    static Block make(std::uint32_t seed)
+    {
+        Block b;
+        for(std::size_t i = 0; i < N; ++i) {
+            b.fields[i] = field(seed, i);
+        }
+        return b;
+    }
+
+    bool consistent() const
+    {
+        for(std::size_t i = 0; i < N; ++i) {
+            if(fields[i] != field(fields[0], i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    friend bool operator==(const Block& l, const Block& r)
+    {
+        for(std::size_t i = 0; i < N; ++i) {
+            if(l.fields[i] != r.fields[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// An odd-sized payload, to cover the partial last word.
+struct Odd
+{
+    char c[37];
+};
+
+template <std::size_t N>
+void test_basic()
+{
+    using B = Block<N>;
+    SharedOptional<B> x;
+    assert(!x.load());
+    assert(!x.has_value());
+    x.store(B::make(1));
+    assert(x.has_value());
+    assert(x.load() == B::make(1));
+    x.emplace(B::make(2));
+    assert(x.load() == B::make(2));
+    x.reset();
+    assert(!x.load());
+    x = B::make(3);
+    assert(static_cast<Optional<B>>(x) == B::make(3));
+    x = nullopt;
+    assert(!x.has_value());
+    SharedOptional<B> y(B::make(4));
+    assert(y.load() == B::make(4));
+}
+
+template <std::size_t N>
+void test_stress()
+{
+    using B = Block<N>;
+    SharedOptional<B> x(B::make(0));
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> reads{0};
+    std::vector<std::thread> threads;
+    for(unsigned w = 0; w < 2; ++w) {
+        threads.emplace_back([&, w]() {
+            for(std::uint32_t i = 1; i < 20000; ++i) {
+                if(i % 16 == 0) {
+                    x.reset();
+                } else {
+                    x.store(B::make(i * 2u + w));
+                }
+                if(i % 1024 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for(unsigned r = 0; r < 3; ++r) {
+        threads.emplace_back([&]() {
+            std::uint64_t n = 0;
+            while(!done.load(std::memory_order_relaxed)) {
+                Optional<B> v = x.load();
+                assert(!v || v->consistent());
+                ++n;
+            }
+            reads.fetch_add(n);
+        });
+    }
+    threads[0].join();
+    threads[1].join();
+    done.store(true);
+    for(std::size_t t = 2; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    assert(reads.load() > 0);
+}
+
+int main(int, char**)
+{
+    test_basic<8>();
+    test_basic<64>();
+    {
+        SharedOptional<Odd> x;
+        Odd o;
+        for(int i = 0; i < 37; ++i) {
+            o.c[i] = static_cast<char>(i);
+        }
+        x.store(o);
+        Optional<Odd> got = x.load();
+        assert(got);
+        for(int i = 0; i < 37; ++i) {
+            assert(got->c[i] == static_cast<char>(i));
+        }
+    }
+    test_stress<8>();
+    test_stress<64>();
+
+  return 0;
+}
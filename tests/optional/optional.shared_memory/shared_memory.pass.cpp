@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <SharedMemoryOptional>
+
+// template <class T> class SharedMemoryOptional;
+
+#include "tim/optional/SharedMemoryOptional.hpp"
+#include <type_traits>
+#include <new>
+#include <thread>
+#include <cassert>
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::SharedMemoryOptional;
+
+// Every field is derived from 'seq', so a torn snapshot is detectable.
+struct Record
+{
+    std::uint64_t seq;
+    std::uint32_t fields[9];
+};
+
+Record make_record(std::uint64_t seq)
+{
+    Record r{};
+    r.seq = seq;
+    for(std::uint32_t i = 0; i < 9; ++i)
+        r.fields[i] = static_cast<std::uint32_t>(seq * (i + 1) + i);
+    return r;
+}
+
+bool consistent(const Record& r)
+{
+    for(std::uint32_t i = 0; i < 9; ++i) {
+        if(r.fields[i] != static_cast<std::uint32_t>(r.seq * (i + 1) + i))
+            return false;
+    }
+    return true;
+}
+
+static_assert(std::is_standard_layout_v<SharedMemoryOptional<Record>>, "");
+static_assert(alignof(SharedMemoryOptional<Record>) == 64, "");
+
+void test_single_process()
+{
+    SharedMemoryOptional<Record> s;
+    assert(s.generation() == 0);
+    assert(!s.try_read());
+    s.publish(make_record(1));
+    std::uint64_t gen = 0;
+    Optional<Record> r = s.try_read(gen);
+    assert(r && r->seq == 1 && consistent(*r) && gen == 1);
+    // Republishing an equal value still advances the generation.
+    s.publish(make_record(1));
+    assert(s.try_read(gen)->seq == 1 && gen == 2);
+    s.retract();
+    assert(!s.try_read(gen) && gen == 3);
+    s.publish(Optional<Record>(make_record(5)));
+    assert(s.try_read()->seq == 5);
+    s.publish(Optional<Record>());
+    assert(!s.try_read() && s.generation() == 5);
+}
+
+void test_two_processes()
+{
+    constexpr std::uint64_t count = 20000;
+    void* region = ::mmap(nullptr, sizeof(SharedMemoryOptional<Record>),
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    assert(region != MAP_FAILED);
+    auto* shared = ::new (region) SharedMemoryOptional<Record>();
+
+    pid_t child = ::fork();
+    assert(child >= 0);
+    if(child == 0) {
+        // The writer.
+        for(std::uint64_t i = 1; i <= count; ++i) {
+            shared->publish(make_record(i));
+            if(i % 256 == 0)
+                std::this_thread::yield();
+        }
+        ::_exit(0);
+    }
+
+    // The reader: snapshots are whole, and both the records and their
+    // generations only move forward.
+    std::uint64_t last_seq = 0;
+    std::uint64_t last_gen = 0;
+    while(last_seq < count) {
+        std::uint64_t gen;
+        Optional<Record> r = shared->try_read(gen);
+        if(!r) {
+            assert(gen == 0);
+            std::this_thread::yield();
+            continue;
+        }
+        assert(consistent(*r));
+        assert(gen == r->seq);
+        assert(gen >= last_gen && r->seq >= last_seq);
+        last_gen = gen;
+        last_seq = r->seq;
+    }
+    int status = 0;
+    assert(::waitpid(child, &status, 0) == child);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    ::munmap(region, sizeof(SharedMemoryOptional<Record>));
+}
+
+int main(int, char**)
+{
+    test_single_process();
+    test_two_processes();
+
+  return 0;
+}
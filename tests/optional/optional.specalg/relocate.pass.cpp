@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <Optional>
+
+// template <class T> struct is_trivially_relocatable;
+// template <class T> T* relocate_at(T* src, T* dest);
+// template <class T> T* uninitialized_relocate(T* first, T* last, T* d_first);
+
+#include "tim/optional/Optional.hpp"
+#include <type_traits>
+#include <memory>
+#include <new>
+#include <cassert>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::is_trivially_relocatable_v;
+
+struct Counted
+{
+    static int moved;
+    static int destroyed;
+    int i_;
+    Counted(int i) : i_(i) {}
+    Counted(Counted&& other) : i_(other.i_) { ++moved; }
+    ~Counted() { ++destroyed; }
+};
+
+int Counted::moved = 0;
+int Counted::destroyed = 0;
+
+struct Relocatable
+{
+    static int moved;
+    static int destroyed;
+    std::unique_ptr<int> p_;
+    Relocatable(int i) : p_(new int(i)) {}
+    Relocatable(Relocatable&& other) : p_(std::move(other.p_)) { ++moved; }
+    Relocatable& operator=(Relocatable&& other) { p_ = std::move(other.p_); ++moved; return *this; }
+    ~Relocatable() { ++destroyed; }
+};
+
+int Relocatable::moved = 0;
+int Relocatable::destroyed = 0;
+
+template <>
+struct tim::is_trivially_relocatable<Relocatable>: std::true_type {};
+
+static_assert(is_trivially_relocatable_v<int>, "");
+static_assert(is_trivially_relocatable_v<std::unique_ptr<int>>, "");
+static_assert(is_trivially_relocatable_v<std::shared_ptr<int>>, "");
+static_assert(is_trivially_relocatable_v<Optional<int>>, "");
+static_assert(is_trivially_relocatable_v<Optional<int&>>, "");
+static_assert(is_trivially_relocatable_v<Optional<void>>, "");
+static_assert(is_trivially_relocatable_v<Optional<std::unique_ptr<int>>>, "");
+static_assert(is_trivially_relocatable_v<Optional<Relocatable>>, "");
+static_assert(!is_trivially_relocatable_v<Counted>, "");
+static_assert(!is_trivially_relocatable_v<Optional<Counted>>, "");
+
+template <class T>
+struct Buffer
+{
+    explicit Buffer(std::size_t n) : data(static_cast<T*>(::operator new(n * sizeof(T)))) {}
+    ~Buffer() { ::operator delete(data); }
+    T* data;
+};
+
+int main(int, char**)
+{
+    {
+        Buffer<Optional<std::unique_ptr<int>>> src(3);
+        Buffer<Optional<std::unique_ptr<int>>> dst(3);
+        ::new (src.data + 0) Optional<std::unique_ptr<int>>(new int(0));
+        ::new (src.data + 1) Optional<std::unique_ptr<int>>();
+        ::new (src.data + 2) Optional<std::unique_ptr<int>>(new int(2));
+        auto end = tim::uninitialized_relocate(src.data, src.data + 3, dst.data);
+        assert(end == dst.data + 3);
+        assert(**dst.data[0] == 0);
+        assert(!dst.data[1]);
+        assert(**dst.data[2] == 2);
+        std::destroy(dst.data, end);
+    }
+    {
+        Buffer<Counted> src(2);
+        Buffer<Counted> dst(2);
+        ::new (src.data + 0) Counted(0);
+        ::new (src.data + 1) Counted(1);
+        auto end = tim::uninitialized_relocate(src.data, src.data + 2, dst.data);
+        assert(end == dst.data + 2);
+        assert(Counted::moved == 2 && Counted::destroyed == 2);
+        assert(dst.data[0].i_ == 0 && dst.data[1].i_ == 1);
+        Counted* moved = tim::relocate_at(dst.data + 1, src.data);
+        assert(moved->i_ == 1);
+        assert(Counted::moved == 3 && Counted::destroyed == 3);
+        std::destroy_at(moved);
+        std::destroy_at(dst.data);
+    }
+    {
+        // Relocatable payloads are swapped and transferred without moves.
+        Optional<Relocatable> a(1);
+        Optional<Relocatable> b(2);
+        Optional<Relocatable> e;
+        Relocatable::moved = 0;
+        Relocatable::destroyed = 0;
+        a.swap(b);
+        assert(*a->p_ == 2 && *b->p_ == 1);
+        swap(a, e);
+        assert(!a && *e->p_ == 2);
+        e.swap(a);
+        assert(*a->p_ == 2 && !e);
+        assert(Relocatable::moved == 0 && Relocatable::destroyed == 0);
+    }
+    assert(Relocatable::destroyed == 2);
+    {
+        Optional<std::unique_ptr<int>> a(new int(1));
+        Optional<std::unique_ptr<int>> b;
+        a.swap(b);
+        assert(!a && **b == 1);
+        a.swap(b);
+        assert(**a == 1 && !b);
+    }
+
+  return 0;
+}
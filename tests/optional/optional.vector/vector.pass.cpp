@@ -0,0 +1,188 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <OptionalVector>
+
+// template <class T> struct OptionalVector;
+
+#include "tim/optional/OptionalVector.hpp"
+#include <type_traits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+
+using tim::Optional;
+using tim::OptionalVector;
+using tim::nullopt;
+using tim::BadOptionalAccess;
+
+struct Counted
+{
+    static int alive;
+    int i_;
+    Counted(int i) : i_(i) { ++alive; }
+    Counted(const Counted& other) : i_(other.i_) { ++alive; }
+    Counted(Counted&& other) noexcept : i_(other.i_) { ++alive; }
+    Counted& operator=(const Counted&) = default;
+    ~Counted() { --alive; }
+};
+
+int Counted::alive = 0;
+
+static_assert(std::is_same<OptionalVector<int>::const_reference, Optional<const int&>>::value, "");
+static_assert(std::is_same<decltype(*OptionalVector<int>().present().begin()), int&>::value, "");
+static_assert(std::is_nothrow_move_constructible<OptionalVector<std::string>>::value, "");
+
+template <class V>
+std::vector<std::size_t> present_indices(V& v)
+{
+    std::vector<std::size_t> result;
+    for (auto pos = v.present().begin(); pos != v.present().end(); ++pos)
+        result.push_back(pos.index());
+    return result;
+}
+
+void test_basic()
+{
+    OptionalVector<int> v;
+    assert(v.empty() && v.size() == 0 && v.count() == 0);
+    assert(v.present().begin() == v.present().end());
+    v.push_back(1);
+    v.push_back(nullopt);
+    v.push_back(Optional<int>(3));
+    v.push_back(Optional<int>());
+    v.emplace_back(5);
+    assert(v.size() == 5);
+    assert(v.count() == 3);
+    assert(v.has_value(0) && !v.has_value(1) && v.has_value(2) && !v.has_value(3));
+    assert(*v[0] == 1 && v.value(2) == 3 && v[4].value() == 5);
+    assert(!v[1] && v[1].value_or(7) == 7);
+    {
+        const OptionalVector<int>& cv = v;
+        Optional<const int&> r = cv[2];
+        assert(r && &*r == &v.value(2));
+        assert(!cv[3]);
+    }
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    try {
+        (void)v.value(1);
+        assert(false);
+    } catch (const BadOptionalAccess&) {
+    }
+#endif
+    v[1] = 2;
+    v[0] = nullopt;
+    v[3].emplace(4);
+    v[4] = Optional<int>();
+    assert(present_indices(v) == (std::vector<std::size_t>{1, 2, 3}));
+    int sum = 0;
+    for (int& i : v.present())
+        sum += i;
+    assert(sum == 9);
+    v[0] = v[1];
+    v[4] = v[4];
+    assert(*v[0] == 2 && !v[4]);
+    swap(v[0], v[4]);
+    assert(!v[0] && *v[4] == 2);
+    Optional<int> copy = v[4];
+    Optional<int&> ref = v[4];
+    assert(*copy == 2 && &*ref == &v.value(4));
+    v.pop_back();
+    assert(v.size() == 4 && v.count() == 3);
+}
+
+void test_sparse_scan()
+{
+    OptionalVector<std::size_t> v(1000);
+    assert(v.size() == 1000 && v.count() == 0);
+    std::vector<std::size_t> expected;
+    for (std::size_t i = 0; i < 1000; i += 41)
+    {
+        v.emplace(i, i * 2);
+        expected.push_back(i);
+    }
+    v.emplace(63, 126);
+    v.emplace(64, 128);
+    v.emplace(999, 1998);
+    expected.insert(expected.begin() + 2, {63, 64});
+    expected.push_back(999);
+    assert(present_indices(v) == expected);
+    for (std::size_t& i : v.present())
+        assert(i % 2 == 0);
+    const OptionalVector<std::size_t>& cv = v;
+    OptionalVector<std::size_t>::const_iterator first = v.present().begin();
+    assert(first == cv.present().begin());
+    assert(present_indices(cv) == expected);
+    v.resize(64);
+    assert(v.count() == 3);
+    v.resize(200);
+    assert(v.count() == 3 && !v.has_value(82) && !v.has_value(123));
+}
+
+void test_lifetimes()
+{
+    {
+        OptionalVector<Counted> v;
+        for (int i = 0; i < 100; ++i)
+        {
+            if (i % 3)
+                v.emplace_back(i);
+            else
+                v.push_back(nullopt);
+        }
+        assert(Counted::alive == 66);
+        v.reset(1);
+        v.reset(0);
+        assert(Counted::alive == 65);
+        OptionalVector<Counted> w(v);
+        assert(Counted::alive == 130);
+        assert(w.count() == 65 && w[2]->i_ == 2 && !w[1]);
+        v.resize(50);
+        assert(Counted::alive == 65 + 32);
+        w = std::move(v);
+        assert(Counted::alive == 32);
+        assert(v.empty());
+        w.emplace(2, 20);
+        assert(Counted::alive == 32 && w[2]->i_ == 20);
+        w.clear();
+        assert(Counted::alive == 0 && w.count() == 0);
+    }
+    assert(Counted::alive == 0);
+    {
+        OptionalVector<std::unique_ptr<int>> v;
+        for (int i = 0; i < 70; ++i)
+            v.emplace_back(new int(i));
+        v.reset(69);
+        int n = 0;
+        for (auto& p : v.present())
+            assert(*p == n++);
+        assert(n == 69);
+    }
+    {
+        OptionalVector<std::string> v{std::string("a"), nullopt, std::string("c")};
+        OptionalVector<std::string> w;
+        w = v;
+        v[0]->append("b");
+        assert(*v[0] == "ab" && *w[0] == "a" && !w[1] && *w[2] == "c");
+        v.swap(w);
+        assert(*v[0] == "a" && *w[0] == "ab");
+    }
+}
+
+int main(int, char**)
+{
+    test_basic();
+    test_sparse_scan();
+    test_lifetimes();
+
+  return 0;
+}
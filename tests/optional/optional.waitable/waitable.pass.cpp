@@ -0,0 +1,157 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// <WaitableOptional>
+
+// template <class T> class WaitableOptional;
+
+#include "tim/optional/WaitableOptional.hpp"
+#include <type_traits>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+#include "count_new.h"
+
+using tim::Optional;
+using tim::WaitableOptional;
+
+struct Counted
+{
+    static int alive;
+    int i_;
+    explicit Counted(int i) : i_(i) { ++alive; }
+    Counted(const Counted&) = delete;
+    ~Counted() { --alive; }
+};
+
+int Counted::alive = 0;
+
+void test_single_thread()
+{
+    {
+        WaitableOptional<Counted> w;
+        assert(!w.has_value());
+        assert(!w.try_get());
+        assert(!w.wait_for(std::chrono::milliseconds(1)));
+        assert(!w.wait_for(std::chrono::milliseconds(0)));
+        Counted& c = w.set(3);
+        assert(c.i_ == 3 && Counted::alive == 1);
+        assert(w.has_value());
+        assert(&*w.try_get() == &c);
+        assert(&w.wait() == &c);
+        assert(&*w.wait_for(std::chrono::seconds(1)) == &c);
+
+        const WaitableOptional<Counted>& cw = w;
+        static_assert(std::is_same_v<decltype(cw.wait()), const Counted&>, "");
+        static_assert(std::is_same_v<decltype(cw.try_get()), Optional<const Counted&>>, "");
+        assert(cw.wait().i_ == 3);
+
+        w.reset();
+        assert(!w.has_value() && Counted::alive == 0);
+        w.reset();
+        w.set(4);
+        assert(w.wait().i_ == 4);
+    }
+    assert(Counted::alive == 0);
+}
+
+void test_no_allocation()
+{
+    WaitableOptional<std::string> w;
+    globalMemCounter.reset();
+    for(int i = 0; i < 100; ++i) {
+        w.set(3u, 'x');
+        assert(w.wait() == "xxx");
+        assert(*w.try_get() == "xxx");
+        assert(*w.wait_for(std::chrono::seconds(1)) == "xxx");
+        w.reset();
+    }
+    assert(globalMemCounter.checkNewCalledEq(0));
+}
+
+void test_throwing_set()
+{
+#ifndef TEST_HAS_NO_EXCEPTIONS
+    struct MayThrow
+    {
+        int i_;
+        explicit MayThrow(int i) : i_(i) { if(i < 0) throw i; }
+    };
+    WaitableOptional<MayThrow> w;
+    try {
+        w.set(-1);
+        assert(false);
+    } catch(int) {
+    }
+    assert(!w.has_value());
+    w.set(1);
+    assert(w.wait().i_ == 1);
+#endif
+}
+
+void test_many_waiters()
+{
+    WaitableOptional<std::string> w;
+    std::atomic<int> done{0};
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            assert(w.wait() == "ready");
+            done.fetch_add(1);
+        });
+    }
+    threads.emplace_back([&] {
+        Optional<std::string&> v = w.wait_for(std::chrono::seconds(30));
+        assert(v && *v == "ready");
+        done.fetch_add(1);
+    });
+    // Let the waiters fall asleep.
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    assert(done.load() == 0);
+    w.set("ready");
+    for(auto& t : threads)
+        t.join();
+    assert(done.load() == 5);
+}
+
+void test_ping_pong()
+{
+    // Reused request/response slots, reset by whoever consumed them.
+    WaitableOptional<int> request;
+    WaitableOptional<int> response;
+    std::thread server([&] {
+        for(int i = 0; i < 1000; ++i) {
+            int v = request.wait();
+            request.reset();
+            response.set(v * 2);
+        }
+    });
+    for(int i = 0; i < 1000; ++i) {
+        request.set(i);
+        assert(response.wait() == i * 2);
+        response.reset();
+    }
+    server.join();
+}
+
+int main(int, char**)
+{
+    test_single_thread();
+    test_no_allocation();
+    test_throwing_set();
+    test_many_waiters();
+    test_ping_pong();
+
+  return 0;
+}